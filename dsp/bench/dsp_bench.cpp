@@ -0,0 +1,279 @@
+// End-to-end benchmark sweep of pt_dsp_process.
+//
+//   pt_dsp_bench [--seconds S] [--frame N] [--hop N] [--engine direct|fft]
+//                [--precision double|float] [--lag-search full|coarse|tracked]
+//                [--decimation off|auto] [--json PATH|-]
+//
+// Sweeps sample rate x block size x signal. Every case feeds S seconds of
+// audio (default 2) to a fresh instance in blocks of the given size, after an
+// untimed quarter second that fills the window. Each pt_dsp_process call is
+// timed on its own, so the latency percentiles show what a realtime callback
+// of that block size sees, including the calls that run no analysis.
+//
+// Prints one key=value line per case. --json also writes the results as a
+// single JSON document (schema "pt_dsp_bench/1") to PATH, or to stdout for
+// "-". Build with CMAKE_BUILD_TYPE=Release for meaningful numbers; per-kernel
+// timings are in pt_dsp_kernel_bench.
+
+#include "kernels.h"
+#include "pt_dsp/dsp_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int kSampleRates[] = {16000, 44100, 48000, 96000};
+constexpr int kBlockSizes[] = {64, 128, 256, 512, 1024, 2048, 4096};
+constexpr double kWarmupSeconds = 0.25;
+
+enum class Signal {
+    kSilence,
+    kSine,
+    kVibrato,
+    kNoise,
+};
+constexpr Signal kSignals[] = {Signal::kSilence, Signal::kSine, Signal::kVibrato, Signal::kNoise};
+
+const char* signal_name(Signal signal) {
+    switch (signal) {
+        case Signal::kSilence:
+            return "silence";
+        case Signal::kSine:
+            return "sine";
+        case Signal::kVibrato:
+            return "voiced_vibrato";
+        case Signal::kNoise:
+            return "noise";
+    }
+    return "unknown";
+}
+
+struct Options {
+    double seconds = 2.0;
+    DSPConfig cfg{};
+    std::string json_path;
+};
+
+struct CaseResult {
+    int sample_rate = 0;
+    int block = 0;
+    Signal signal = Signal::kSilence;
+    int64_t calls = 0;
+    int64_t frames = 0;
+    double ns_per_sample = 0.0;
+    double frames_per_sec = 0.0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+volatile double g_sink = 0.0;
+
+std::vector<float> make_signal(Signal signal, int sample_rate, size_t size) {
+    std::vector<float> out(size, 0.0f);
+    std::mt19937 rng(1234);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    double phase = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+        const double t = static_cast<double>(i) / sample_rate;
+        switch (signal) {
+            case Signal::kSilence:
+                break;
+            case Signal::kSine:
+                out[i] = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 220.0 * t));
+                break;
+            case Signal::kVibrato: {
+                // Sung G3 with a 5.5 Hz, +-30 cent vibrato, three harmonics
+                // and a light noise floor.
+                const double hz = 196.0 * std::pow(2.0, 30.0 * std::sin(2.0 * M_PI * 5.5 * t) / 1200.0);
+                phase += 2.0 * M_PI * hz / sample_rate;
+                out[i] = static_cast<float>(0.45 * std::sin(phase) + 0.2 * std::sin(2.0 * phase) +
+                                            0.08 * std::sin(3.0 * phase) + 0.003 * noise(rng));
+                break;
+            }
+            case Signal::kNoise:
+                out[i] = static_cast<float>(0.25 * noise(rng));
+                break;
+        }
+    }
+    return out;
+}
+
+const char* lag_search_name(const DSPConfig& cfg) {
+    switch (cfg.lag_search) {
+    case PT_DSP_LAG_SEARCH_COARSE_TO_FINE:
+        return "coarse";
+    case PT_DSP_LAG_SEARCH_TRACKED:
+        return "tracked";
+    default:
+        return "full";
+    }
+}
+
+const char* decimation_name(const DSPConfig& cfg) {
+    return cfg.decimation == PT_DSP_DECIMATION_AUTO ? "auto" : "off";
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    const size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+bool run_case(const Options& opts, int sample_rate, int block, Signal signal, CaseResult* result) {
+    using clock = std::chrono::steady_clock;
+    DSPConfig cfg = opts.cfg;
+    cfg.sample_rate_hz = sample_rate;
+    PT_DSP* dsp = pt_dsp_create(cfg);
+    if (!dsp) {
+        return false;
+    }
+    const int hop = std::min(cfg.hop_size, cfg.frame_size);
+    const size_t warmup = static_cast<size_t>(kWarmupSeconds * sample_rate);
+    const size_t timed = static_cast<size_t>(opts.seconds * sample_rate) / block * block;
+    const std::vector<float> input = make_signal(signal, sample_rate, warmup + timed);
+    pt_dsp_push(dsp, input.data(), static_cast<int>(warmup), nullptr, 0);
+
+    std::vector<double> latencies;
+    latencies.reserve(timed / block);
+    double total_ns = 0.0;
+    for (size_t pos = warmup; pos < input.size(); pos += block) {
+        const auto start = clock::now();
+        const DSPFrameOutput out = pt_dsp_process(dsp, input.data() + pos, block);
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        g_sink = g_sink + out.confidence;
+        latencies.push_back(ns);
+        total_ns += ns;
+    }
+    pt_dsp_destroy(dsp);
+
+    // Analyses run once per completed hop since the start of the stream, so a
+    // warm-up that ends mid-hop is accounted for.
+    const int64_t frames = static_cast<int64_t>((warmup + timed) / hop - warmup / hop);
+    std::sort(latencies.begin(), latencies.end());
+    result->sample_rate = sample_rate;
+    result->block = block;
+    result->signal = signal;
+    result->calls = static_cast<int64_t>(latencies.size());
+    result->frames = frames;
+    result->ns_per_sample = total_ns / static_cast<double>(timed);
+    result->frames_per_sec = total_ns > 0.0 ? static_cast<double>(frames) * 1e9 / total_ns : 0.0;
+    result->p50_ns = percentile(latencies, 0.50);
+    result->p99_ns = percentile(latencies, 0.99);
+    result->max_ns = latencies.back();
+    return true;
+}
+
+void write_json(std::FILE* f, const Options& opts, const std::vector<CaseResult>& results) {
+    std::fprintf(f, "{\n  \"schema\": \"pt_dsp_bench/1\",\n");
+    std::fprintf(f,
+                 "  \"config\": {\"frame_size\": %d, \"hop_size\": %d, \"engine\": \"%s\", \"precision\": \"%s\", "
+                 "\"lag_search\": \"%s\", \"decimation\": \"%s\", \"seconds\": %.3f, \"kernels\": \"%s\"},\n",
+                 opts.cfg.frame_size, opts.cfg.hop_size, opts.cfg.diff_engine == PT_DSP_DIFF_FFT ? "fft" : "direct",
+                 opts.cfg.precision == PT_DSP_PRECISION_FLOAT ? "float" : "double", lag_search_name(opts.cfg),
+                 decimation_name(opts.cfg), opts.seconds, pt_dsp::best_kernels().name);
+    std::fprintf(f, "  \"cases\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CaseResult& r = results[i];
+        std::fprintf(f,
+                     "    {\"sample_rate_hz\": %d, \"block_size\": %d, \"signal\": \"%s\", \"calls\": %lld, "
+                     "\"frames\": %lld, \"ns_per_sample\": %.3f, \"frames_per_sec\": %.1f, "
+                     "\"latency_ns\": {\"p50\": %.0f, \"p99\": %.0f, \"max\": %.0f}}%s\n",
+                     r.sample_rate, r.block, signal_name(r.signal), static_cast<long long>(r.calls),
+                     static_cast<long long>(r.frames), r.ns_per_sample, r.frames_per_sec, r.p50_ns, r.p99_ns, r.max_ns,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+bool parse_args(int argc, char* argv[], Options* opts) {
+    opts->cfg.a4_hz = 440.0;
+    opts->cfg.frame_size = 1024;
+    opts->cfg.hop_size = 256;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (arg == "--seconds") {
+            opts->seconds = std::max(0.1, std::atof(value.c_str()));
+        } else if (arg == "--frame") {
+            opts->cfg.frame_size = std::clamp(std::atoi(value.c_str()), 64, 4096);
+        } else if (arg == "--hop") {
+            opts->cfg.hop_size = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--engine" && (value == "direct" || value == "fft")) {
+            opts->cfg.diff_engine = value == "direct" ? PT_DSP_DIFF_DIRECT : PT_DSP_DIFF_FFT;
+        } else if (arg == "--precision" && (value == "double" || value == "float")) {
+            opts->cfg.precision = value == "double" ? PT_DSP_PRECISION_DOUBLE : PT_DSP_PRECISION_FLOAT;
+        } else if (arg == "--lag-search" && (value == "full" || value == "coarse" || value == "tracked")) {
+            opts->cfg.lag_search = value == "full"     ? PT_DSP_LAG_SEARCH_FULL
+                                   : value == "coarse" ? PT_DSP_LAG_SEARCH_COARSE_TO_FINE
+                                                       : PT_DSP_LAG_SEARCH_TRACKED;
+        } else if (arg == "--decimation" && (value == "off" || value == "auto")) {
+            opts->cfg.decimation = value == "off" ? PT_DSP_DECIMATION_OFF : PT_DSP_DECIMATION_AUTO;
+        } else if (arg == "--json") {
+            opts->json_path = value;
+        } else {
+            return false;
+        }
+    }
+    opts->cfg.hop_size = std::min(opts->cfg.hop_size, opts->cfg.frame_size);
+    return argc % 2 == 1;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parse_args(argc, argv, &opts)) {
+        std::fprintf(stderr,
+                     "usage: pt_dsp_bench [--seconds S] [--frame N] [--hop N] [--engine direct|fft]\n"
+                     "                    [--precision double|float] [--lag-search full|coarse|tracked]\n"
+                     "                    [--decimation off|auto] [--json PATH|-]\n");
+        return 2;
+    }
+    // With JSON on stdout the per-case lines go to stderr.
+    std::FILE* log = opts.json_path == "-" ? stderr : stdout;
+    std::fprintf(log,
+                 "frame_size=%d hop_size=%d engine=%s precision=%s lag_search=%s decimation=%s kernels=%s "
+                 "seconds=%.2f\n",
+                 opts.cfg.frame_size, opts.cfg.hop_size, opts.cfg.diff_engine == PT_DSP_DIFF_FFT ? "fft" : "direct",
+                 opts.cfg.precision == PT_DSP_PRECISION_FLOAT ? "float" : "double", lag_search_name(opts.cfg),
+                 decimation_name(opts.cfg), pt_dsp::best_kernels().name, opts.seconds);
+
+    std::vector<CaseResult> results;
+    for (int sample_rate : kSampleRates) {
+        for (Signal signal : kSignals) {
+            for (int block : kBlockSizes) {
+                CaseResult r;
+                if (!run_case(opts, sample_rate, block, signal, &r)) {
+                    std::fprintf(stderr, "pt_dsp_create failed\n");
+                    return 1;
+                }
+                std::fprintf(log,
+                             "sample_rate_hz=%d signal=%s block_size=%d ns_per_sample=%.2f frames_per_sec=%.0f "
+                             "p50_ns=%.0f p99_ns=%.0f max_ns=%.0f\n",
+                             r.sample_rate, signal_name(r.signal), r.block, r.ns_per_sample, r.frames_per_sec,
+                             r.p50_ns, r.p99_ns, r.max_ns);
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (opts.json_path.empty()) {
+        return 0;
+    }
+    std::FILE* json = opts.json_path == "-" ? stdout : std::fopen(opts.json_path.c_str(), "w");
+    if (!json) {
+        std::fprintf(stderr, "cannot write %s\n", opts.json_path.c_str());
+        return 1;
+    }
+    write_json(json, opts, results);
+    if (json != stdout) {
+        std::fclose(json);
+    }
+    return 0;
+}
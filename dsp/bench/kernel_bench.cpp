@@ -0,0 +1,154 @@
+// Per-ISA timing of the YIN inner-loop kernels against the scalar reference.
+//
+//   pt_dsp_kernel_bench [frame_size] [sample_rate_hz]
+//
+// Prints one line per kernel, precision and variant with ns per call and
+// speedup over the scalar kernel of the same precision, then one line per
+// shape-specialised difference (ShapeKernels) with its speedup over the same
+// variant's generic difference. Variants without shapes (AVX2, AVX-512) say
+// so, and shapes only replace full recomputes, never the sliding update.
+
+#include "kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+using pt_dsp::KernelIsa;
+using pt_dsp::KernelOps;
+using pt_dsp::Kernels;
+
+volatile double g_sink = 0.0;
+
+double time_ns_per_call(const std::function<double()>& fn) {
+    using clock = std::chrono::steady_clock;
+    int iterations = 1;
+    for (;;) {
+        const auto start = clock::now();
+        double acc = 0.0;
+        for (int i = 0; i < iterations; ++i) {
+            acc += fn();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        g_sink = g_sink + acc;
+        if (elapsed > 2e8 || iterations >= (1 << 24)) {
+            return elapsed / iterations;
+        }
+        iterations *= 2;
+    }
+}
+
+template <typename T>
+void run_cases(const char* precision, const std::vector<float>& input, int min_lag, int max_lag) {
+    const int n = static_cast<int>(input.size());
+    std::vector<T> centered(n);
+    std::vector<T> diff(n);
+    std::vector<T> cmndf(n);
+    const KernelOps<T>& ref = pt_dsp::scalar_kernels().ops<T>();
+    ref.center(input.data(), n, T(0), centered.data());
+    ref.difference(centered.data(), n, min_lag, max_lag, diff.data());
+
+    struct Case {
+        const char* name;
+        std::function<double(const KernelOps<T>&)> run;
+    };
+    const std::vector<Case> cases = {
+        {"sum", [&](const KernelOps<T>& k) { return k.sum(input.data(), n); }},
+        {"center", [&](const KernelOps<T>& k) { return k.center(input.data(), n, T(0.01), centered.data()); }},
+        {"sum_sq_diff_f32",
+         [&](const KernelOps<T>& k) { return k.sum_sq_diff_f32(input.data(), input.data() + 1, n / 4); }},
+        {"difference",
+         [&](const KernelOps<T>& k) {
+             k.difference(centered.data(), n, min_lag, max_lag, diff.data());
+             return static_cast<double>(diff[max_lag]);
+         }},
+        {"cmndf",
+         [&](const KernelOps<T>& k) {
+             k.cmndf(diff.data(), min_lag, max_lag, cmndf.data());
+             return static_cast<double>(cmndf[max_lag]);
+         }},
+    };
+
+    for (const Case& c : cases) {
+        const double scalar_ns = time_ns_per_call([&] { return c.run(ref); });
+        std::printf("kernel=%s precision=%s isa=scalar ns_per_call=%.1f speedup=1.00\n", c.name, precision,
+                    scalar_ns);
+        for (KernelIsa isa : {KernelIsa::kSse2, KernelIsa::kAvx2, KernelIsa::kAvx512, KernelIsa::kNeon}) {
+            const Kernels* k = pt_dsp::kernels_for(isa);
+            if (k == nullptr) {
+                continue;
+            }
+            const double ns = time_ns_per_call([&] { return c.run(k->ops<T>()); });
+            std::printf("kernel=%s precision=%s isa=%s ns_per_call=%.1f speedup=%.2f\n", c.name, precision,
+                        k->name, ns, scalar_ns / ns);
+        }
+    }
+}
+
+template <typename T>
+void run_shapes(const char* precision) {
+    for (KernelIsa isa :
+         {KernelIsa::kScalar, KernelIsa::kSse2, KernelIsa::kAvx2, KernelIsa::kAvx512, KernelIsa::kNeon}) {
+        const Kernels* k = pt_dsp::kernels_for(isa);
+        if (k == nullptr) {
+            continue;
+        }
+        if (k->shape_count == 0) {
+            std::printf("kernel=difference_shape precision=%s isa=%s shapes=none\n", precision, k->name);
+            continue;
+        }
+        for (int i = 0; i < k->shape_count; ++i) {
+            const pt_dsp::ShapeKernels& shape = k->shapes[i];
+            const int n = shape.frame_size;
+            std::mt19937 rng(11);
+            std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+            std::vector<T> centered(n);
+            for (T& v : centered) {
+                v = dist(rng);
+            }
+            std::vector<T> diff(n);
+            const double generic_ns = time_ns_per_call([&] {
+                k->ops<T>().difference(centered.data(), n, shape.min_lag, shape.max_lag, diff.data());
+                return static_cast<double>(diff[shape.max_lag]);
+            });
+            const double ns = time_ns_per_call([&] {
+                shape.difference(centered.data(), diff.data());
+                return static_cast<double>(diff[shape.max_lag]);
+            });
+            std::printf(
+                "kernel=difference_shape precision=%s isa=%s sample_rate_hz=%d frame_size=%d lags=%d..%d "
+                "generic_ns=%.1f ns_per_call=%.1f speedup=%.2f\n",
+                precision, k->name, shape.sample_rate_hz, n, shape.min_lag, shape.max_lag, generic_ns, ns,
+                generic_ns / ns);
+        }
+    }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int n = argc > 1 ? std::max(64, std::atoi(argv[1])) : 1024;
+    const int sample_rate = argc > 2 ? std::max(8000, std::atoi(argv[2])) : 48000;
+    const int min_lag = sample_rate / 1100;
+    const int max_lag = std::min(n - 1, sample_rate / 80);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> input(n);
+    for (float& v : input) {
+        v = dist(rng);
+    }
+    std::printf("frame_size=%d sample_rate_hz=%d lags=%d..%d best=%s\n", n, sample_rate, min_lag, max_lag,
+                pt_dsp::best_kernels().name);
+    run_cases<double>("f64", input, min_lag, max_lag);
+    run_cases<float>("f32", input, min_lag, max_lag);
+    std::printf("difference_shape kernels replace full recomputes only; hops that slide the difference "
+                "(hop_size < frame_size) keep the generic update\n");
+    run_shapes<double>("f64");
+    run_shapes<float>("f32");
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// Runs a DSP instance on its own thread, fed from a realtime audio callback.
+// The callback only copies PCM into a lock-free ring; the worker drains the
+// ring at its own pace, so an expensive frame delays results instead of
+// overrunning the audio deadline.
+
+#include "pt_dsp/dsp_api.h"
+#include "pt_dsp/spsc_ring.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace pt_dsp {
+
+struct AnalysisWorkerStats {
+    uint64_t samples_pushed;       // accepted by push()
+    uint64_t samples_dropped;      // refused by push() because the ring was full
+    uint64_t overruns;             // push() calls that dropped samples
+    uint64_t samples_analyzed;     // passed to pt_dsp_push by the worker
+    uint64_t frames;               // handed to the sink
+    size_t backlog_samples;        // queued and not yet analysed
+    size_t max_backlog_samples;    // largest backlog the worker has found
+};
+
+// One producer thread calls push(); frames reach the sink on the worker
+// thread, in stream order. The instance must not be used elsewhere while the
+// worker runs.
+class AnalysisWorker {
+public:
+    // About 340 ms at 48 kHz.
+    static constexpr size_t kSampleRingSize = 16384;
+    // Largest batch of frames passed to the sink. A worker that has fallen
+    // behind analyses this many hops per ring pop.
+    static constexpr int kMaxFramesPerChunk = 16;
+
+    using FrameSink = void (*)(void* user, const DSPFrameOutput* frames, size_t count);
+
+    // cfg is the configuration dsp was created with. thread_nice is applied
+    // to the worker on Linux and Android (-16 is Android's audio priority)
+    // and silently left alone when the process may not raise it.
+    AnalysisWorker(PT_DSP* dsp, DSPConfig cfg, FrameSink sink, void* user, int thread_nice = -16);
+    ~AnalysisWorker();
+    AnalysisWorker(const AnalysisWorker&) = delete;
+    AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+    // Starts the worker thread. Returns false if it is already running or the
+    // thread cannot be created.
+    bool start();
+
+    // Stops the worker after it has analysed everything already pushed.
+    // Safe to call when not running.
+    void stop();
+
+    // Producer, realtime-safe: queues as many samples as fit and returns how
+    // many; the rest are dropped and counted as an overrun.
+    size_t push(const float* samples, size_t count);
+
+    // Any thread.
+    AnalysisWorkerStats stats() const;
+
+private:
+    void run();
+    void drain();
+
+    PT_DSP* dsp_;
+    DSPConfig cfg_;
+    FrameSink sink_;
+    void* user_;
+    int thread_nice_;
+    std::vector<float> chunk_;  // kMaxFramesPerChunk hops, filled by the worker
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> samples_pushed_{0};
+    std::atomic<uint64_t> samples_dropped_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> samples_analyzed_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<size_t> max_backlog_{0};
+
+    SpscRing<float, kSampleRingSize> ring_;
+};
+
+}  // namespace pt_dsp
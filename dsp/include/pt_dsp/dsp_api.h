@@ -1,5 +1,7 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,23 +19,167 @@ typedef struct DSPFrameOutput {
     double vibrato_depth_cents;// NaN when unavailable
 } DSPFrameOutput;
 
+// Strategy used to compute the YIN difference function.
+typedef enum DSPDiffEngine {
+    PT_DSP_DIFF_DIRECT = 0,    // time-domain loop, O(n * lags)
+    PT_DSP_DIFF_FFT = 1,       // FFT autocorrelation + prefix-sum energies, O(n log n)
+} DSPDiffEngine;
+
+// Sample type used for the analysis buffers and inner loops. Single precision
+// halves scratch memory and doubles SIMD lane width at a small accuracy cost;
+// pitch, history and outputs stay in double either way.
+typedef enum DSPPrecision {
+    PT_DSP_PRECISION_DOUBLE = 0,
+    PT_DSP_PRECISION_FLOAT = 1,
+} DSPPrecision;
+
+// How the period search visits lags (default PT_DSP_LAG_SEARCH_FULL).
+// COARSE_TO_FINE scans a coarse lag grid and refines its minima at full
+// resolution; confidence can differ slightly. Ignored by PT_DSP_DIFF_FFT.
+// TRACKED searches only near the last locked period, falling back to a full
+// search when the pitch leaves that window, and always in offline analysis.
+typedef enum DSPLagSearch {
+    PT_DSP_LAG_SEARCH_FULL = 0,
+    PT_DSP_LAG_SEARCH_COARSE_TO_FINE = 1,
+    PT_DSP_LAG_SEARCH_TRACKED = 2,
+} DSPLagSearch;
+
+// Optional front-end (default off) that decimates to about 8 kHz for the period
+// search and refines the period at full rate. Overrides diff_engine and
+// lag_search; does nothing below 16 kHz.
+typedef enum DSPDecimation {
+    PT_DSP_DECIMATION_OFF = 0,
+    PT_DSP_DECIMATION_AUTO = 1,
+} DSPDecimation;
+
+// COMPACT shares analysis scratch per thread, so it recomputes the difference
+// function every hop instead of sliding it and PT_DSP_DIFF_FFT falls back to direct.
+typedef enum DSPFootprint {
+    PT_DSP_FOOTPRINT_STANDARD = 0,
+    PT_DSP_FOOTPRINT_COMPACT = 1,
+} DSPFootprint;
+
 typedef struct DSPConfig {
     double a4_hz;              // default 440
     int sample_rate_hz;        // preferred 48000
-    int frame_size;            // e.g., 1024
-    int hop_size;              // e.g., 256
+    int frame_size;            // analysis window, e.g. 1024 (<= 0: 1024, capped at 4096)
+    int hop_size;              // samples between analyses, e.g. 256 (<= 0 or > frame_size: frame_size)
+    DSPDiffEngine diff_engine; // zero-initialised configs use PT_DSP_DIFF_DIRECT
+    DSPPrecision precision;    // zero-initialised configs use PT_DSP_PRECISION_DOUBLE
+    DSPLagSearch lag_search;   // zero-initialised configs use PT_DSP_LAG_SEARCH_FULL
+    DSPDecimation decimation;  // zero-initialised configs use PT_DSP_DECIMATION_OFF
+    DSPFootprint footprint;    // zero-initialised configs use PT_DSP_FOOTPRINT_STANDARD
 } DSPConfig;
 
+// Log-spaced latency buckets: four per octave. Bucket 0 counts calls under
+// 160 ns and the last bucket everything from its lower bound up; see
+// pt_dsp_timing_bucket_lower_ns().
+#define PT_DSP_TIMING_BUCKETS 80
+
+// Wall-clock cost of pt_dsp_push / pt_dsp_process calls on one instance.
+typedef struct DSPTimingStats {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[PT_DSP_TIMING_BUCKETS];
+} DSPTimingStats;
+
 // Opaque handle
 typedef struct PT_DSP PT_DSP;
 
+// Alignment, in bytes, of the memory an instance is built in (one cache line).
+#define PT_DSP_INSTANCE_ALIGNMENT 64
+
+// Allocates all analysis scratch up front, in one block. For
+// PT_DSP_FOOTPRINT_COMPACT this includes the calling thread's shared scratch
+// (see pt_dsp_reserve_thread_scratch). Returns NULL on allocation failure.
 PT_DSP* pt_dsp_create(DSPConfig cfg);
+
+// Bytes an instance with this configuration occupies, scratch and optional
+// engines included (for PT_DSP_FOOTPRINT_COMPACT, all but the thread's shared
+// scratch). A multiple of PT_DSP_INSTANCE_ALIGNMENT, so instances
+// can be packed back to back in one arena.
+size_t pt_dsp_required_size(DSPConfig cfg);
+
+// Builds the instance pt_dsp_create(cfg) would return inside caller memory,
+// without allocating. memory must be aligned to PT_DSP_INSTANCE_ALIGNMENT,
+// hold at least pt_dsp_required_size(cfg) bytes and stay valid until
+// pt_dsp_destroy; it need not be zeroed. Returns NULL, without writing to
+// memory, when it is NULL, misaligned or too small.
+PT_DSP* pt_dsp_init_in_place(DSPConfig cfg, void* memory, size_t size);
+
+// Allocates the calling thread's shared analysis scratch for compact
+// instances of this configuration, if it is not there yet. The scratch lives
+// until the thread exits. pt_dsp_push is only allocation-free for a compact
+// instance on a thread where this has been done, whether by this call or by
+// pt_dsp_create; otherwise the first analysis on the thread allocates it, and
+// if that fails, it reports an unvoiced frame. Call this on the audio thread
+// when compact instances are created elsewhere or with pt_dsp_init_in_place.
+// Returns true at once for standard configs, and false on allocation failure.
+bool pt_dsp_reserve_thread_scratch(DSPConfig cfg);
+
+// Releases an instance. For one built by pt_dsp_init_in_place this only ends
+// its lifetime; the memory is the caller's to reuse or free. NULL is ignored.
 void    pt_dsp_destroy(PT_DSP* dsp);
 
-// Feed hop_size mono samples (float PCM, [-1,1]).
+// Feed any number of mono samples (float PCM, [-1,1]). The DSP keeps the last
+// frame_size samples and runs one analysis each time hop_size new samples have
+// arrived, independent of how the input is split into calls. Until frame_size
+// samples have been seen, the available samples are analysed.
+// Writes up to max_frames results (oldest first) to out_frames and returns the
+// number of analyses run; a value above max_frames means frames were dropped.
+// Frame timestamps mark the start of their hop.
 // Must be realtime-safe: no allocations, no locks.
+int pt_dsp_push(PT_DSP* dsp, const float* mono_samples, int num_samples,
+                DSPFrameOutput* out_frames, int max_frames);
+
+// Same as pt_dsp_push, but returns the most recent analysis instead of every
+// frame. If no hop completed during this call the previous result is returned
+// again. Must be realtime-safe: no allocations, no locks.
 DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_samples);
 
+// Copies the timing counters of dsp into out, zeroing them when reset is true.
+// Safe to call from any thread while pushing; batch and offline analysis are not
+// timed. Returns false if dsp or out is NULL.
+bool pt_dsp_query_timing(PT_DSP* dsp, DSPTimingStats* out, bool reset);
+
+// Smallest duration, in ns, counted by histogram[bucket].
+uint64_t pt_dsp_timing_bucket_lower_ns(int bucket);
+
+// Upper bound of the histogram bucket holding the given fraction (0..1) of
+// calls, e.g. 0.99 for p99, capped at max_ns. Returns 0 when there are no
+// calls.
+uint64_t pt_dsp_timing_percentile_ns(const DSPTimingStats* stats, double fraction);
+
+// Processes count independent streams in one call: out_frames[i] receives what
+// pt_dsp_process(dsps[i], blocks[i], num_samples[i]) would return, and the
+// return value is the number of analyses run across all streams.
+// Streams are taken in groups of eight consecutive handles. Within a group,
+// double-precision direct-engine streams with the same sample rate, frame and
+// hop size compute their difference and CMNDF stages together, interleaved
+// across streams, so put streams with the same configuration next to each
+// other. Handles must be distinct.
+// Intended for server-side analysis: the interleaved workspace is allocated
+// per calling thread on first use, so this is not realtime-safe.
+int pt_dsp_process_batch(PT_DSP* const* dsps, const float* const* blocks, const int* num_samples, int count,
+                         DSPFrameOutput* out_frames);
+
+// Analyses a complete recording on up to num_threads threads (<= 0: one per
+// core) and writes one frame per hop to out_frames, numbered and timestamped
+// as if the whole buffer had been pushed through a single instance.
+// The YIN period search runs in parallel over chunks of chunk_frames hops
+// (<= 0: chosen from the length and thread count), each on its own instance
+// after replaying the window that precedes the chunk. Octave tracking,
+// confidence, history and vibrato then run over the stitched estimates in
+// stream order, so frames match sequential processing except for rounding
+// where a sequential run would have slid the difference function across a
+// chunk boundary.
+// Returns the number of frames written, num_samples / hop_size capped at
+// max_frames, or -1 on invalid arguments or allocation failure. Allocates and
+// starts threads: not for the realtime audio thread.
+int64_t pt_dsp_analyze_offline(DSPConfig cfg, const float* mono_samples, int64_t num_samples, int num_threads,
+                               int chunk_frames, DSPFrameOutput* out_frames, int64_t max_frames);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,95 @@
+#pragma once
+
+// Fixed-width records for handing batches of frames across a language
+// boundary in one call (e.g. a direct ByteBuffer read from the JVM). Each
+// frame is kPackedFrameBytes bytes, little-endian, at these offsets:
+//
+//   0  f64 timestamp_ms         32  f64 confidence
+//   8  f64 freq_hz              40  f64 vibrato_rate_hz
+//  16  f64 midi_float           48  f64 vibrato_depth_cents
+//  24  f64 cents_error          56  i32 nearest_midi
+//                               60  u32 flags (kPackedFlagVibrato)
+//
+// Values are stored as given; a bridge sanitises them before packing.
+// Header-only C++17.
+
+#include "pt_dsp/dsp_api.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "frame_batch.h stores fields in host order and assumes a little-endian host"
+#endif
+
+namespace pt_dsp {
+
+constexpr size_t kPackedFrameBytes = 64;
+
+constexpr size_t kPackedTimestampMs = 0;
+constexpr size_t kPackedFreqHz = 8;
+constexpr size_t kPackedMidiFloat = 16;
+constexpr size_t kPackedCentsError = 24;
+constexpr size_t kPackedConfidence = 32;
+constexpr size_t kPackedVibratoRateHz = 40;
+constexpr size_t kPackedVibratoDepthCents = 48;
+constexpr size_t kPackedNearestMidi = 56;
+constexpr size_t kPackedFlags = 60;
+
+constexpr uint32_t kPackedFlagVibrato = 1u << 0;
+
+namespace frame_batch_detail {
+template <typename V>
+inline void put(uint8_t* record, size_t offset, V value) {
+    std::memcpy(record + offset, &value, sizeof(V));
+}
+
+template <typename V>
+inline V get(const uint8_t* record, size_t offset) {
+    V value;
+    std::memcpy(&value, record + offset, sizeof(V));
+    return value;
+}
+}  // namespace frame_batch_detail
+
+inline void pack_frame(const DSPFrameOutput& frame, uint8_t* record) {
+    using frame_batch_detail::put;
+    put<double>(record, kPackedTimestampMs, frame.timestamp_ms);
+    put<double>(record, kPackedFreqHz, frame.freq_hz);
+    put<double>(record, kPackedMidiFloat, frame.midi_float);
+    put<double>(record, kPackedCentsError, frame.cents_error);
+    put<double>(record, kPackedConfidence, frame.confidence);
+    put<double>(record, kPackedVibratoRateHz, frame.vibrato_rate_hz);
+    put<double>(record, kPackedVibratoDepthCents, frame.vibrato_depth_cents);
+    put<int32_t>(record, kPackedNearestMidi, frame.nearest_midi);
+    put<uint32_t>(record, kPackedFlags, frame.vibrato_detected ? kPackedFlagVibrato : 0u);
+}
+
+inline DSPFrameOutput unpack_frame(const uint8_t* record) {
+    using frame_batch_detail::get;
+    DSPFrameOutput frame{};
+    frame.timestamp_ms = get<double>(record, kPackedTimestampMs);
+    frame.freq_hz = get<double>(record, kPackedFreqHz);
+    frame.midi_float = get<double>(record, kPackedMidiFloat);
+    frame.cents_error = get<double>(record, kPackedCentsError);
+    frame.confidence = get<double>(record, kPackedConfidence);
+    frame.vibrato_rate_hz = get<double>(record, kPackedVibratoRateHz);
+    frame.vibrato_depth_cents = get<double>(record, kPackedVibratoDepthCents);
+    frame.nearest_midi = get<int32_t>(record, kPackedNearestMidi);
+    frame.vibrato_detected = (get<uint32_t>(record, kPackedFlags) & kPackedFlagVibrato) != 0;
+    return frame;
+}
+
+// Packs as many of count frames as fit in capacity_bytes and returns how
+// many were written.
+inline size_t pack_frames(const DSPFrameOutput* frames, size_t count, uint8_t* out, size_t capacity_bytes) {
+    const size_t fit = capacity_bytes / kPackedFrameBytes;
+    const size_t n = count < fit ? count : fit;
+    for (size_t i = 0; i < n; ++i) {
+        pack_frame(frames[i], out + i * kPackedFrameBytes);
+    }
+    return n;
+}
+
+}  // namespace pt_dsp
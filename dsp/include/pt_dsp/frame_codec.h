@@ -0,0 +1,63 @@
+#pragma once
+// Compact storage and transport format for pitch frames: 12 bytes per frame
+// instead of sizeof(DSPFrameOutput) (72), for UI bridges and session files.
+//
+// A block is a PTPackedFrameHeader followed by frame_count records of
+// PT_DSP_PACKED_FRAME_BYTES, all little-endian:
+//
+//   0  u16 dt        ticks (10 us) since the previous frame; 0 for the first
+//   2  i16 cents     cents_error in 1/100 cent
+//   4  u16 conf      confidence in 1/65535
+//   6  u16 depth     vibrato_depth_cents in 1/100 cent
+//   8  u8  rate      vibrato_rate_hz in 1/10 Hz
+//   9  u8  midi      nearest_midi, 255 when unvoiced
+//  10  u8  flags     PT_DSP_PACKED_VOICED | PT_DSP_PACKED_VIBRATO
+//  11  u8  reserved  0
+//
+// Timestamps are rounded to whole ticks before differencing, so decoding
+// them is off by at most half a tick however long the block. freq_hz and
+// midi_float are rebuilt from midi, cents and the block's a4_hz, within
+// 0.005 cents of the original. Values outside a field's range are clamped;
+// a frame whose pitch has no note in 0..254 is stored unvoiced.
+#include "pt_dsp/dsp_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PT_DSP_PACKED_FRAME_MAGIC 0x46505450u  // "PTPF"
+#define PT_DSP_PACKED_FRAME_VERSION 1
+#define PT_DSP_PACKED_FRAME_BYTES 12
+#define PT_DSP_PACKED_TICKS_PER_MS 100
+
+#define PT_DSP_PACKED_VOICED 0x01
+#define PT_DSP_PACKED_VIBRATO 0x02
+
+typedef struct PTPackedFrameHeader {
+    uint32_t magic;        // PT_DSP_PACKED_FRAME_MAGIC
+    uint16_t version;      // PT_DSP_PACKED_FRAME_VERSION
+    uint16_t frame_bytes;  // PT_DSP_PACKED_FRAME_BYTES
+    uint32_t frame_count;
+    float a4_hz;           // tuning the pitch fields are relative to
+    int64_t base_ticks;    // timestamp of the first frame, in ticks
+} PTPackedFrameHeader;
+
+// Encodes frames into one block: fills header and writes
+// header->frame_count records to out_records (room for count records).
+// Deltas must fit a record, so encoding stops before the first frame that
+// is earlier than its predecessor or more than 655.35 ms after it; start a
+// new block from there. Nothing is encoded when the first timestamp is not
+// finite or lies beyond +-2^62 ticks. Returns the number of frames encoded.
+size_t pt_dsp_encode_frames(const DSPFrameOutput* frames, size_t count, double a4_hz,
+                            PTPackedFrameHeader* header, uint8_t* out_records);
+
+// Decodes the header->frame_count records of a block into out_frames.
+// Unvoiced frames and frames without vibrato get the NaN / -1 fields
+// pt_dsp_push reports. Returns the number of frames decoded, or 0 when the
+// header is not a version this library reads.
+size_t pt_dsp_decode_frames(const PTPackedFrameHeader* header, const uint8_t* records,
+                            DSPFrameOutput* out_frames);
+
+#ifdef __cplusplus
+}
+#endif
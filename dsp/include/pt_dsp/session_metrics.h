@@ -0,0 +1,101 @@
+#pragma once
+// Live session scoring kept up to date frame by frame, so a UI can poll a
+// few numbers at display rate (and a server can score a recording) without
+// holding every frame.
+//
+// The aggregator runs the training state machine of the Flutter app's
+// TrainingEngine from the moment a session starts: a countdown, then seeking
+// lock, locked, drift candidate and drift confirmed, with a low-confidence
+// override that suspends it. On top of that it keeps LiveSessionMetrics as
+// LiveSessionCoordinator computes them:
+//
+//   avg_error_cents     mean |effective error| over frames that have one
+//   stability_cents     population standard deviation of the effective error
+//   lock_ratio          locked time / active time
+//   drift_count         confirmed drifts
+//   active_duration_ms  sum of the gaps between consecutive frames
+//
+// The effective error is cents_error clamped to +-cents_error_clamp, or,
+// while qualified vibrato is detected, the mean cents_error over the last
+// effective_error_window_ms. Timestamps are truncated to whole milliseconds,
+// as the platform bridges deliver them, so results match the Dart code for
+// the same frames. Memory is constant: the vibrato window keeps at most
+// PT_DSP_SESSION_METRICS_WINDOW frames, which covers the default 150 ms at
+// any hop of 0.6 ms or more.
+#include "pt_dsp/dsp_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PT_DSP_SESSION_METRICS_WINDOW 256
+
+typedef enum PTSessionState {
+    PT_SESSION_COUNTDOWN = 0,
+    PT_SESSION_SEEKING_LOCK = 1,
+    PT_SESSION_LOCKED = 2,
+    PT_SESSION_DRIFT_CANDIDATE = 3,
+    PT_SESSION_DRIFT_CONFIRMED = 4,
+    PT_SESSION_LOW_CONFIDENCE = 5,
+} PTSessionState;
+
+// Thresholds, in the units of the matching ExerciseConfig / PtConstants
+// fields. Start from pt_dsp_session_metrics_default_config().
+typedef struct PTSessionMetricsConfig {
+    double tolerance_cents;             // 20: within this counts toward lock
+    double drift_threshold_cents;       // 30: beyond this counts toward drift
+    bool drift_awareness_mode;          // false: stay drift-confirmed for good
+    int countdown_ms;                   // 3000
+    double min_confidence;              // 0.60: below this, low confidence
+    double recovery_confidence;         // 0.65: needed to leave low confidence
+    int lock_acquire_ms;                // 300 within tolerance to lock
+    int lock_required_before_drift_ms;  // 500 locked before drift is watched
+    int drift_candidate_ms;             // 200 beyond threshold to suspect drift
+    int drift_confirm_ms;               // 250 more to confirm it
+    int effective_error_window_ms;      // 150
+    double vibrato_rate_min_hz;         // 4
+    double vibrato_rate_max_hz;         // 8
+    double vibrato_depth_limit_cents;   // 30
+    double cents_error_clamp;           // 50
+} PTSessionMetricsConfig;
+
+typedef struct PTSessionMetrics {
+    double avg_error_cents;
+    double stability_cents;
+    double lock_ratio;          // 0..1
+    int64_t drift_count;
+    int64_t active_duration_ms;
+    int64_t locked_duration_ms;
+    uint64_t frames;            // frames added since the session started
+    PTSessionState state;
+} PTSessionMetrics;
+
+typedef struct PT_SESSION_METRICS PT_SESSION_METRICS;
+
+// The thresholds the Flutter app uses by default.
+PTSessionMetricsConfig pt_dsp_session_metrics_default_config(void);
+
+// Creates an aggregator for a session starting now (in its countdown).
+// NULL cfg uses the defaults. Returns NULL on allocation failure.
+PT_SESSION_METRICS* pt_dsp_session_metrics_create(const PTSessionMetricsConfig* cfg);
+
+// NULL is ignored.
+void pt_dsp_session_metrics_destroy(PT_SESSION_METRICS* metrics);
+
+// Starts a new session: clears the metrics and restarts the countdown.
+// Call from the thread that adds frames.
+void pt_dsp_session_metrics_reset(PT_SESSION_METRICS* metrics);
+
+// Folds frames, in stream order, into the metrics and publishes a new
+// snapshot. Frames without a finite timestamp are skipped. One thread at a
+// time; does not allocate. Returns -1 on invalid arguments, else 0.
+int pt_dsp_session_metrics_add(PT_SESSION_METRICS* metrics, const DSPFrameOutput* frames, int count);
+
+// Copies the snapshot published by the last add (or reset) into out. Safe to
+// call from any thread while another adds frames, and never blocks it.
+// Returns false if metrics or out is NULL.
+bool pt_dsp_session_metrics_snapshot(const PT_SESSION_METRICS* metrics, PTSessionMetrics* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,135 @@
+#pragma once
+
+// Full-rate pitch track files. A session file is a 64-byte file header and a
+// run of fixed-size chunks, each a chunk header around one
+// pt_dsp/frame_codec.h block with room for chunk_frames records:
+//
+//   file header   u32 magic "PTSR", u16 version, u16 header bytes,
+//                 u32 chunk_frames, u32 chunk stride, f32 a4_hz,
+//                 u32 flags (kSessionClosedCleanly)
+//   chunk k       u32 magic "PTSC", u32 k, PTPackedFrameHeader,
+//                 padding to 64 bytes, chunk_frames * 12 bytes of records
+//
+// The writer fills a chunk's records before raising its frame_count, so
+// whatever a crashed process had committed is still readable: the reader
+// takes chunks in order until the first one without a valid header.
+// POSIX only (Linux, Android); pt_dsp includes it only on UNIX hosts.
+
+#include "pt_dsp/dsp_api.h"
+#include "pt_dsp/frame_codec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pt_dsp {
+
+constexpr uint32_t kSessionClosedCleanly = 1u << 0;
+
+// Appends frames to a memory-mapped session file. Meant for the analysis
+// thread: appends copy into the mapping and only call into the kernel when
+// the file has to grow, but that growth can block, so keep it off the
+// realtime audio callback.
+class SessionRecorder {
+public:
+    // About five seconds of 256-sample hops at 48 kHz, in 12 KB.
+    static constexpr uint32_t kDefaultChunkFrames = 1024;
+
+    SessionRecorder() = default;
+    ~SessionRecorder();
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    // Creates (or truncates) path. On failure returns false and leaves a
+    // short reason in error().
+    bool open(const std::string& path, double a4_hz, uint32_t chunk_frames = kDefaultChunkFrames);
+
+    // Appends frames in stream order. A frame earlier than its predecessor
+    // or more than 655 ms after it starts a new chunk; one without a finite
+    // timestamp is skipped. Returns false if the file could not grow, in
+    // which case the frames from the failed one on are lost.
+    bool append(const DSPFrameOutput* frames, size_t count);
+
+    // Asks the kernel to write committed frames to storage (msync). Frames
+    // survive a process crash without this; it only matters for power loss.
+    bool flush();
+
+    // Trims the file to its last committed record, marks it closed cleanly
+    // and unmaps it. Safe to call when not open.
+    void close();
+
+    bool is_open() const { return map_ != nullptr; }
+    uint64_t frames_written() const { return frames_written_; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const char* reason);
+    bool start_chunk();
+    bool ensure_mapped(size_t end);
+    uint8_t* chunk_at(uint64_t index) const;
+
+    int fd_ = -1;
+    uint8_t* map_ = nullptr;
+    size_t map_size_ = 0;
+    double a4_hz_ = 440.0;
+    uint32_t chunk_frames_ = 0;
+    size_t chunk_stride_ = 0;
+    uint64_t chunks_ = 0;      // chunks started; the last one is being filled
+    uint32_t committed_ = 0;   // records committed in the last chunk
+    int64_t last_ticks_ = 0;   // timestamp of the last committed record
+    uint64_t frames_written_ = 0;
+    std::string error_;
+};
+
+// Read-only view of a session file, including one whose writer crashed.
+class SessionReader {
+public:
+    SessionReader() = default;
+    ~SessionReader();
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    // Maps path and indexes its chunks. On failure returns false and leaves a
+    // short reason in error().
+    bool open(const std::string& path);
+    void close();
+
+    uint64_t frame_count() const { return frame_count_; }
+    double a4_hz() const { return a4_hz_; }
+    // False when the writer never closed the file, e.g. it crashed; the
+    // frames it had committed are still all readable.
+    bool closed_cleanly() const { return closed_cleanly_; }
+    const std::string& error() const { return error_; }
+
+    // Decodes count frames starting at frame index first into out. Returns
+    // the number decoded, short only at the end of the file.
+    size_t read(uint64_t first, size_t count, DSPFrameOutput* out);
+
+    // Index of the first frame whose timestamp is at or after timestamp_ms,
+    // or frame_count() if there is none. Timestamps are those stored, i.e.
+    // rounded to 10 us, and assumed non-decreasing as pt_dsp_push makes them.
+    uint64_t seek(double timestamp_ms) const;
+
+private:
+    // A non-empty chunk. The header is copied at open, with frame_count
+    // cut to the records the file actually holds.
+    struct Chunk {
+        PTPackedFrameHeader header;
+        const uint8_t* records;
+        uint64_t first_frame;
+    };
+
+    bool fail(const char* reason);
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    double a4_hz_ = 440.0;
+    bool closed_cleanly_ = false;
+    uint64_t frame_count_ = 0;
+    std::vector<Chunk> chunks_;
+    std::vector<DSPFrameOutput> scratch_;
+    std::string error_;
+};
+
+}  // namespace pt_dsp
@@ -0,0 +1,201 @@
+#pragma once
+
+// Single-producer single-consumer ring for handing analysis results from the
+// realtime audio thread to a consumer thread (platform bridges, server
+// pipelines). Header-only C++17.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
+
+namespace pt_dsp {
+
+constexpr size_t kCacheLineSize = 64;
+
+// Lets the consumer of a ring sleep until the producer publishes, without
+// the producer ever blocking. An event count: the consumer announces itself
+// with prepare_wait(), re-checks its condition, then waits on the ticket it
+// got; notify() only touches the kernel while a consumer is announced.
+// On Linux and Android the wait is a private futex. Elsewhere it polls the
+// count every 250 us until the timeout.
+class RingWakeup {
+public:
+    // Producer side, after publishing. Lock-free: a fence and a load, plus a
+    // futex wake (which does not sleep) when a consumer is waiting.
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed) != 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            wake();
+        }
+    }
+
+    // Consumer side: announce, then re-check the condition before wait().
+    uint32_t prepare_wait() {
+        waiting_.store(1, std::memory_order_relaxed);
+        const uint32_t ticket = epoch_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return ticket;
+    }
+
+    // Sleeps until a notify() after prepare_wait() returned ticket, or until
+    // timeout. May return early.
+    void wait(uint32_t ticket, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+        const int64_t ns = timeout.count() > 0 ? timeout.count() : 0;
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, ticket, &ts, nullptr, 0);
+#else
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (epoch_.load(std::memory_order_acquire) == ticket && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+#endif
+    }
+
+    // Consumer side, once done waiting.
+    void cancel_wait() { waiting_.store(0, std::memory_order_relaxed); }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+                  "the futex word must be a plain 32-bit atomic");
+
+#if defined(__linux__)
+    uint32_t* futex_word() { return reinterpret_cast<uint32_t*>(&epoch_); }
+    void wake() { syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0); }
+#else
+    void wake() {}
+#endif
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> waiting_{0};
+};
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity is a power of two and every slot is usable: the indices
+// run freely and are masked, not reduced modulo the size. Each side keeps its
+// index on its own cache line next to a cached copy of the other side's, so
+// the shared lines only move when a side finds the ring apparently full or
+// empty. Items are copied in and out whole; batch calls copy as many as fit
+// and publish them with one store.
+//
+// Every push wakes a consumer blocked in wait(); a consumer that only polls
+// costs each push one fence and a load. Nothing on the producer side
+// allocates, locks or sleeps, so it is safe on the realtime thread.
+template <typename T, size_t Capacity>
+class SpscRing {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(Capacity <= (size_t{1} << 31), "indices are 32-bit");
+    static_assert(std::is_trivially_copyable<T>::value, "items are copied without running constructors");
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Producer: appends up to count items and returns how many fit.
+    size_t push(const T* items, size_t count) {
+        const uint32_t tail = producer_.tail.load(std::memory_order_relaxed);
+        size_t free_slots = Capacity - (tail - producer_.cached_head);
+        if (free_slots < count) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            free_slots = Capacity - (tail - producer_.cached_head);
+        }
+        const size_t n = count < free_slots ? count : free_slots;
+        for (size_t i = 0; i < n; ++i) {
+            slots_[(tail + i) & kMask] = items[i];
+        }
+        if (n > 0) {
+            producer_.tail.store(tail + static_cast<uint32_t>(n), std::memory_order_release);
+            wakeup_.notify();
+        }
+        return n;
+    }
+
+    bool push(const T& item) { return push(&item, 1) == 1; }
+
+    // Consumer: removes up to max_count items into out and returns how many.
+    size_t pop(T* out, size_t max_count) {
+        const uint32_t head = consumer_.head.load(std::memory_order_relaxed);
+        size_t ready = consumer_.cached_tail - head;
+        if (ready < max_count) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            ready = consumer_.cached_tail - head;
+        }
+        const size_t n = max_count < ready ? max_count : ready;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = slots_[(head + i) & kMask];
+        }
+        if (n > 0) {
+            consumer_.head.store(head + static_cast<uint32_t>(n), std::memory_order_release);
+        }
+        return n;
+    }
+
+    bool pop(T* out) { return pop(out, 1) == 1; }
+
+    // Consumer: blocks until an item is ready, wake_consumer() has been
+    // called since the last wait() or timeout passes. Returns true when pop()
+    // will find an item.
+    bool wait(std::chrono::nanoseconds timeout) {
+        if (ready() || woken_.exchange(false, std::memory_order_acquire)) {
+            return ready();
+        }
+        const uint32_t ticket = wakeup_.prepare_wait();
+        if (!ready() && !woken_.load(std::memory_order_relaxed)) {
+            wakeup_.wait(ticket, timeout);
+        }
+        wakeup_.cancel_wait();
+        woken_.store(false, std::memory_order_relaxed);
+        return ready();
+    }
+
+    // Any thread: makes the consumer's current or next wait() return, e.g. so
+    // it sees a stop flag set just before.
+    void wake_consumer() {
+        woken_.store(true, std::memory_order_release);
+        wakeup_.notify();
+    }
+
+    // Items queued, as seen from the calling thread; exact only on the
+    // consumer when the producer is idle, and vice versa.
+    size_t size() const {
+        return producer_.tail.load(std::memory_order_acquire) - consumer_.head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+
+    bool ready() {
+        consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+        return consumer_.cached_tail != consumer_.head.load(std::memory_order_relaxed);
+    }
+
+    struct alignas(kCacheLineSize) ProducerSide {
+        std::atomic<uint32_t> tail{0};
+        uint32_t cached_head = 0;  // consumer's head as last read
+    };
+    struct alignas(kCacheLineSize) ConsumerSide {
+        std::atomic<uint32_t> head{0};
+        uint32_t cached_tail = 0;  // producer's tail as last read
+    };
+
+    ProducerSide producer_;
+    ConsumerSide consumer_;
+    alignas(kCacheLineSize) RingWakeup wakeup_;
+    std::atomic<bool> woken_{false};
+    alignas(kCacheLineSize) T slots_[Capacity]{};
+};
+
+}  // namespace pt_dsp
@@ -0,0 +1,90 @@
+#pragma once
+// Streaming C API for consumers that read frames straight out of native
+// memory (Dart FFI, other language bindings) instead of having each frame
+// marshalled to them. Implemented by the pt_dsp_stream shared library, which
+// carries its own copy of the DSP.
+//
+// A stream is an analysis instance plus a ring of DSPFrameOutput records.
+// One thread pushes PCM; every frame it produces is written to the ring and
+// numbered by a 64-bit sequence that starts at 0. Any number of readers poll
+// the ring at their own pace. The writer never waits for them: once the
+// ring wraps, the oldest records are overwritten, and a reader more than
+// capacity frames behind loses the frames in between.
+#include "pt_dsp/dsp_api.h"
+
+// Marks the entry points pt_dsp_stream exports; everything else in the
+// library is hidden.
+#if defined(_WIN32)
+#if defined(PT_DSP_STREAM_BUILD)
+#define PT_DSP_STREAM_API __declspec(dllexport)
+#else
+#define PT_DSP_STREAM_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define PT_DSP_STREAM_API __attribute__((visibility("default")))
+#else
+#define PT_DSP_STREAM_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Byte offset of slot 0 from the start of the ring header.
+#define PT_DSP_STREAM_RING_HEADER_BYTES 64
+
+// Fixed layout shared with readers; frame seq sits in slot
+// seq & (capacity - 1), at PT_DSP_STREAM_RING_HEADER_BYTES +
+// slot * frame_stride bytes from the header. The writer advances
+// frames_begun before it starts overwriting slots and frames_written once
+// they hold their new frames, so a record copied while
+// frames_begun - capacity <= seq < frames_written (frames_written read
+// before the copy, frames_begun after it) is intact. Readers in C use
+// pt_dsp_stream_frames_written / pt_dsp_stream_frames_begun for the
+// ordered loads.
+typedef struct PTDSPFrameRing {
+    uint64_t frames_begun;
+    uint64_t frames_written;
+    uint32_t capacity;      // slots, a power of two
+    uint32_t frame_stride;  // sizeof(DSPFrameOutput)
+} PTDSPFrameRing;
+
+typedef struct PT_DSP_STREAM PT_DSP_STREAM;
+
+// Creates a stream analysing cfg with a ring of at least ring_capacity
+// frames (rounded up to a power of two, at least 2). Returns NULL if the
+// instance cannot be created or allocation fails.
+PT_DSP_STREAM_API PT_DSP_STREAM* pt_dsp_stream_open(DSPConfig cfg, uint32_t ring_capacity);
+
+// Releases the stream and its ring; readers must be done with it. NULL is
+// ignored.
+PT_DSP_STREAM_API void pt_dsp_stream_close(PT_DSP_STREAM* stream);
+
+// Writer thread: feeds samples like pt_dsp_push and publishes every frame
+// they complete. Returns the number of frames published, or -1 on invalid
+// arguments. Does not allocate.
+PT_DSP_STREAM_API int pt_dsp_stream_push(PT_DSP_STREAM* stream, const float* mono_samples, int num_samples);
+
+// The ring, valid until pt_dsp_stream_close. Its address never changes, so
+// a binding can map the header and slots once.
+PT_DSP_STREAM_API const PTDSPFrameRing* pt_dsp_stream_ring(const PT_DSP_STREAM* stream);
+
+// Sequence number after the last published frame (acquire load): every
+// frame below it has been written.
+PT_DSP_STREAM_API uint64_t pt_dsp_stream_frames_written(const PT_DSP_STREAM* stream);
+
+// frames_begun, loaded after an acquire fence, for validating records copied
+// since the matching pt_dsp_stream_frames_written call.
+PT_DSP_STREAM_API uint64_t pt_dsp_stream_frames_begun(const PT_DSP_STREAM* stream);
+
+// Copies up to max_frames published frames from *cursor onwards to
+// out_frames and advances *cursor past them. A cursor that has fallen more
+// than capacity frames behind first skips to the oldest intact frame, and
+// *dropped (if not NULL) receives the number of frames skipped. Returns the
+// number of frames copied, or -1 on invalid arguments.
+PT_DSP_STREAM_API int pt_dsp_stream_read(const PT_DSP_STREAM* stream, uint64_t* cursor, DSPFrameOutput* out_frames,
+                                         int max_frames, uint64_t* dropped);
+
+#ifdef __cplusplus
+}
+#endif
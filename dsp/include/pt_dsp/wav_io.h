@@ -0,0 +1,173 @@
+#pragma once
+// WAV file I/O shared by the offline tools and harnesses (the pt_dsp_io
+// library; POSIX only). Three ways in and one way out:
+//
+//   MappedWav        maps the whole file; zero-copy, random access
+//   WavStreamReader  reads through a fixed buffer, for files larger than RAM
+//                    or the address space
+//   WavWriter        converts and writes in large blocks
+//
+// All of them convert through wav_to_mono / wav_from_float, which use
+// SSE2 / NEON for the common layouts and give the same samples as the scalar
+// loops on every path.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pt_dsp {
+
+enum class WavEncoding {
+    kPcm16,
+    kPcm24,
+    kPcm32,
+    kFloat32,
+};
+
+int wav_bytes_per_sample(WavEncoding encoding);
+
+// Converts count frames of interleaved little-endian samples at src to mono
+// float in [-1, 1], averaging channels. src need not be aligned.
+void wav_to_mono(const uint8_t* src, WavEncoding encoding, int channels, size_t count, float* out);
+
+// Converts count float samples to encoding at dst. PCM is clamped to
+// [-1, 1], scaled by the largest positive code and rounded to nearest; NaN
+// becomes 0. Float32 is stored as is.
+void wav_from_float(const float* src, size_t count, WavEncoding encoding, uint8_t* dst);
+
+// Layout of a parsed file.
+struct WavFormat {
+    int sample_rate = 0;
+    int channels = 0;
+    WavEncoding encoding = WavEncoding::kPcm16;
+    uint64_t data_offset = 0;  // of the first sample, from the start of the file
+    int64_t frames = 0;        // sample frames (one sample per channel)
+
+    int frame_bytes() const { return wav_bytes_per_sample(encoding) * channels; }
+};
+
+// Read-only memory mapping of a RIFF/WAVE file. The sample data is never
+// copied: read_mono() converts and downmixes straight from the mapping, and
+// mono float32 files can be handed to the DSP in place through float_data().
+class MappedWav {
+public:
+    MappedWav() = default;
+    ~MappedWav();
+    MappedWav(const MappedWav&) = delete;
+    MappedWav& operator=(const MappedWav&) = delete;
+
+    // Maps path and parses its fmt and data chunks. On failure returns false
+    // and leaves a short reason in error().
+    bool open(const std::string& path);
+    void close();
+
+    const WavFormat& format() const { return format_; }
+    int sample_rate() const { return format_.sample_rate; }
+    int channels() const { return format_.channels; }
+    WavEncoding encoding() const { return format_.encoding; }
+    int64_t frames() const { return format_.frames; }
+    const std::string& error() const { return error_; }
+
+    // Non-null when the file is mono float32 with a suitably aligned data
+    // chunk, in which case samples can be read without conversion.
+    const float* float_data() const;
+
+    // Writes count frames starting at first_frame to out as mono float in
+    // [-1, 1], averaging channels. Returns the number of frames written,
+    // which is short only at the end of the file.
+    int read_mono(int64_t first_frame, int count, float* out) const;
+
+private:
+    bool fail(const char* reason);
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    const uint8_t* data_ = nullptr;
+    WavFormat format_;
+    std::string error_;
+};
+
+// Sequential reader that holds one buffer of raw samples at a time, so its
+// footprint does not depend on the file size.
+class WavStreamReader {
+public:
+    static constexpr size_t kDefaultBufferBytes = size_t{1} << 20;
+
+    WavStreamReader() = default;
+    ~WavStreamReader();
+    WavStreamReader(const WavStreamReader&) = delete;
+    WavStreamReader& operator=(const WavStreamReader&) = delete;
+
+    // Opens path and parses its header. On failure returns false and leaves a
+    // short reason in error().
+    bool open(const std::string& path, size_t buffer_bytes = kDefaultBufferBytes);
+    void close();
+
+    const WavFormat& format() const { return format_; }
+    int sample_rate() const { return format_.sample_rate; }
+    int channels() const { return format_.channels; }
+    int64_t frames() const { return format_.frames; }
+    // Index of the next frame read_mono returns.
+    int64_t position() const { return position_; }
+    const std::string& error() const { return error_; }
+
+    // Moves to frame; false if it is past the end.
+    bool seek(int64_t frame);
+
+    // Reads up to count frames from position() on as mono float, averaging
+    // channels. Returns the number read: short at the end of the file, -1 on
+    // a read error.
+    int read_mono(int count, float* out);
+
+private:
+    bool fail(const char* reason);
+
+    int fd_ = -1;
+    WavFormat format_;
+    int64_t position_ = 0;
+    std::vector<uint8_t> buffer_;
+    std::string error_;
+};
+
+// Writes a canonical 44-byte-header WAV file. Samples are converted into an
+// internal buffer and written when it fills, and the header sizes are filled
+// in by close().
+class WavWriter {
+public:
+    static constexpr size_t kBufferBytes = size_t{256} << 10;
+
+    WavWriter() = default;
+    ~WavWriter();
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    // Creates (or truncates) path. On failure returns false and leaves a
+    // short reason in error().
+    bool open(const std::string& path, int sample_rate, int channels, WavEncoding encoding);
+
+    // Appends count frames of interleaved float samples.
+    bool write(const float* interleaved, size_t count);
+
+    // Flushes, completes the header and closes the file. Returns false if any
+    // write failed. Safe to call when not open.
+    bool close();
+
+    int64_t frames_written() const { return frames_written_; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const char* reason);
+    bool flush();
+
+    int fd_ = -1;
+    int channels_ = 0;
+    WavEncoding encoding_ = WavEncoding::kPcm16;
+    std::vector<uint8_t> buffer_;
+    size_t buffered_ = 0;
+    int64_t frames_written_ = 0;
+    bool failed_ = false;
+    std::string error_;
+};
+
+}  // namespace pt_dsp
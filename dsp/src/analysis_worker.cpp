@@ -0,0 +1,118 @@
+#include "pt_dsp/analysis_worker.h"
+
+#include "dsp_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pt_dsp {
+
+namespace {
+// Bounds how long the worker sleeps without input, as a safety net; stop()
+// wakes it directly.
+constexpr auto kIdleTimeout = std::chrono::milliseconds(100);
+
+void raise_thread_priority(int nice_value) {
+#if defined(__linux__)
+    // Per-thread on Linux: the "process" id here is the calling thread's id.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice_value);
+#else
+    (void)nice_value;
+#endif
+}
+}  // namespace
+
+AnalysisWorker::AnalysisWorker(PT_DSP* dsp, DSPConfig cfg, FrameSink sink, void* user, int thread_nice)
+    : dsp_(dsp), cfg_(cfg), sink_(sink), user_(user), thread_nice_(thread_nice) {
+    // Sized from the hop dsp actually runs with, so one chunk never yields
+    // more than kMaxFramesPerChunk frames.
+    const int hop = resolved_config(dsp).hop_size;
+    chunk_.resize(static_cast<size_t>(hop) * kMaxFramesPerChunk);
+}
+
+AnalysisWorker::~AnalysisWorker() { stop(); }
+
+bool AnalysisWorker::start() {
+    if (running_.exchange(true)) {
+        return false;
+    }
+    try {
+        thread_ = std::thread(&AnalysisWorker::run, this);
+    } catch (const std::system_error&) {
+        running_.store(false);
+        return false;
+    }
+    return true;
+}
+
+void AnalysisWorker::stop() {
+    running_.store(false, std::memory_order_release);
+    ring_.wake_consumer();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t AnalysisWorker::push(const float* samples, size_t count) {
+    const size_t queued = ring_.push(samples, count);
+    samples_pushed_.fetch_add(queued, std::memory_order_relaxed);
+    if (queued < count) {
+        samples_dropped_.fetch_add(count - queued, std::memory_order_relaxed);
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return queued;
+}
+
+AnalysisWorkerStats AnalysisWorker::stats() const {
+    AnalysisWorkerStats s{};
+    s.samples_pushed = samples_pushed_.load(std::memory_order_relaxed);
+    s.samples_dropped = samples_dropped_.load(std::memory_order_relaxed);
+    s.overruns = overruns_.load(std::memory_order_relaxed);
+    s.samples_analyzed = samples_analyzed_.load(std::memory_order_relaxed);
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.backlog_samples = ring_.size();
+    s.max_backlog_samples = max_backlog_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AnalysisWorker::run() {
+    raise_thread_priority(thread_nice_);
+    pt_dsp_reserve_thread_scratch(cfg_);
+    while (running_.load(std::memory_order_acquire)) {
+        if (ring_.wait(kIdleTimeout)) {
+            drain();
+        }
+    }
+    drain();
+}
+
+// Analyses everything queued, a chunk at a time.
+void AnalysisWorker::drain() {
+    DSPFrameOutput frames[kMaxFramesPerChunk];
+    while (true) {
+        const size_t backlog = ring_.size();
+        if (backlog > max_backlog_.load(std::memory_order_relaxed)) {
+            max_backlog_.store(backlog, std::memory_order_relaxed);
+        }
+        const size_t n = ring_.pop(chunk_.data(), chunk_.size());
+        if (n == 0) {
+            return;
+        }
+        const int produced = pt_dsp_push(dsp_, chunk_.data(), static_cast<int>(n), frames, kMaxFramesPerChunk);
+        const size_t delivered = static_cast<size_t>(std::clamp(produced, 0, kMaxFramesPerChunk));
+        if (delivered > 0) {
+            sink_(user_, frames, delivered);
+        }
+        samples_analyzed_.fetch_add(n, std::memory_order_relaxed);
+        frames_.fetch_add(delivered, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace pt_dsp
@@ -0,0 +1,73 @@
+#include "decimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pt_dsp {
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+// -6 dB point of the low-pass, as a fraction of the output rate. With the
+// Blackman window and kDecimatorTapsPerPhase taps per unit of factor, the
+// stop band (about -74 dB) starts near 0.4 of the output rate, so anything
+// that aliases lands above 0.4 and the fundamental range stays clean.
+constexpr double kCutoff = 0.3125;
+}  // namespace
+
+void Decimator::configure(int factor) {
+    factor_ = std::clamp(factor, 1, kMaxDecimation);
+    pos_ = 0;
+    history_.fill(0.0f);
+    if (factor_ == 1) {
+        taps_ = 1;
+        coeffs_[0] = 1.0f;
+        return;
+    }
+    taps_ = factor_ * kDecimatorTapsPerPhase;
+    const double fc = kCutoff / static_cast<double>(factor_);
+    const double centre = 0.5 * static_cast<double>(taps_ - 1);
+    double sum = 0.0;
+    for (int i = 0; i < taps_; ++i) {
+        const double t = static_cast<double>(i) - centre;
+        const double sinc = 2.0 * fc * (t == 0.0 ? 1.0 : std::sin(2.0 * kPi * fc * t) / (2.0 * kPi * fc * t));
+        const double phase = 2.0 * kPi * static_cast<double>(i) / static_cast<double>(taps_ - 1);
+        const double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        coeffs_[i] = static_cast<float>(sinc * window);
+        sum += sinc * window;
+    }
+    // Unity gain at DC.
+    for (int i = 0; i < taps_; ++i) {
+        coeffs_[i] = static_cast<float>(coeffs_[i] / sum);
+    }
+}
+
+int Decimator::process(const float* in, int count, int64_t first_index, float* out) {
+    int produced = 0;
+    int phase = static_cast<int>(first_index % factor_);
+    for (int i = 0; i < count; ++i) {
+        pos_ = pos_ == 0 ? taps_ - 1 : pos_ - 1;
+        history_[pos_] = in[i];
+        history_[pos_ + taps_] = in[i];
+        if (++phase < factor_) {
+            continue;
+        }
+        phase = 0;
+        // Four partial sums keep the multiply-adds independent.
+        const float* x = history_.data() + pos_;
+        const float* h = coeffs_.data();
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        int j = 0;
+        for (; j + 4 <= taps_; j += 4) {
+            acc[0] += h[j] * x[j];
+            acc[1] += h[j + 1] * x[j + 1];
+            acc[2] += h[j + 2] * x[j + 2];
+            acc[3] += h[j + 3] * x[j + 3];
+        }
+        for (; j < taps_; ++j) {
+            acc[0] += h[j] * x[j];
+        }
+        out[produced++] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+    return produced;
+}
+
+}  // namespace pt_dsp
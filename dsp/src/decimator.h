@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace pt_dsp {
+
+constexpr int kMaxDecimation = 16;
+// Filter length per unit of decimation factor. The transition band is a
+// fixed fraction of the output rate whatever the factor.
+constexpr int kDecimatorTapsPerPhase = 32;
+constexpr int kMaxDecimatorTaps = kMaxDecimation * kDecimatorTapsPerPhase;
+
+// Integer-factor decimator with a windowed-sinc anti-aliasing filter. The
+// filter is evaluated in polyphase form: only the kept outputs are computed,
+// so each input sample costs kDecimatorTapsPerPhase multiply-adds whatever
+// the factor.
+//
+// Taps are computed once by configure(). process() keeps the filter history
+// across calls and neither allocates nor locks. Output m is the filtered
+// input at absolute sample index (m + 1) * factor - 1, so which samples are
+// kept depends on the stream position and not on how the input is split
+// into calls or where an instance started.
+class Decimator {
+public:
+    // Sets the factor (clamped to [1, kMaxDecimation]), designs the filter
+    // and clears the history.
+    void configure(int factor);
+
+    int factor() const { return factor_; }
+    // Filter length in input samples; the filter delays its input by
+    // (taps() - 1) / 2 samples.
+    int taps() const { return taps_; }
+
+    // Filters count samples, the first of which has absolute index
+    // first_index, and writes the kept outputs to out. Returns the number
+    // written, at most count / factor() + 1.
+    int process(const float* in, int count, int64_t first_index, float* out);
+
+private:
+    int factor_ = 1;
+    int taps_ = 1;
+    int pos_ = 0;
+    std::array<float, kMaxDecimatorTaps> coeffs_{};
+    // The last taps_ inputs, newest first from history_[pos_], stored twice
+    // so they are always contiguous.
+    std::array<float, 2 * kMaxDecimatorTaps> history_{};
+};
+
+}  // namespace pt_dsp
@@ -1,17 +1,52 @@
 #include "pt_dsp/dsp_api.h"
 
+#include "decimator.h"
+#include "dsp_internal.h"
+#include "fft_difference.h"
+#include "kernels.h"
+#include "latency_histogram.h"
+#include "pitch_history.h"
+
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <new>
+#include <type_traits>
 
 namespace {
 constexpr int kMaxProcessSamples = 4096;
-constexpr int kMinFreqHz = 80;
-constexpr int kMaxFreqHz = 1100;
-constexpr int kHistorySize = 64;
+constexpr int kDefaultFrameSize = 1024;
+// Input is kept contiguous; once full, the live window is moved to the front.
+// Compact instances hold just the window and one hop, moving it every hop.
+constexpr int kInputCapacity = 2 * kMaxProcessSamples;
+// Full difference recompute period for the sliding update, bounding rounding drift.
+constexpr int kDiffRefreshHops = 64;
+// Tile sizes for direct difference sums over interleaved streams (see batch_direct_sums).
+constexpr int kBatchSampleBlock = 64;
+constexpr int kBatchLagBlock = 64;
+// Coarse-to-fine lag search: grid points per shortest period of interest
+// (min_lag), the largest grid spacing, and the grid CMNDF below which a local
+// minimum is refined while looking for the first dip under kYinThreshold.
+constexpr int kCoarsePointsPerMinPeriod = 8;
+constexpr int kMaxLagStride = 8;
+constexpr double kCoarseRefineGate = 0.5;
+// Tracked lag search: half-width of each lag window (25 cents, as a lag
+// ratio), how often per second of input a full search is forced, and the
+// largest window energy ratio between consecutive hops that keeps the lock.
+constexpr double kTrackedWindowRatio = 1.0145453349375237;
+constexpr int kTrackedRescansPerSecond = 1;
+constexpr double kTrackedMaxEnergyRatio = 2.0;
+// Decimation front-end: the factor is the largest that keeps the analysis
+// rate at or above this. The decimated buffer holds the retained window plus
+// one hop's outputs, at most frame / 2 + hop / 2 + 1 for a factor of 2;
+// compact instances size it to exactly that.
+constexpr int kDecimatedMinRateHz = 8000;
+constexpr int kDecimatedCapacity = kMaxProcessSamples + 1;
 constexpr double kYinThreshold = 0.12;
 constexpr double kMaxTrackingJumpCents = 700.0;
 constexpr double kUnvoicedEnergyFloor = 1e-6;
@@ -60,44 +95,80 @@ inline void sanitize_output(DSPFrameOutput* out) {
         out->vibrato_depth_cents = NAN;
     }
 }
+
+// Per-window analysis buffers, in the sample type selected by DSPConfig::precision.
+template <typename T>
+struct AnalysisScratch {
+    std::array<T, kMaxProcessSamples> centered{};
+    std::array<T, kMaxProcessSamples> diff{};
+    std::array<T, kMaxProcessSamples> cmndf{};
+};
+
+// Decimated copy of the input for PT_DSP_DECIMATION_AUTO, appended to as
+// samples arrive and compacted like PT_DSP::input.
+struct DecimatedInput {
+    pt_dsp::Decimator filter;
+    float* samples = nullptr;  // capacity floats, placed after the instance
+    int capacity = 0;
+    int len = 0;
+    int64_t fed = 0;     // input samples filtered since pt_dsp_create
+    int frame_size = 0;  // PT_DSP::frame_size / factor
+    int min_lag = 1;     // lag range at the decimated rate
+    int max_lag = 1;
+};
+// Prefix sums of the centred window for PT_DSP_LAG_SEARCH_TRACKED, from
+// which cumulative_difference() gets the CMNDF normaliser at any lag.
+struct TrackedScratch {
+    std::array<double, kMaxProcessSamples + 1> prefix{};     // sum of x[0 .. i)
+    std::array<double, kMaxProcessSamples + 1> prefix_sq{};  // sum of x[0 .. i)^2
+    double base = 0.0;  // shifted_prefix_dot() at min_lag
+};
 }  // namespace
 
 struct PT_DSP {
     DSPConfig cfg{};
-    double t_ms = 0.0;
-    std::array<double, kHistorySize> recent_cents{};
-    std::array<double, kHistorySize> recent_time_ms{};
-    int history_count = 0;
-    int history_head = 0;
-    std::array<double, kHistorySize> recent_freq_hz{};
+    int sample_rate = 1;
+    int frame_size = kDefaultFrameSize;
+    int hop_size = kDefaultFrameSize;
+    int min_lag = 1;
+    int max_lag = 1;
+    int lag_stride = 1;  // > 1 selects the coarse-to-fine search on that lag grid
+    // PT_DSP_LAG_SEARCH_TRACKED: refined lag of the last dip found under the
+    // threshold (0 when the previous window had none), and hops since the
+    // last full search.
+    double locked_lag = 0.0;
+    int hops_since_full_search = 0;
+    double window_energy = 0.0;  // of the last window prepare_window() centred
+    float* input = nullptr;      // input_capacity floats, placed after the instance
+    int input_capacity = 0;
+    int input_len = 0;
+    int hop_fill = 0;
+    int64_t samples_consumed = 0;
+    DSPFrameOutput last_output{};
+    bool diff_valid = false;
+    int hops_since_refresh = 0;
+    pt_dsp::PitchHistory history;
     double last_tracked_freq_hz = NAN;
-    std::array<double, kMaxProcessSamples> centered{};
-    std::array<double, kMaxProcessSamples> diff{};
-    std::array<double, kMaxProcessSamples> cmndf{};
-#ifndef NDEBUG
-    uint64_t process_calls = 0;
-    uint64_t process_total_us = 0;
-    uint64_t process_max_us = 0;
-#endif
+    // Parts placed after the instance in its block (see InstanceLayout).
+    // Exactly one scratch is set, matching cfg.precision; compact instances
+    // point it, and tracked, at the analysing thread's before each window
+    // (see bind_thread_scratch).
+    AnalysisScratch<double>* scratch_f64 = nullptr;
+    AnalysisScratch<float>* scratch_f32 = nullptr;
+    pt_dsp::FftDifference* fft_diff = nullptr;  // set when cfg.diff_engine == PT_DSP_DIFF_FFT
+    DecimatedInput* decimated = nullptr;        // set when cfg.decimation == PT_DSP_DECIMATION_AUTO
+    TrackedScratch* tracked = nullptr;          // set when cfg.lag_search == PT_DSP_LAG_SEARCH_TRACKED
+    bool owns_memory = false;                   // block came from pt_dsp_create
+    const pt_dsp::Kernels* kernels = &pt_dsp::scalar_kernels();
+    // kernels' difference specialised for this sample rate and frame size, if any.
+    const pt_dsp::ShapeKernels* shape = nullptr;
+    pt_dsp::LatencyHistogram timing;
 };
 
 namespace {
-inline int wrap_history_index(int head, int offset_from_oldest, int count) {
-    const int oldest = (head - count + kHistorySize) % kHistorySize;
-    return (oldest + offset_from_oldest) % kHistorySize;
-}
-
-double parabolic_lag_refine(const std::array<double, kMaxProcessSamples>& cmndf,
-                            int lag,
-                            int min_lag,
-                            int max_lag) {
-    if (lag <= min_lag || lag >= max_lag - 1) {
-        return static_cast<double>(lag);
-    }
-
-    const double y0 = cmndf[lag - 1];
-    const double y1 = cmndf[lag];
-    const double y2 = cmndf[lag + 1];
+// Vertex of the parabola through (lag - 1, y0), (lag, y1), (lag + 1, y2),
+// clamped to half a lag either side.
+double parabolic_vertex(int lag, double y0, double y1, double y2) {
     const double denom = 2.0 * (2.0 * y1 - y0 - y2);
     if (std::abs(denom) < 1e-12) {
         return static_cast<double>(lag);
@@ -106,6 +177,15 @@ double parabolic_lag_refine(const std::array<double, kMaxProcessSamples>& cmndf,
     return static_cast<double>(lag) + std::clamp(delta, -0.5, 0.5);
 }
 
+template <typename T>
+double parabolic_lag_refine(const T* cmndf, int lag, int min_lag, int max_lag) {
+    if (lag <= min_lag || lag >= max_lag - 1) {
+        return static_cast<double>(lag);
+    }
+    return parabolic_vertex(lag, static_cast<double>(cmndf[lag - 1]), static_cast<double>(cmndf[lag]),
+                            static_cast<double>(cmndf[lag + 1]));
+}
+
 double cents_distance(double a_hz, double b_hz) {
     if (!is_finite_positive(a_hz) || !is_finite_positive(b_hz)) {
         return 1e9;
@@ -141,176 +221,597 @@ double choose_tracked_frequency(const PT_DSP* dsp, double base_freq) {
     return best_distance <= kMaxTrackingJumpCents ? best : base_freq;
 }
 
-double estimate_vibrato_rate_hz(const PT_DSP* dsp) {
-    if (dsp->history_count < 12) {
+double estimate_vibrato_rate_hz(const pt_dsp::PitchHistory& history) {
+    if (history.size() < 12) {
         return NAN;
     }
-
-    double sum = 0.0;
-    int count = 0;
-    for (int i = 0; i < dsp->history_count; ++i) {
-        const int idx = wrap_history_index(dsp->history_head, i, dsp->history_count);
-        sum += dsp->recent_cents[idx];
-        ++count;
-    }
-    if (count == 0) {
+    const int cycles = history.mean_crossings() / 2;
+    if (cycles <= 0) {
         return NAN;
     }
-    const double mean = sum / static_cast<double>(count);
-
-    int zero_crossings = 0;
-    int prev_sign = 0;
-    double oldest_t = NAN;
-    for (int i = 0; i < dsp->history_count; ++i) {
-        const int idx = wrap_history_index(dsp->history_head, i, dsp->history_count);
-        const double centered = dsp->recent_cents[idx] - mean;
-        const int sign = centered > 0 ? 1 : (centered < 0 ? -1 : 0);
-        if (sign != 0) {
-            if (prev_sign != 0 && sign != prev_sign) {
-                ++zero_crossings;
+    const double duration_s = std::max(1e-6, (history.newest_time_ms() - history.oldest_time_ms()) / 1000.0);
+    return static_cast<double>(cycles) / duration_s;
+}
+
+void reset_output(DSPFrameOutput* out, double timestamp_ms) {
+    *out = DSPFrameOutput{};
+    out->timestamp_ms = timestamp_ms;
+    out->freq_hz = NAN;
+    out->midi_float = NAN;
+    out->nearest_midi = -1;
+    out->cents_error = NAN;
+    out->confidence = 0.0;
+    out->vibrato_detected = false;
+    out->vibrato_rate_hz = NAN;
+    out->vibrato_depth_cents = NAN;
+}
+
+// Advances diff[] from the window that started one hop earlier to the current
+// one, at every lag_stride-th lag from min_lag. Pairs (i, i + lag) leaving
+// through the front of the old window are subtracted and pairs entering
+// through the back are added, which costs
+// 2 * hop multiply-adds per lag instead of n - lag. Lags where that is not
+// cheaper are recomputed directly. The difference function is invariant to
+// the per-window mean, so the raw samples can be used for the update terms.
+template <typename T>
+void slide_difference(const pt_dsp::KernelOps<T>& k, const float* window, const T* centered, int n, int hop,
+                      int min_lag, int max_lag, int lag_stride, T* diff) {
+    const float* old_window = window - hop;
+    for (int lag = min_lag; lag <= max_lag; lag += lag_stride) {
+        if (2 * hop >= n - lag) {
+            diff[lag] = k.sum_sq_diff(centered, centered + lag, n - lag);
+            continue;
+        }
+        const float* leaving = old_window;
+        const float* entering = old_window + n - lag;
+        const T removed = k.sum_sq_diff_f32(leaving, leaving + lag, hop);
+        const T added = k.sum_sq_diff_f32(entering, entering + lag, hop);
+        diff[lag] = std::max(T(0), diff[lag] - removed + added);
+    }
+}
+
+// Centres the window into scratch.centered and reports whether diff[] from
+// the previous hop can be advanced instead of recomputed. Returns false when
+// the window is below the energy floor.
+template <typename T>
+bool prepare_window(PT_DSP* dsp, AnalysisScratch<T>& scratch, const float* window, int n, bool* can_slide) {
+    *can_slide = dsp->diff_valid && n == dsp->frame_size && dsp->hops_since_refresh < kDiffRefreshHops &&
+                 !dsp->fft_diff;
+    dsp->diff_valid = false;
+
+    const pt_dsp::KernelOps<T>& k = dsp->kernels->ops<T>();
+    const T mean = k.sum(window, n) / static_cast<T>(n);
+    const T energy = k.center(window, n, mean, scratch.centered.data());
+    dsp->window_energy = static_cast<double>(energy);
+    return energy >= static_cast<T>(kUnvoicedEnergyFloor);
+}
+
+inline bool is_compact(const PT_DSP* dsp) {
+    return dsp->cfg.footprint == PT_DSP_FOOTPRINT_COMPACT;
+}
+
+// Records that diff[] now holds the difference function of an n-sample window.
+// A compact instance's diff[] belongs to its thread, so it never slides.
+void note_difference(PT_DSP* dsp, int n, bool slid) {
+    dsp->hops_since_refresh = slid ? dsp->hops_since_refresh + 1 : 0;
+    dsp->diff_valid = n == dsp->frame_size && !is_compact(dsp);
+}
+
+// First dip below threshold, harmonic check and parabolic refinement over a
+// complete CMNDF. Returns false when there is no usable dip.
+template <typename T>
+bool pick_period(const T* cmndf, int min_lag, int max_lag, double* refined_lag, double* best_cmndf_out) {
+    int best_lag = -1;
+    double best_cmndf = 1.0;
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        const double v = cmndf[lag];
+        if (v < kYinThreshold) {
+            best_lag = lag;
+            while (best_lag + 1 <= max_lag && cmndf[best_lag + 1] < cmndf[best_lag]) {
+                ++best_lag;
             }
-            prev_sign = sign;
+            best_cmndf = cmndf[best_lag];
+            break;
         }
-        if (!std::isfinite(oldest_t)) {
-            oldest_t = dsp->recent_time_ms[idx];
+        if (v < best_cmndf) {
+            best_cmndf = v;
+            best_lag = lag;
         }
     }
-    const int cycles = zero_crossings / 2;
-    if (cycles <= 0 || !std::isfinite(oldest_t)) {
-        return NAN;
+    if (best_lag <= 0) {
+        return false;
     }
-    const int newest_idx = wrap_history_index(dsp->history_head, dsp->history_count - 1, dsp->history_count);
-    const double duration_s = std::max(1e-6, (dsp->recent_time_ms[newest_idx] - oldest_t) / 1000.0);
-    return static_cast<double>(cycles) / duration_s;
+
+    for (int divisor = 2; divisor <= 4; ++divisor) {
+        const int harmonic_lag = best_lag / divisor;
+        if (harmonic_lag < min_lag || harmonic_lag > max_lag) {
+            continue;
+        }
+        if (cmndf[harmonic_lag] <= std::min(0.2, best_cmndf * 1.35)) {
+            best_lag = harmonic_lag;
+            best_cmndf = cmndf[harmonic_lag];
+        }
+    }
+
+    *refined_lag = parabolic_lag_refine(cmndf, best_lag, min_lag, max_lag);
+    *best_cmndf_out = best_cmndf;
+    return true;
 }
-}  // namespace
 
-PT_DSP* pt_dsp_create(DSPConfig cfg) {
-    PT_DSP* p = new (std::nothrow) PT_DSP();
-    if (!p) return nullptr;
-    p->cfg = cfg;
-    p->t_ms = 0.0;
-    return p;
+// Coarse-to-fine period search (PT_DSP_LAG_SEARCH_COARSE_TO_FINE). diff[]
+// holds the difference function at every lag_stride-th lag from min_lag; the
+// CMNDF running sum is integrated over that grid with the trapezoid rule and
+// kept in the cmndf buffer at the grid lags. Exact values at other lags are
+// computed on demand.
+template <typename T>
+class CoarseLagSearch {
+public:
+    CoarseLagSearch(const pt_dsp::KernelOps<T>& k, const T* centered, int n, int min_lag, int max_lag, int stride,
+                    T* diff, T* running_sum)
+        : k_(k), x_(centered), n_(n), min_lag_(min_lag), max_lag_(max_lag), stride_(stride), diff_(diff),
+          sum_(running_sum) {}
+
+    // Integrates the running sum over the grid. Returns the last grid lag.
+    int integrate() {
+        int g = min_lag_;
+        sum_[g] = T(0);
+        for (; g + stride_ <= max_lag_; g += stride_) {
+            sum_[g + stride_] = sum_[g] + static_cast<T>(0.5 * stride_) * (diff_[g] + diff_[g + stride_]);
+        }
+        return g;
+    }
+
+    // CMNDF at lag from its difference value, with the running sum
+    // interpolated from the grid lag at or below it.
+    double cmndf(int lag, double d) const {
+        if (lag <= min_lag_) {
+            return 1.0;
+        }
+        const int g = min_lag_ + (lag - min_lag_) / stride_ * stride_;
+        const double sum = static_cast<double>(sum_[g]) + 0.5 * (lag - g) * (static_cast<double>(diff_[g]) + d);
+        return sum <= 1e-12 ? 1.0 : d * static_cast<double>(lag) / sum;
+    }
+
+    double grid_cmndf(int g) const { return cmndf(g, static_cast<double>(diff_[g])); }
+
+    double exact_cmndf(int lag) const { return cmndf(lag, static_cast<double>(exact(lag))); }
+
+    // Full-resolution CMNDF over [lo, hi] into out[0 .. hi - lo].
+    void refine(int lo, int hi, double* out) {
+        k_.difference(x_, n_, lo, hi, diff_);
+        for (int lag = lo; lag <= hi; ++lag) {
+            out[lag - lo] = cmndf(lag, static_cast<double>(diff_[lag]));
+        }
+    }
+
+private:
+    T exact(int lag) const { return k_.sum_sq_diff(x_, x_ + lag, n_ - lag); }
+
+    const pt_dsp::KernelOps<T>& k_;
+    const T* x_;
+    int n_;
+    int min_lag_;
+    int max_lag_;
+    int stride_;
+    T* diff_;
+    T* sum_;
+};
+
+// pick_period() over a CoarseLagSearch whose grid values are in place. Each
+// grid local minimum (in lag order) stands for the dip between its grid
+// neighbours, which is refined at full resolution; the first refined lag
+// below kYinThreshold wins as in the full search. Minima whose grid CMNDF is
+// above kCoarseRefineGate are only refined, deepest first, when no dip passes.
+template <typename T>
+bool pick_period_coarse(CoarseLagSearch<T>& search, int min_lag, int max_lag, int stride, double* refined_lag,
+                        double* best_cmndf_out) {
+    const int last_grid = search.integrate();
+    double window[2 * kMaxLagStride];
+    int best_lag = -1;
+    double best_cmndf = 1.0;
+    bool passed = false;
+    int skipped_lag = -1;
+    double skipped_cmndf = 1.0;
+
+    // Refines the dip around grid lag g; true once a lag passes the threshold.
+    auto refine_dip = [&](int g) {
+        const int lo = std::max(min_lag + 1, g - stride + 1);
+        const int hi = std::min(max_lag, g + stride - 1);
+        search.refine(lo, hi, window);
+        for (int lag = lo; lag <= hi; ++lag) {
+            const double v = window[lag - lo];
+            if (v < kYinThreshold) {
+                best_lag = lag;
+                best_cmndf = v;
+                // Descend to the bottom of the dip, past the window if need be.
+                while (best_lag + 1 <= max_lag) {
+                    const double next =
+                        best_lag + 1 <= hi ? window[best_lag + 1 - lo] : search.exact_cmndf(best_lag + 1);
+                    if (next >= best_cmndf) {
+                        break;
+                    }
+                    ++best_lag;
+                    best_cmndf = next;
+                }
+                return true;
+            }
+            if (v < best_cmndf) {
+                best_cmndf = v;
+                best_lag = lag;
+            }
+        }
+        return false;
+    };
+
+    double prev = 1.0;
+    double cur = search.grid_cmndf(min_lag);
+    for (int g = min_lag; g <= last_grid && !passed; g += stride) {
+        const double next = g + stride <= last_grid ? search.grid_cmndf(g + stride) : 2.0;
+        if (g > min_lag && cur <= prev && cur < next) {
+            if (cur < kCoarseRefineGate) {
+                passed = refine_dip(g);
+            } else if (cur < skipped_cmndf) {
+                skipped_cmndf = cur;
+                skipped_lag = g;
+            }
+        }
+        prev = cur;
+        cur = next;
+    }
+    if (!passed && skipped_lag > 0 && skipped_cmndf < best_cmndf) {
+        refine_dip(skipped_lag);
+    }
+    if (best_lag <= 0) {
+        return false;
+    }
+
+    for (int divisor = 2; divisor <= 4; ++divisor) {
+        const int harmonic_lag = best_lag / divisor;
+        if (harmonic_lag < min_lag || harmonic_lag > max_lag) {
+            continue;
+        }
+        const double v = search.exact_cmndf(harmonic_lag);
+        if (v <= std::min(0.2, best_cmndf * 1.35)) {
+            best_lag = harmonic_lag;
+            best_cmndf = v;
+        }
+    }
+
+    if (best_lag <= min_lag || best_lag >= max_lag - 1) {
+        *refined_lag = static_cast<double>(best_lag);
+    } else {
+        *refined_lag = parabolic_vertex(best_lag, search.exact_cmndf(best_lag - 1), best_cmndf,
+                                        search.exact_cmndf(best_lag + 1));
+    }
+    *best_cmndf_out = best_cmndf;
+    return true;
 }
 
-void pt_dsp_destroy(PT_DSP* dsp) {
-    delete dsp;
+// The instance's shape-specialised difference if it was compiled for exactly
+// this window length and lag range, otherwise nullptr.
+const pt_dsp::ShapeKernels* shape_for(const PT_DSP* dsp, int n, int min_lag, int max_lag) {
+    const pt_dsp::ShapeKernels* shape = dsp->shape;
+    return shape != nullptr && shape->frame_size == n && shape->min_lag == min_lag && shape->max_lag == max_lag
+               ? shape
+               : nullptr;
 }
 
-DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_samples) {
-#ifndef NDEBUG
-    const auto process_start = std::chrono::steady_clock::now();
-#endif
-    DSPFrameOutput out{};
-    out.freq_hz = NAN;
-    out.midi_float = NAN;
-    out.nearest_midi = -1;
-    out.cents_error = NAN;
-    out.confidence = 0.0;
-    out.vibrato_detected = false;
-    out.vibrato_rate_hz = NAN;
-    out.vibrato_depth_cents = NAN;
+// YIN period search over a window already centred by prepare_window():
+// difference function, CMNDF and pick_period(). Everything up to the refined
+// lag runs in T; the result is widened to double for the pitch and history
+// maths.
+template <typename T>
+bool find_period(PT_DSP* dsp, AnalysisScratch<T>& scratch, const float* window, int n, int max_lag,
+                 bool can_slide, double* refined_lag, double* best_cmndf) {
+    const int min_lag = dsp->min_lag;
+    const pt_dsp::KernelOps<T>& k = dsp->kernels->ops<T>();
+    const T* centered = scratch.centered.data();
+    T* diff = scratch.diff.data();
+    // With nothing to slide next hop, a compact instance overwrites diff[]
+    // with its CMNDF and the window touches one buffer fewer.
+    T* cmndf = is_compact(dsp) && dsp->lag_stride == 1 ? diff : scratch.cmndf.data();
 
-    if (!dsp || !mono_samples || num_samples <= 0) {
-        out.timestamp_ms = 0.0;
-        sanitize_output(&out);
-        return out;
+    const int stride = dsp->lag_stride;
+    if (dsp->fft_diff) {
+        dsp->fft_diff->compute(centered, n, min_lag, max_lag, diff);
+    } else if (can_slide) {
+        slide_difference(k, window, centered, n, dsp->hop_size, min_lag, max_lag, stride, diff);
+    } else if (stride > 1) {
+        for (int lag = min_lag; lag <= max_lag; lag += stride) {
+            diff[lag] = k.sum_sq_diff(centered, centered + lag, n - lag);
+        }
+    } else if (const pt_dsp::ShapeKernels* shape = shape_for(dsp, n, min_lag, max_lag)) {
+        shape->difference(centered, diff);
+    } else {
+        k.difference(centered, n, min_lag, max_lag, diff);
     }
+    note_difference(dsp, n, can_slide);
 
-    out.timestamp_ms = dsp->t_ms;
-    const int sample_rate = std::max(1, dsp->cfg.sample_rate_hz);
-    const int n = std::min(num_samples, kMaxProcessSamples);
+    if (stride > 1) {
+        CoarseLagSearch<T> search(k, centered, n, min_lag, max_lag, stride, diff, cmndf);
+        return pick_period_coarse(search, min_lag, max_lag, stride, refined_lag, best_cmndf);
+    }
 
-    const int min_lag = std::max(1, sample_rate / kMaxFreqHz);
-    const int max_lag = std::min(n - 1, sample_rate / kMinFreqHz);
-    if (min_lag >= max_lag) {
-        dsp->t_ms += (1000.0 * num_samples) / static_cast<double>(sample_rate);
-        sanitize_output(&out);
-        return out;
+    k.cmndf(diff, min_lag, max_lag, cmndf);
+    return pick_period(cmndf, min_lag, max_lag, refined_lag, best_cmndf);
+}
+
+// sum of x[i] * prefix[min(i + lag + 1, n)] over the centred window x, that
+// is, x[i] times the sum of x[0 .. i + lag].
+template <typename T>
+double shifted_prefix_dot(const TrackedScratch& s, const T* x, int n, int lag) {
+    // Four partial sums keep the multiply-adds independent.
+    const double* p = s.prefix.data() + lag + 1;
+    const int head = std::max(0, n - lag - 1);
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    int i = 0;
+    for (; i + 4 <= head; i += 4) {
+        acc[0] += static_cast<double>(x[i]) * p[i];
+        acc[1] += static_cast<double>(x[i + 1]) * p[i + 1];
+        acc[2] += static_cast<double>(x[i + 2]) * p[i + 2];
+        acc[3] += static_cast<double>(x[i + 3]) * p[i + 3];
     }
+    for (; i < head; ++i) {
+        acc[0] += static_cast<double>(x[i]) * p[i];
+    }
+    // Past head every x[i] pairs with the whole window.
+    const double total = s.prefix[n];
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]) + total * (total - s.prefix[head]);
+}
 
-    double mean = 0.0;
+// Fills the prefix sums of the centred window x that cumulative_difference()
+// reads.
+template <typename T>
+void prepare_cumulative(const T* x, int n, int min_lag, TrackedScratch* s) {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    s->prefix[0] = 0.0;
+    s->prefix_sq[0] = 0.0;
     for (int i = 0; i < n; ++i) {
-        mean += mono_samples[i];
+        const double v = static_cast<double>(x[i]);
+        sum += v;
+        sum_sq += v * v;
+        s->prefix[i + 1] = sum;
+        s->prefix_sq[i + 1] = sum_sq;
     }
-    mean /= static_cast<double>(n);
+    s->base = shifted_prefix_dot(*s, x, n, min_lag);
+}
 
-    auto& centered = dsp->centered;
-    double energy = 0.0;
-    for (int i = 0; i < n; ++i) {
-        centered[i] = static_cast<double>(mono_samples[i]) - mean;
-        energy += centered[i] * centered[i];
+// sum(d(j)) for j in (min_lag, lag] over the centred window x, without
+// evaluating d at those lags. Each d(j) expands into the energies of
+// x[0 .. n - j) and x[j .. n), read from prefix_sq, less twice its cross
+// term; summed over j, x[i] pairs with x[i + min_lag + 1 .. i + lag], which
+// is a difference of two prefix sums, so one pass over the window remains.
+template <typename T>
+double cumulative_difference(const TrackedScratch& s, const T* x, int n, int min_lag, int lag) {
+    lag = std::min(lag, n - 1);
+    if (lag <= min_lag) {
+        return 0.0;
     }
-    if (energy < kUnvoicedEnergyFloor) {
-        dsp->t_ms += (1000.0 * num_samples) / static_cast<double>(sample_rate);
-        sanitize_output(&out);
-        return out;
+    const double* q = s.prefix_sq.data();
+    double energy = 0.0;
+    for (int j = min_lag + 1; j <= lag; ++j) {
+        energy += q[n - j] - q[j];
     }
+    energy += static_cast<double>(lag - min_lag) * q[n];
+    return energy - 2.0 * (shifted_prefix_dot(s, x, n, lag) - s.base);
+}
 
-    auto& diff = dsp->diff;
-    auto& cmndf = dsp->cmndf;
+// True when the tracked lag search may replace the full search for the window
+// just prepared, whose predecessor had energy previous_energy.
+bool tracked_search_due(const PT_DSP* dsp, double previous_energy) {
+    return dsp->cfg.lag_search == PT_DSP_LAG_SEARCH_TRACKED && dsp->locked_lag > 0.0 &&
+           (dsp->hops_since_full_search + 1) * dsp->hop_size <= dsp->sample_rate / kTrackedRescansPerSecond &&
+           dsp->window_energy <= previous_energy * kTrackedMaxEnergyRatio &&
+           dsp->window_energy * kTrackedMaxEnergyRatio >= previous_energy;
+}
 
-    for (int lag = min_lag; lag <= max_lag; ++lag) {
-        double d = 0.0;
-        for (int i = 0; i < n - lag; ++i) {
-            const double delta = centered[i] - centered[i + lag];
-            d += delta * delta;
-        }
-        diff[lag] = d;
-    }
+// Tracked lag search (PT_DSP_LAG_SEARCH_TRACKED) over a window centred by
+// prepare_window(). Lag windows around 1/4, 1/3, 1/2 and 1 times the locked
+// lag are visited in lag order with exact CMNDF values, and the first dip
+// under kYinThreshold is followed downhill as pick_period() would. Returns
+// false, leaving the full search to run, when no window holds the bottom of a
+// dip: nothing under the threshold, or a minimum on a window edge.
+// diff[] is left alone for that fallback to slide; the window differences go
+// through cmndf[], which becomes their CMNDF in place. The harmonic check and
+// the parabola reuse those values and compute any lag outside the windows on
+// its own.
+template <typename T>
+bool find_tracked_period(PT_DSP* dsp, AnalysisScratch<T>& scratch, TrackedScratch& tracked, int n, int max_lag,
+                         double* refined_lag, double* best_cmndf_out) {
+    const int min_lag = dsp->min_lag;
+    const pt_dsp::KernelOps<T>& k = dsp->kernels->ops<T>();
+    const T* x = scratch.centered.data();
+    T* cmndf = scratch.cmndf.data();
+    prepare_cumulative(x, n, min_lag, &tracked);
 
-    cmndf[min_lag] = 1.0;
-    double running_sum = 0.0;
-    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
-        running_sum += diff[lag];
-        if (running_sum <= 1e-12) {
-            cmndf[lag] = 1.0;
-            continue;
+    constexpr double kScales[] = {0.25, 1.0 / 3.0, 0.5, 1.0};
+    int window_lo[4] = {};
+    int window_hi[4] = {};
+    int windows = 0;
+    auto cmndf_at = [&](int lag) {
+        if (lag <= min_lag) {
+            return 1.0;
         }
-        cmndf[lag] = diff[lag] * static_cast<double>(lag) / running_sum;
-    }
+        for (int w = 0; w < windows; ++w) {
+            if (lag >= window_lo[w] && lag <= window_hi[w]) {
+                return static_cast<double>(cmndf[lag]);
+            }
+        }
+        const double d = static_cast<double>(k.sum_sq_diff(x, x + lag, n - lag));
+        const double sum = cumulative_difference(tracked, x, n, min_lag, lag);
+        return sum <= 1e-12 ? 1.0 : d * static_cast<double>(lag) / sum;
+    };
 
+    const double period = dsp->locked_lag;
     int best_lag = -1;
-    double best_cmndf = 1.0;
-    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
-        const double v = cmndf[lag];
-        if (v < kYinThreshold) {
+    for (double scale : kScales) {
+        // Windows at or below the previous one's top are skipped, so they
+        // never overlap.
+        const int floor_lag = windows > 0 ? window_hi[windows - 1] + 1 : min_lag + 1;
+        const int lo = std::max(floor_lag, static_cast<int>(std::floor(period * scale / kTrackedWindowRatio)));
+        const int hi = std::min(max_lag, static_cast<int>(std::ceil(period * scale * kTrackedWindowRatio)));
+        if (lo > hi) {
+            continue;
+        }
+        k.difference(x, n, lo, hi, cmndf);
+        window_lo[windows] = lo;
+        window_hi[windows] = hi;
+        ++windows;
+        double sum = cumulative_difference(tracked, x, n, min_lag, lo - 1);
+        for (int lag = lo; lag <= hi; ++lag) {
+            const double d = static_cast<double>(cmndf[lag]);
+            sum += d;
+            cmndf[lag] = static_cast<T>(sum <= 1e-12 ? 1.0 : d * lag / sum);
+        }
+        for (int lag = lo; lag <= hi; ++lag) {
+            if (cmndf[lag] >= kYinThreshold) {
+                continue;
+            }
             best_lag = lag;
-            while (best_lag + 1 <= max_lag && cmndf[best_lag + 1] < cmndf[best_lag]) {
+            while (best_lag + 1 <= hi && cmndf[best_lag + 1] < cmndf[best_lag]) {
                 ++best_lag;
             }
-            best_cmndf = cmndf[best_lag];
+            if ((best_lag == lo && lo > min_lag + 1) || (best_lag == hi && hi < max_lag)) {
+                return false;
+            }
             break;
         }
-        if (v < best_cmndf) {
-            best_cmndf = v;
-            best_lag = lag;
+        if (best_lag > 0) {
+            break;
         }
     }
     if (best_lag <= 0) {
-        dsp->t_ms += (1000.0 * num_samples) / static_cast<double>(sample_rate);
-        sanitize_output(&out);
-        return out;
+        return false;
     }
 
+    double best_cmndf = static_cast<double>(cmndf[best_lag]);
     for (int divisor = 2; divisor <= 4; ++divisor) {
         const int harmonic_lag = best_lag / divisor;
         if (harmonic_lag < min_lag || harmonic_lag > max_lag) {
             continue;
         }
-        if (cmndf[harmonic_lag] <= std::min(0.2, best_cmndf * 1.35)) {
+        const double v = cmndf_at(harmonic_lag);
+        if (v <= std::min(0.2, best_cmndf * 1.35)) {
             best_lag = harmonic_lag;
-            best_cmndf = cmndf[harmonic_lag];
+            best_cmndf = v;
+        }
+    }
+
+    if (best_lag <= min_lag || best_lag >= max_lag - 1) {
+        *refined_lag = static_cast<double>(best_lag);
+    } else {
+        *refined_lag = parabolic_vertex(best_lag, cmndf_at(best_lag - 1), best_cmndf, cmndf_at(best_lag + 1));
+    }
+    *best_cmndf_out = best_cmndf;
+    return true;
+}
+
+template <typename T>
+bool analyze_period(PT_DSP* dsp, AnalysisScratch<T>& scratch, const float* window, int n, int max_lag,
+                    double* refined_lag, double* best_cmndf) {
+    bool can_slide = false;
+    const double previous_energy = dsp->window_energy;
+    if (!prepare_window(dsp, scratch, window, n, &can_slide)) {
+        dsp->locked_lag = 0.0;
+        return false;
+    }
+    if (tracked_search_due(dsp, previous_energy) &&
+        find_tracked_period(dsp, scratch, *dsp->tracked, n, max_lag, refined_lag, best_cmndf)) {
+        ++dsp->hops_since_full_search;
+        dsp->locked_lag = *refined_lag;
+        return true;
+    }
+    const bool found = find_period(dsp, scratch, window, n, max_lag, can_slide, refined_lag, best_cmndf);
+    dsp->hops_since_full_search = 0;
+    dsp->locked_lag = found && *best_cmndf < kYinThreshold ? *refined_lag : 0.0;
+    return found;
+}
+
+// Full-rate lag of the period found at lag low_lag of the decimated window.
+// The difference function of the full-rate window in centered is evaluated
+// one decimation step either side of the scaled lag, following it downhill
+// if the minimum sits on an edge, and the minimum is refined by a parabola.
+// Over so few lags the CMNDF normaliser is all but constant, so the
+// difference function alone locates the dip.
+template <typename T>
+double refine_decimated_lag(const pt_dsp::KernelOps<T>& k, const T* centered, int n, int min_lag, int max_lag,
+                            int factor, double low_lag, T* diff) {
+    const int centre = std::clamp(static_cast<int>(std::lround(low_lag * factor)), min_lag, max_lag);
+    int lo = std::max(min_lag, centre - factor);
+    int hi = std::min(max_lag, centre + factor);
+    k.difference(centered, n, lo, hi, diff);
+    int best = lo;
+    for (int lag = lo + 1; lag <= hi; ++lag) {
+        if (diff[lag] < diff[best]) {
+            best = lag;
+        }
+    }
+    while (best == lo && lo > min_lag) {
+        --lo;
+        diff[lo] = k.sum_sq_diff(centered, centered + lo, n - lo);
+        if (diff[lo] < diff[best]) {
+            best = lo;
+        }
+    }
+    while (best == hi && hi < max_lag) {
+        ++hi;
+        diff[hi] = k.sum_sq_diff(centered, centered + hi, n - hi);
+        if (diff[hi] < diff[best]) {
+            best = hi;
         }
     }
+    if (best == lo || best == hi) {
+        return static_cast<double>(best);
+    }
+    return parabolic_vertex(best, static_cast<double>(diff[best - 1]), static_cast<double>(diff[best]),
+                            static_cast<double>(diff[best + 1]));
+}
+
+// Period search for PT_DSP_DECIMATION_AUTO: YIN over the newest decimated
+// window, then refine_decimated_lag() on the full-rate window of n samples.
+// Only called once the decimated window is complete.
+// The energy floor applies to the full-rate window, as without decimation.
+// Nothing slides between hops, so diff_valid stays false.
+template <typename T>
+bool analyze_decimated(PT_DSP* dsp, AnalysisScratch<T>& scratch, const float* window, int n, int max_lag,
+                       double* refined_lag, double* best_cmndf) {
+    const DecimatedInput& low = *dsp->decimated;
+    const int low_n = low.frame_size;
+    const int low_max_lag = std::min(low_n - 1, low.max_lag);
+    if (low.min_lag >= low_max_lag) {
+        return false;
+    }
+    const pt_dsp::KernelOps<T>& k = dsp->kernels->ops<T>();
+    const float* low_window = low.samples + low.len - low_n;
+    const T low_mean = k.sum(low_window, low_n) / static_cast<T>(low_n);
+    T* low_cmndf = is_compact(dsp) ? scratch.diff.data() : scratch.cmndf.data();
+    k.center(low_window, low_n, low_mean, scratch.centered.data());
+    k.difference(scratch.centered.data(), low_n, low.min_lag, low_max_lag, scratch.diff.data());
+    k.cmndf(scratch.diff.data(), low.min_lag, low_max_lag, low_cmndf);
+    double low_lag = 0.0;
+    if (!pick_period(low_cmndf, low.min_lag, low_max_lag, &low_lag, best_cmndf)) {
+        return false;
+    }
+
+    bool can_slide = false;
+    if (!prepare_window(dsp, scratch, window, n, &can_slide)) {
+        return false;
+    }
+    *refined_lag = refine_decimated_lag(k, scratch.centered.data(), n, dsp->min_lag, max_lag,
+                                        low.filter.factor(), low_lag, scratch.diff.data());
+    return true;
+}
 
-    const double refined_lag = parabolic_lag_refine(cmndf, best_lag, min_lag, max_lag);
+// Pitch, tracking, confidence, history and vibrato for a window whose period
+// has been found. out must already carry the window timestamp.
+void finish_analysis(PT_DSP* dsp, double refined_lag, double best_cmndf, DSPFrameOutput* out_frame) {
+    DSPFrameOutput& out = *out_frame;
+    const int sample_rate = dsp->sample_rate;
     const double raw_freq = static_cast<double>(sample_rate) / refined_lag;
     const double freq = choose_tracked_frequency(dsp, raw_freq);
     if (!is_finite_positive(freq)) {
-        dsp->t_ms += (1000.0 * num_samples) / static_cast<double>(sample_rate);
-        sanitize_output(&out);
-        return out;
+        return;
     }
 
     const double midi_float = hz_to_midi(freq, dsp->cfg.a4_hz > 0 ? dsp->cfg.a4_hz : 440.0);
@@ -320,29 +821,9 @@ DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_sa
     const double periodicity_confidence = std::clamp(1.0 - best_cmndf, 0.0, 1.0);
 
     double stability_confidence = 1.0;
-    if (dsp->history_count >= 4) {
-        double sum = 0.0;
-        int samples = 0;
-        for (int i = 0; i < dsp->history_count; ++i) {
-            const int idx = wrap_history_index(dsp->history_head, i, dsp->history_count);
-            if (dsp->recent_freq_hz[idx] > 0.0) {
-                sum += dsp->recent_freq_hz[idx];
-                ++samples;
-            }
-        }
-        if (samples > 0) {
-            const double mean_freq = sum / static_cast<double>(samples);
-            double squared_sum_cents = 0.0;
-            for (int i = 0; i < dsp->history_count; ++i) {
-                const int idx = wrap_history_index(dsp->history_head, i, dsp->history_count);
-                const double f = dsp->recent_freq_hz[idx];
-                if (f <= 0.0) continue;
-                const double cents_delta = 1200.0 * std::log2(f / mean_freq);
-                squared_sum_cents += cents_delta * cents_delta;
-            }
-            const double rms_cents = std::sqrt(squared_sum_cents / static_cast<double>(samples));
-            stability_confidence = std::clamp(1.0 - (rms_cents / 45.0), 0.0, 1.0);
-        }
+    if (dsp->history.size() >= 4) {
+        const double rms_cents = dsp->history.frequency_rms_cents();
+        stability_confidence = std::clamp(1.0 - (rms_cents / 45.0), 0.0, 1.0);
     }
     const double confidence = sanitize_confidence(periodicity_confidence * 0.7 + stability_confidence * 0.3);
 
@@ -353,27 +834,16 @@ DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_sa
     out.confidence = confidence;
 
     if (std::isfinite(cents_error)) {
-        dsp->recent_cents[dsp->history_head] = cents_error;
-        dsp->recent_time_ms[dsp->history_head] = out.timestamp_ms;
-        dsp->recent_freq_hz[dsp->history_head] = freq;
-        dsp->history_head = (dsp->history_head + 1) % kHistorySize;
-        dsp->history_count = std::min(kHistorySize, dsp->history_count + 1);
+        dsp->history.push(cents_error, freq, out.timestamp_ms);
         dsp->last_tracked_freq_hz = freq;
     }
 
-    if (dsp->history_count >= 8) {
-        double min_c = 1e9;
-        double max_c = -1e9;
-        double oldest_t = out.timestamp_ms;
-        for (int i = 0; i < dsp->history_count; ++i) {
-            const int idx = wrap_history_index(dsp->history_head, i, dsp->history_count);
-            min_c = std::min(min_c, dsp->recent_cents[idx]);
-            max_c = std::max(max_c, dsp->recent_cents[idx]);
-            oldest_t = std::min(oldest_t, dsp->recent_time_ms[idx]);
-        }
+    if (dsp->history.size() >= 8) {
+        const pt_dsp::PitchHistory& history = dsp->history;
+        const double oldest_t = std::min(out.timestamp_ms, history.oldest_time_ms());
         const double duration_s = std::max(1e-6, (out.timestamp_ms - oldest_t) / 1000.0);
-        const double depth = (max_c - min_c) * 0.5;
-        const double rate_hz = estimate_vibrato_rate_hz(dsp);
+        const double depth = (history.max_cents() - history.min_cents()) * 0.5;
+        const double rate_hz = estimate_vibrato_rate_hz(history);
 
         if (depth > 2.0 && std::isfinite(rate_hz) && rate_hz >= 3.0 && rate_hz <= 9.0 && duration_s >= 0.2) {
             out.vibrato_detected = true;
@@ -381,18 +851,689 @@ DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_sa
             out.vibrato_rate_hz = rate_hz;
         }
     }
+}
+
+// Analysis scratch shared by the compact instances analysed on one thread.
+// Each part is allocated at full size the first time an instance needs it;
+// a window only touches the leading frame_size or max_lag + 1 entries, so the
+// cache footprint follows the configurations in use, not the allocation.
+struct ThreadScratch {
+    std::unique_ptr<AnalysisScratch<double>> f64;
+    std::unique_ptr<AnalysisScratch<float>> f32;
+    std::unique_ptr<TrackedScratch> tracked;
+
+    bool reserve(const DSPConfig& cfg) {
+        return (cfg.precision == PT_DSP_PRECISION_FLOAT ? ensure(f32) : ensure(f64)) &&
+               (cfg.lag_search != PT_DSP_LAG_SEARCH_TRACKED || ensure(tracked));
+    }
+
+private:
+    template <typename Part>
+    static bool ensure(std::unique_ptr<Part>& part) {
+        if (!part) {
+            part.reset(new (std::nothrow) Part());
+        }
+        return part != nullptr;
+    }
+};
+
+ThreadScratch& thread_scratch() {
+    static thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+// Points a compact instance at the calling thread's scratch. Returns false
+// when that could not be allocated.
+bool bind_thread_scratch(PT_DSP* dsp) {
+    if (!is_compact(dsp)) {
+        return true;
+    }
+    ThreadScratch& shared = thread_scratch();
+    if (!shared.reserve(dsp->cfg)) {
+        return false;
+    }
+    if (dsp->cfg.precision == PT_DSP_PRECISION_FLOAT) {
+        dsp->scratch_f32 = shared.f32.get();
+    } else {
+        dsp->scratch_f64 = shared.f64.get();
+    }
+    dsp->tracked = shared.tracked.get();
+    return true;
+}
+
+// Period search over the n samples ending at the newest input sample, in the
+// instance's precision. Does not touch tracking or history.
+bool estimate_period(PT_DSP* dsp, const float* window, int n, double* refined_lag, double* best_cmndf) {
+    const int max_lag = std::min(n - 1, dsp->max_lag);
+    if (dsp->min_lag >= max_lag || !bind_thread_scratch(dsp)) {
+        dsp->diff_valid = false;
+        return false;
+    }
+    // Until the filter has settled over a whole decimated window, the start
+    // of a stream is analysed at the full rate.
+    if (dsp->decimated && dsp->decimated->fed >= pt_dsp::warmup_samples(dsp)) {
+        return dsp->scratch_f32
+                   ? analyze_decimated(dsp, *dsp->scratch_f32, window, n, max_lag, refined_lag, best_cmndf)
+                   : analyze_decimated(dsp, *dsp->scratch_f64, window, n, max_lag, refined_lag, best_cmndf);
+    }
+    return dsp->scratch_f32 ? analyze_period(dsp, *dsp->scratch_f32, window, n, max_lag, refined_lag, best_cmndf)
+                            : analyze_period(dsp, *dsp->scratch_f64, window, n, max_lag, refined_lag, best_cmndf);
+}
+
+// Runs YIN over the n samples ending at the newest input sample.
+DSPFrameOutput analyze_window(PT_DSP* dsp, const float* window, int n, double timestamp_ms) {
+    DSPFrameOutput out{};
+    reset_output(&out, timestamp_ms);
+    double refined_lag = 0.0;
+    double best_cmndf = 1.0;
+    if (estimate_period(dsp, window, n, &refined_lag, &best_cmndf)) {
+        finish_analysis(dsp, refined_lag, best_cmndf, &out);
+    }
+    sanitize_output(&out);
+    return out;
+}
+}  // namespace
+
+namespace {
+constexpr size_t kInstanceAlignment = PT_DSP_INSTANCE_ALIGNMENT;
+
+// Only the FftDifference owns anything; the other parts are dropped with
+// their block.
+static_assert(std::is_trivially_destructible<AnalysisScratch<double>>::value &&
+                  std::is_trivially_destructible<AnalysisScratch<float>>::value &&
+                  std::is_trivially_destructible<DecimatedInput>::value &&
+                  std::is_trivially_destructible<TrackedScratch>::value,
+              "pt_dsp_destroy does not run these destructors");
+static_assert(alignof(PT_DSP) <= kInstanceAlignment && alignof(AnalysisScratch<double>) <= kInstanceAlignment,
+              "PT_DSP_INSTANCE_ALIGNMENT too small");
+
+inline int resolved_frame_size(const DSPConfig& cfg) {
+    return cfg.frame_size > 0 ? std::min(cfg.frame_size, kMaxProcessSamples) : kDefaultFrameSize;
+}
+
+inline int resolved_hop_size(const DSPConfig& cfg, int frame_size) {
+    return cfg.hop_size > 0 ? std::min(cfg.hop_size, frame_size) : frame_size;
+}
+
+inline int decimation_factor(int sample_rate) {
+    return std::min(pt_dsp::kMaxDecimation, sample_rate / kDecimatedMinRateHz);
+}
+
+// Byte offsets of the parts an instance needs for cfg inside one block
+// aligned to kInstanceAlignment, with the PT_DSP itself at 0. Parts the
+// config does not use have offset 0. This is where the config's optional
+// engines are resolved: pt_dsp_init_in_place builds whatever is laid out.
+struct InstanceLayout {
+    size_t input = 0;
+    int input_capacity = 0;  // floats
+    size_t scratch = 0;      // 0 for compact instances, which share their thread's
+    size_t decimated = 0;
+    size_t decimated_samples = 0;
+    int decimated_capacity = 0;  // floats
+    size_t fft = 0;
+    size_t fft_storage = 0;  // FftDifference::storage_size() doubles
+    size_t tracked = 0;
+    size_t size = 0;  // a multiple of kInstanceAlignment
+};
+
+InstanceLayout layout_instance(const DSPConfig& cfg) {
+    InstanceLayout layout;
+    size_t end = sizeof(PT_DSP);
+    // Every part starts on its own cache line.
+    auto place = [&end](size_t bytes) {
+        const size_t at = (end + kInstanceAlignment - 1) / kInstanceAlignment * kInstanceAlignment;
+        end = at + bytes;
+        return at;
+    };
+    const bool compact = cfg.footprint == PT_DSP_FOOTPRINT_COMPACT;
+    const int frame = resolved_frame_size(cfg);
+    const int hop = resolved_hop_size(cfg, frame);
+    const int factor = decimation_factor(std::max(1, cfg.sample_rate_hz));
+    const bool decimated = cfg.decimation == PT_DSP_DECIMATION_AUTO && factor >= 2;
+    const bool fft = !decimated && !compact && cfg.diff_engine == PT_DSP_DIFF_FFT;
+    layout.input_capacity = compact ? frame + hop : kInputCapacity;
+    layout.input = place(sizeof(float) * static_cast<size_t>(layout.input_capacity));
+    if (!compact) {
+        layout.scratch = place(cfg.precision == PT_DSP_PRECISION_FLOAT ? sizeof(AnalysisScratch<float>)
+                                                                       : sizeof(AnalysisScratch<double>));
+    }
+    if (decimated) {
+        layout.decimated_capacity = compact ? frame / factor + hop / factor + 1 : kDecimatedCapacity;
+        layout.decimated = place(sizeof(DecimatedInput));
+        layout.decimated_samples = place(sizeof(float) * static_cast<size_t>(layout.decimated_capacity));
+    }
+    if (fft) {
+        layout.fft = place(sizeof(pt_dsp::FftDifference));
+        layout.fft_storage = place(sizeof(double) * pt_dsp::FftDifference::storage_size(frame));
+    }
+    if (!decimated && !fft && !compact && cfg.lag_search == PT_DSP_LAG_SEARCH_TRACKED) {
+        layout.tracked = place(sizeof(TrackedScratch));
+    }
+    layout.size = place(0);
+    return layout;
+}
+}  // namespace
+
+size_t pt_dsp_required_size(DSPConfig cfg) {
+    return layout_instance(cfg).size;
+}
 
-    dsp->t_ms += (1000.0 * num_samples) / static_cast<double>(sample_rate);
+PT_DSP* pt_dsp_init_in_place(DSPConfig cfg, void* memory, size_t size) {
+    const InstanceLayout layout = layout_instance(cfg);
+    if (memory == nullptr || reinterpret_cast<uintptr_t>(memory) % kInstanceAlignment != 0 || size < layout.size) {
+        return nullptr;
+    }
+    char* base = static_cast<char*>(memory);
+    PT_DSP* p = new (base) PT_DSP();
+    p->cfg = cfg;
+    p->sample_rate = std::max(1, cfg.sample_rate_hz);
+    p->frame_size = resolved_frame_size(cfg);
+    p->hop_size = resolved_hop_size(cfg, p->frame_size);
+    p->min_lag = pt_dsp::min_lag_for(p->sample_rate);
+    p->max_lag = p->sample_rate / pt_dsp::kMinFreqHz;
+    p->kernels = &pt_dsp::best_kernels();
+    p->shape = pt_dsp::shape_kernels_for(*p->kernels, p->sample_rate, p->frame_size);
+    p->input = reinterpret_cast<float*>(base + layout.input);
+    p->input_capacity = layout.input_capacity;
+    if (cfg.precision != PT_DSP_PRECISION_FLOAT) {
+        p->cfg.precision = PT_DSP_PRECISION_DOUBLE;
+    }
+    if (cfg.footprint != PT_DSP_FOOTPRINT_COMPACT) {
+        p->cfg.footprint = PT_DSP_FOOTPRINT_STANDARD;
+        if (p->cfg.precision == PT_DSP_PRECISION_FLOAT) {
+            p->scratch_f32 = new (base + layout.scratch) AnalysisScratch<float>();
+        } else {
+            p->scratch_f64 = new (base + layout.scratch) AnalysisScratch<double>();
+        }
+    }
+    if (layout.decimated != 0) {
+        const int factor = decimation_factor(p->sample_rate);
+        p->decimated = new (base + layout.decimated) DecimatedInput();
+        DecimatedInput& low = *p->decimated;
+        low.samples = reinterpret_cast<float*>(base + layout.decimated_samples);
+        low.capacity = layout.decimated_capacity;
+        low.filter.configure(factor);
+        low.frame_size = p->frame_size / factor;
+        low.min_lag = pt_dsp::min_lag_for(p->sample_rate / factor);
+        low.max_lag = p->sample_rate / factor / pt_dsp::kMinFreqHz;
+        cfg.diff_engine = PT_DSP_DIFF_DIRECT;
+        cfg.lag_search = PT_DSP_LAG_SEARCH_FULL;
+    } else {
+        p->cfg.decimation = PT_DSP_DECIMATION_OFF;
+    }
+    if (layout.fft != 0) {
+        p->fft_diff = new (base + layout.fft)
+            pt_dsp::FftDifference(p->frame_size, reinterpret_cast<double*>(base + layout.fft_storage));
+        if (!p->fft_diff->valid()) {
+            pt_dsp_destroy(p);
+            return nullptr;
+        }
+    } else {
+        p->cfg.diff_engine = PT_DSP_DIFF_DIRECT;
+    }
+    // A compact instance keeps the tracked search without a TrackedScratch of
+    // its own; bind_thread_scratch() lends it the thread's.
+    if (cfg.lag_search == PT_DSP_LAG_SEARCH_COARSE_TO_FINE && !p->fft_diff) {
+        p->lag_stride = std::clamp(p->min_lag / kCoarsePointsPerMinPeriod, 2, kMaxLagStride);
+    } else if (layout.tracked != 0) {
+        p->tracked = new (base + layout.tracked) TrackedScratch();
+    } else if (cfg.lag_search != PT_DSP_LAG_SEARCH_TRACKED || !is_compact(p)) {
+        p->cfg.lag_search = PT_DSP_LAG_SEARCH_FULL;
+    }
+    reset_output(&p->last_output, 0.0);
+    sanitize_output(&p->last_output);
+    return p;
+}
+
+PT_DSP* pt_dsp_create(DSPConfig cfg) {
+    const size_t size = pt_dsp_required_size(cfg);
+    void* memory = ::operator new(size, std::align_val_t(kInstanceAlignment), std::nothrow);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    PT_DSP* p = pt_dsp_init_in_place(cfg, memory, size);
+    if (p == nullptr) {
+        ::operator delete(memory, std::align_val_t(kInstanceAlignment));
+        return nullptr;
+    }
+    p->owns_memory = true;
+    if (!pt_dsp_reserve_thread_scratch(p->cfg)) {
+        pt_dsp_destroy(p);
+        return nullptr;
+    }
+    return p;
+}
+
+bool pt_dsp_reserve_thread_scratch(DSPConfig cfg) {
+    return cfg.footprint != PT_DSP_FOOTPRINT_COMPACT || thread_scratch().reserve(cfg);
+}
+
+void pt_dsp_destroy(PT_DSP* dsp) {
+    if (dsp == nullptr) {
+        return;
+    }
+    const bool owns_memory = dsp->owns_memory;
+    if (dsp->fft_diff) {
+        dsp->fft_diff->~FftDifference();
+    }
+    dsp->~PT_DSP();
+    if (owns_memory) {
+        ::operator delete(static_cast<void*>(dsp), std::align_val_t(kInstanceAlignment));
+    }
+}
+
+DSPConfig pt_dsp::resolved_config(const PT_DSP* dsp) {
+    DSPConfig cfg = dsp->cfg;
+    cfg.sample_rate_hz = dsp->sample_rate;
+    cfg.frame_size = dsp->frame_size;
+    cfg.hop_size = dsp->hop_size;
+    return cfg;
+}
+
+
+namespace {
+// Appends input up to the end of the current hop, advancing *samples and
+// *num_samples. Returns true when the hop is complete and an analysis is due.
+bool feed_hop(PT_DSP* dsp, const float** samples, int* num_samples) {
+    const int hop = dsp->hop_size;
+    const int take = std::min(*num_samples, hop - dsp->hop_fill);
+    if (dsp->input_len + take > dsp->input_capacity) {
+        // Keep everything from the start of the last analysed window: the
+        // next window and the sliding difference update both read from it.
+        const int retained = std::min(dsp->input_len, dsp->frame_size + dsp->hop_fill);
+        std::memmove(dsp->input, dsp->input + dsp->input_len - retained, sizeof(float) * static_cast<size_t>(retained));
+        dsp->input_len = retained;
+    }
+    std::memcpy(dsp->input + dsp->input_len, *samples, sizeof(float) * static_cast<size_t>(take));
+    dsp->input_len += take;
+    if (dsp->decimated) {
+        DecimatedInput& low = *dsp->decimated;
+        if (low.len + take / low.filter.factor() + 1 > low.capacity) {
+            const int retained = std::min(low.len, low.frame_size);
+            std::memmove(low.samples, low.samples + low.len - retained, sizeof(float) * static_cast<size_t>(retained));
+            low.len = retained;
+        }
+        low.len += low.filter.process(*samples, take, dsp->samples_consumed, low.samples + low.len);
+        low.fed += take;
+    }
+    dsp->hop_fill += take;
+    dsp->samples_consumed += take;
+    *samples += take;
+    *num_samples -= take;
+
+    if (dsp->hop_fill < hop) {
+        return false;
+    }
+    dsp->hop_fill = 0;
+    return true;
+}
+
+// Window of the analysis due after feed_hop() returned true.
+inline int due_window_size(const PT_DSP* dsp) {
+    return std::min(dsp->input_len, dsp->frame_size);
+}
+
+inline const float* due_window(const PT_DSP* dsp) {
+    return dsp->input + dsp->input_len - due_window_size(dsp);
+}
+
+inline double due_timestamp_ms(const PT_DSP* dsp) {
+    return (1000.0 * static_cast<double>(dsp->samples_consumed - dsp->hop_size)) /
+           static_cast<double>(dsp->sample_rate);
+}
+
+void run_due_analysis(PT_DSP* dsp) {
+    dsp->last_output = analyze_window(dsp, due_window(dsp), due_window_size(dsp), due_timestamp_ms(dsp));
+}
+
+// Structure-of-arrays buffers for one batch of streams: element i of stream s
+// lives at [i * kBatchLanes + s]. One workspace per thread, grown on demand.
+struct BatchWorkspace {
+    std::unique_ptr<double[]> raw;  // previous hop followed by the window
+    std::unique_ptr<double[]> centered;
+    std::unique_ptr<double[]> diff;
+    std::unique_ptr<double[]> cmndf;
+    int sample_capacity = 0;
+    int lag_capacity = 0;
+
+    bool reserve(int samples, int lags) {
+        if (samples > sample_capacity) {
+            const size_t size = static_cast<size_t>(samples) * pt_dsp::kBatchLanes;
+            raw.reset(new (std::nothrow) double[size]);
+            centered.reset(new (std::nothrow) double[size]);
+            sample_capacity = raw && centered ? samples : 0;
+        }
+        if (lags > lag_capacity) {
+            const size_t size = static_cast<size_t>(lags) * pt_dsp::kBatchLanes;
+            diff.reset(new (std::nothrow) double[size]);
+            cmndf.reset(new (std::nothrow) double[size]);
+            lag_capacity = diff && cmndf ? lags : 0;
+        }
+        return sample_capacity >= samples && lag_capacity >= lags;
+    }
+};
+
+BatchWorkspace& batch_workspace() {
+    static thread_local BatchWorkspace workspace;
+    return workspace;
+}
+
+// True when the due analysis of dsp can share structure-of-arrays stages.
+bool batchable(const PT_DSP* dsp) {
+    return dsp->scratch_f64 && !is_compact(dsp) && !dsp->fft_diff && !dsp->decimated &&
+           dsp->cfg.lag_search == PT_DSP_LAG_SEARCH_FULL &&
+           due_window_size(dsp) == dsp->frame_size &&
+           dsp->min_lag < std::min(dsp->frame_size - 1, dsp->max_lag);
+}
+
+bool same_geometry(const PT_DSP* a, const PT_DSP* b) {
+    return a->sample_rate == b->sample_rate && a->frame_size == b->frame_size && a->hop_size == b->hop_size &&
+           a->kernels == b->kernels;
+}
+
+// Direct difference sums for lags [lag_begin, lag_end] over interleaved
+// streams. The interleaved window is kBatchLanes times larger than a single
+// stream's, so the sums are tiled: a block of lags walks one block of samples
+// and its lagged partners while both are still in L1.
+void batch_direct_sums(const pt_dsp::Kernels& k, const double* x, int n, int lag_begin, int lag_end, double* diff) {
+    constexpr int L = pt_dsp::kBatchLanes;
+    if (lag_begin > lag_end) {
+        return;
+    }
+    std::fill(diff + lag_begin * L, diff + (lag_end + 1) * L, 0.0);
+    for (int l0 = lag_begin; l0 <= lag_end; l0 += kBatchLagBlock) {
+        const int l1 = std::min(lag_end, l0 + kBatchLagBlock - 1);
+        for (int i0 = 0; i0 < n - l0; i0 += kBatchSampleBlock) {
+            for (int lag = l0; lag <= l1; ++lag) {
+                const int i1 = std::min(i0 + kBatchSampleBlock, n - lag);
+                if (i1 > i0) {
+                    k.sum_sq_diff_x8(x + i0 * L, x + (i0 + lag) * L, i1 - i0, diff + lag * L);
+                }
+            }
+        }
+    }
+}
+
+// Sliding difference update and CMNDF for 2..kBatchLanes prepared streams of
+// one geometry, evaluated lane-parallel. The per-lag update sums are only hop
+// samples long, so interleaving streams removes their horizontal reductions
+// and call overhead. Results are scattered back into each stream's scratch,
+// so later hops can continue through the single-stream path.
+void batch_slide_difference(PT_DSP* const* lanes, int count, BatchWorkspace& ws) {
+    constexpr int L = pt_dsp::kBatchLanes;
+    const PT_DSP* first = lanes[0];
+    const pt_dsp::Kernels& k = *first->kernels;
+    const int n = first->frame_size;
+    const int hop = first->hop_size;
+    const int min_lag = first->min_lag;
+    const int max_lag = std::min(n - 1, first->max_lag);
+    // Same per-lag choice as slide_difference(): the direct lags form the top of the range.
+    const int direct_from = std::min(max_lag + 1, std::max(min_lag, n - 2 * hop));
+    double* raw = ws.raw.get();
+    double* centered = ws.centered.get();
+    double* diff = ws.diff.get();
+    double* cmndf = ws.cmndf.get();
+
+    // Unused lanes are zero-filled so they stay finite; their results are dropped.
+    const double* centered_in[L] = {};
+    const float* raw_in[L] = {};
+    const double* diff_in[L] = {};
+    for (int s = 0; s < count; ++s) {
+        centered_in[s] = lanes[s]->scratch_f64->centered.data();
+        raw_in[s] = due_window(lanes[s]) - hop;
+        diff_in[s] = lanes[s]->scratch_f64->diff.data();
+    }
+    for (int i = 0; i < n + hop; ++i) {
+        for (int s = 0; s < L; ++s) {
+            raw[i * L + s] = s < count ? static_cast<double>(raw_in[s][i]) : 0.0;
+        }
+    }
+    for (int lag = min_lag; lag < direct_from; ++lag) {
+        for (int s = 0; s < L; ++s) {
+            diff[lag * L + s] = s < count ? diff_in[s][lag] : 0.0;
+        }
+    }
+    if (direct_from <= max_lag) {
+        for (int i = 0; i < n; ++i) {
+            for (int s = 0; s < L; ++s) {
+                centered[i * L + s] = s < count ? centered_in[s][i] : 0.0;
+            }
+        }
+    }
+
+    double removed[L];
+    double added[L];
+    for (int lag = min_lag; lag < direct_from; ++lag) {
+        const double* entering = raw + (n - lag) * L;
+        std::fill(removed, removed + L, 0.0);
+        std::fill(added, added + L, 0.0);
+        k.sum_sq_diff_x8(raw, raw + lag * L, hop, removed);
+        k.sum_sq_diff_x8(entering, entering + lag * L, hop, added);
+        double* d = diff + lag * L;
+        for (int s = 0; s < L; ++s) {
+            d[s] = std::max(0.0, d[s] - removed[s] + added[s]);
+        }
+    }
+    batch_direct_sums(k, centered, n, direct_from, max_lag, diff);
+    k.cmndf_x8(diff, min_lag, max_lag, cmndf);
+
+    for (int s = 0; s < count; ++s) {
+        AnalysisScratch<double>& scratch = *lanes[s]->scratch_f64;
+        for (int lag = min_lag; lag <= max_lag; ++lag) {
+            scratch.diff[lag] = diff[lag * L + s];
+            scratch.cmndf[lag] = cmndf[lag * L + s];
+        }
+    }
+}
+
+// Runs the due analyses of streams that satisfy batchable() and share one
+// geometry. Streams whose difference function slides from the previous hop
+// are updated together; full recomputes stay on the single-stream kernels,
+// which keep one window in L1 and already vectorise well along the window.
+void run_batch(PT_DSP* const* group, int count, BatchWorkspace& ws) {
+    constexpr int L = pt_dsp::kBatchLanes;
+    const int n = group[0]->frame_size;
+    const int max_lag = std::min(n - 1, group[0]->max_lag);
+    // With hop >= (n - min_lag) / 2 every lag is summed directly, which gains
+    // nothing from interleaving.
+    const bool batch_slides = n - 2 * group[0]->hop_size > group[0]->min_lag;
+    if (count < 2 || !batch_slides || !ws.reserve(n + group[0]->hop_size, max_lag + 1)) {
+        for (int i = 0; i < count; ++i) {
+            run_due_analysis(group[i]);
+        }
+        return;
+    }
+
+    PT_DSP* sliding[L];
+    int sliding_count = 0;
+    for (int i = 0; i < count; ++i) {
+        PT_DSP* dsp = group[i];
+        reset_output(&dsp->last_output, due_timestamp_ms(dsp));
+        bool can_slide = false;
+        double refined_lag = 0.0;
+        double best_cmndf = 1.0;
+        if (!prepare_window(dsp, *dsp->scratch_f64, due_window(dsp), n, &can_slide)) {
+            sanitize_output(&dsp->last_output);
+        } else if (can_slide) {
+            sliding[sliding_count++] = dsp;
+        } else {
+            if (find_period(dsp, *dsp->scratch_f64, due_window(dsp), n, max_lag, can_slide, &refined_lag,
+                            &best_cmndf)) {
+                finish_analysis(dsp, refined_lag, best_cmndf, &dsp->last_output);
+            }
+            sanitize_output(&dsp->last_output);
+        }
+    }
+
+    if (sliding_count >= 2) {
+        batch_slide_difference(sliding, sliding_count, ws);
+    }
+    for (int s = 0; s < sliding_count; ++s) {
+        PT_DSP* dsp = sliding[s];
+        AnalysisScratch<double>& scratch = *dsp->scratch_f64;
+        double refined_lag = 0.0;
+        double best_cmndf = 1.0;
+        bool found = false;
+        if (sliding_count >= 2) {
+            note_difference(dsp, n, true);
+            found = pick_period(scratch.cmndf.data(), dsp->min_lag, max_lag, &refined_lag, &best_cmndf);
+        } else {
+            found = find_period(dsp, scratch, due_window(dsp), n, max_lag, true, &refined_lag, &best_cmndf);
+        }
+        if (found) {
+            finish_analysis(dsp, refined_lag, best_cmndf, &dsp->last_output);
+        }
+        sanitize_output(&dsp->last_output);
+    }
+}
+
+// Runs the analyses due on up to kBatchLanes distinct streams, batching those
+// that share a geometry.
+void run_due_analyses(PT_DSP* const* due, int count, BatchWorkspace& ws) {
+    constexpr int L = pt_dsp::kBatchLanes;
+    bool done[L] = {};
+    for (int i = 0; i < count; ++i) {
+        if (done[i]) {
+            continue;
+        }
+        if (!batchable(due[i])) {
+            run_due_analysis(due[i]);
+            done[i] = true;
+            continue;
+        }
+        PT_DSP* group[L];
+        int group_count = 0;
+        for (int j = i; j < count; ++j) {
+            if (!done[j] && batchable(due[j]) && same_geometry(due[i], due[j])) {
+                group[group_count++] = due[j];
+                done[j] = true;
+            }
+        }
+        run_batch(group, group_count, ws);
+    }
+}
+}  // namespace
+
+int pt_dsp_push(PT_DSP* dsp, const float* mono_samples, int num_samples, DSPFrameOutput* out_frames, int max_frames) {
+    if (!dsp || !mono_samples || num_samples <= 0) {
+        return 0;
+    }
+    const auto process_start = std::chrono::steady_clock::now();
+    int produced = 0;
+    while (num_samples > 0) {
+        if (!feed_hop(dsp, &mono_samples, &num_samples)) {
+            break;
+        }
+        run_due_analysis(dsp);
+        if (produced < max_frames && out_frames) {
+            out_frames[produced] = dsp->last_output;
+        }
+        ++produced;
+    }
+    // Read through pt_dsp_query_timing(). Avoid fprintf here: this function
+    // runs on the realtime audio thread, and blocking I/O can cause audible
+    // glitches or trigger watchdog timeouts.
+    dsp->timing.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - process_start).count()));
+    return produced;
+}
+
+DSPFrameOutput pt_dsp_process(PT_DSP* dsp, const float* mono_samples, int num_samples) {
+    if (!dsp || !mono_samples || num_samples <= 0) {
+        DSPFrameOutput out{};
+        reset_output(&out, 0.0);
+        sanitize_output(&out);
+        return out;
+    }
+    pt_dsp_push(dsp, mono_samples, num_samples, nullptr, 0);
+    return dsp->last_output;
+}
+
+bool pt_dsp_query_timing(PT_DSP* dsp, DSPTimingStats* out, bool reset) {
+    if (!dsp || !out) {
+        return false;
+    }
+    dsp->timing.snapshot(out, reset);
+    return true;
+}
+
+int pt_dsp_process_batch(PT_DSP* const* dsps, const float* const* blocks, const int* num_samples, int count,
+                         DSPFrameOutput* out_frames) {
+    if (!dsps || !blocks || !num_samples || !out_frames || count <= 0) {
+        return 0;
+    }
+    constexpr int L = pt_dsp::kBatchLanes;
+    BatchWorkspace& ws = batch_workspace();
+    int produced = 0;
+    for (int base = 0; base < count; base += L) {
+        const int group = std::min(L, count - base);
+        PT_DSP* lanes[L] = {};
+        const float* cursor[L] = {};
+        int remaining[L] = {};
+        for (int i = 0; i < group; ++i) {
+            PT_DSP* dsp = dsps[base + i];
+            if (!dsp || !blocks[base + i] || num_samples[base + i] <= 0) {
+                out_frames[base + i] = pt_dsp_process(dsp, blocks[base + i], num_samples[base + i]);
+                continue;
+            }
+            lanes[i] = dsp;
+            cursor[i] = blocks[base + i];
+            remaining[i] = num_samples[base + i];
+        }
+        // One round per hop: every stream with a completed hop joins the round.
+        for (;;) {
+            PT_DSP* due[L];
+            int due_count = 0;
+            for (int i = 0; i < group; ++i) {
+                if (lanes[i] && remaining[i] > 0 && feed_hop(lanes[i], &cursor[i], &remaining[i])) {
+                    due[due_count++] = lanes[i];
+                }
+            }
+            if (due_count == 0) {
+                break;
+            }
+            run_due_analyses(due, due_count, ws);
+            produced += due_count;
+        }
+        for (int i = 0; i < group; ++i) {
+            if (lanes[i]) {
+                out_frames[base + i] = lanes[i]->last_output;
+            }
+        }
+    }
+    return produced;
+}
+
+int pt_dsp::warmup_samples(const PT_DSP* dsp) {
+    return dsp->frame_size + (dsp->decimated ? dsp->decimated->filter.taps() : 0);
+}
+
+void pt_dsp::set_stream_origin(PT_DSP* dsp, int64_t first_sample) {
+    dsp->samples_consumed = first_sample;
+}
+
+int pt_dsp::push_periods(PT_DSP* dsp, const float* mono_samples, int num_samples, PeriodEstimate* out,
+                         int max_out) {
+    int produced = 0;
+    while (num_samples > 0 && feed_hop(dsp, &mono_samples, &num_samples)) {
+        if (produced < max_out) {
+            PeriodEstimate& e = out[produced];
+            e.timestamp_ms = due_timestamp_ms(dsp);
+            e.refined_lag = 0.0;
+            e.best_cmndf = 1.0;
+            e.found = estimate_period(dsp, due_window(dsp), due_window_size(dsp), &e.refined_lag, &e.best_cmndf);
+        }
+        ++produced;
+    }
+    return produced;
+}
+
+DSPFrameOutput pt_dsp::finish_period(PT_DSP* dsp, const PeriodEstimate& estimate) {
+    DSPFrameOutput& out = dsp->last_output;
+    reset_output(&out, estimate.timestamp_ms);
+    if (estimate.found) {
+        finish_analysis(dsp, estimate.refined_lag, estimate.best_cmndf, &out);
+    }
     sanitize_output(&out);
-#ifndef NDEBUG
-    const auto elapsed_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::steady_clock::now() - process_start).count());
-    dsp->process_calls += 1;
-    dsp->process_total_us += elapsed_us;
-    dsp->process_max_us = std::max(dsp->process_max_us, elapsed_us);
-    // Counters are accumulated for external inspection via pt_dsp_query_timing().
-    // Avoid fprintf here: this function runs on the realtime audio thread, and
-    // blocking I/O can cause audible glitches or trigger watchdog timeouts.
-#endif
     return out;
 }
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pt_dsp/dsp_api.h"
+
+#include <cstdint>
+
+// Stage-level access to PT_DSP for library code outside dsp_core.cpp.
+namespace pt_dsp {
+
+// Configuration an instance actually runs with: sample rate, frame and hop
+// size after pt_dsp_create's defaults and clamping.
+DSPConfig resolved_config(const PT_DSP* dsp);
+
+// Samples of input after which an analysis no longer depends on what the
+// instance saw before them: the window plus the decimation filter, if any.
+int warmup_samples(const PT_DSP* dsp);
+
+// Numbers the next sample fed to a fresh instance as first_sample, so frame
+// timestamps continue a stream that started earlier. Call before any samples
+// are pushed.
+void set_stream_origin(PT_DSP* dsp, int64_t first_sample);
+
+// Result of the YIN period search for one hop. It depends only on the input
+// window, not on octave tracking or pitch history.
+struct PeriodEstimate {
+    double timestamp_ms;
+    double refined_lag;
+    double best_cmndf;
+    bool found;
+};
+
+// Same as pt_dsp_push, but stops each analysis after the period search and
+// leaves tracking and history untouched.
+int push_periods(PT_DSP* dsp, const float* mono_samples, int num_samples, PeriodEstimate* out, int max_out);
+
+// Completes an analysis from its period estimate: octave tracking,
+// confidence, history and vibrato. Feeding every estimate of a stream in order
+// reproduces pt_dsp_push's frames.
+DSPFrameOutput finish_period(PT_DSP* dsp, const PeriodEstimate& estimate);
+
+}  // namespace pt_dsp
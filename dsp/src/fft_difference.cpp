@@ -0,0 +1,183 @@
+#include "fft_difference.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <new>
+#include <utility>
+
+namespace pt_dsp {
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+// exp(-2*pi*i*k / kMaxFftSize) for k < kMaxFftSize / 2. Every smaller
+// power-of-two transform reads this table with a stride.
+struct Twiddles {
+    std::array<double, kMaxFftSize / 2> re{};
+    std::array<double, kMaxFftSize / 2> im{};
+
+    Twiddles() {
+        for (int k = 0; k < kMaxFftSize / 2; ++k) {
+            const double angle = 2.0 * kPi * static_cast<double>(k) / static_cast<double>(kMaxFftSize);
+            re[k] = std::cos(angle);
+            im[k] = -std::sin(angle);
+        }
+    }
+};
+
+const Twiddles& shared_twiddles() {
+    static const Twiddles table;
+    return table;
+}
+
+int next_power_of_two(int v) {
+    int p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// In-place iterative radix-2 forward transform of m complex points (m <= kMaxFftSize / 2).
+void fft_forward(double* re, double* im, int m, const Twiddles& tw) {
+    for (int i = 1, j = 0; i < m; ++i) {
+        int bit = m >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (int len = 2; len <= m; len <<= 1) {
+        const int half = len >> 1;
+        const int stride = kMaxFftSize / len;
+        for (int start = 0; start < m; start += len) {
+            for (int k = 0; k < half; ++k) {
+                const double wr = tw.re[k * stride];
+                const double wi = tw.im[k * stride];
+                const int a = start + k;
+                const int b = a + half;
+                const double tr = re[b] * wr - im[b] * wi;
+                const double ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+}  // namespace
+
+std::size_t FftDifference::storage_size(int max_samples) {
+    // re, im and the power spectrum over half the largest transform, then the
+    // prefix energies.
+    constexpr int max_half = kMaxFftSize / 2;
+    return static_cast<std::size_t>(3 * max_half + 1) + static_cast<std::size_t>(std::max(0, max_samples) + 1);
+}
+
+FftDifference::FftDifference(int max_samples) {
+    if (max_samples <= 0 || 2 * max_samples > kMaxFftSize) {
+        return;
+    }
+    owned_.reset(new (std::nothrow) double[storage_size(max_samples)]);
+    if (owned_) {
+        attach(max_samples, owned_.get());
+    }
+}
+
+FftDifference::FftDifference(int max_samples, double* storage) {
+    if (max_samples <= 0 || 2 * max_samples > kMaxFftSize || storage == nullptr) {
+        return;
+    }
+    attach(max_samples, storage);
+}
+
+void FftDifference::attach(int max_samples, double* storage) {
+    shared_twiddles();
+    constexpr int max_half = kMaxFftSize / 2;
+    re_ = storage;
+    im_ = re_ + max_half;
+    spectrum_ = im_ + max_half;
+    prefix_energy_ = spectrum_ + max_half + 1;
+    max_samples_ = max_samples;
+}
+
+template <typename T>
+void FftDifference::compute(const T* x, int n, int min_lag, int max_lag, T* diff) {
+    if (!valid() || n > max_samples_ || min_lag <= 0 || max_lag >= n || min_lag > max_lag) {
+        return;
+    }
+    const Twiddles& tw = shared_twiddles();
+    double* re = re_;
+    double* im = im_;
+    double* power = spectrum_;
+    double* prefix = prefix_energy_;
+
+    prefix[0] = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const double v = x[i];
+        prefix[i + 1] = prefix[i] + v * v;
+    }
+
+    // Real FFT of length fft_size computed as a complex FFT of half the length
+    // over the even/odd interleaved samples.
+    const int fft_size = std::max(4, next_power_of_two(n + max_lag + 1));
+    const int half = fft_size / 2;
+    const int unpack_stride = kMaxFftSize / fft_size;
+    for (int m = 0; m < half; ++m) {
+        const int even = 2 * m;
+        re[m] = even < n ? static_cast<double>(x[even]) : 0.0;
+        im[m] = even + 1 < n ? static_cast<double>(x[even + 1]) : 0.0;
+    }
+    fft_forward(re, im, half, tw);
+
+    power[0] = (re[0] + im[0]) * (re[0] + im[0]);
+    power[half] = (re[0] - im[0]) * (re[0] - im[0]);
+    for (int k = 1; k < half; ++k) {
+        const double zr = re[k];
+        const double zi = im[k];
+        const double cr = re[half - k];
+        const double ci = -im[half - k];
+        const double even_r = 0.5 * (zr + cr);
+        const double even_i = 0.5 * (zi + ci);
+        const double odd_r = 0.5 * (zi - ci);
+        const double odd_i = -0.5 * (zr - cr);
+        const double wr = tw.re[k * unpack_stride];
+        const double wi = tw.im[k * unpack_stride];
+        const double xr = even_r + wr * odd_r - wi * odd_i;
+        const double xi = even_i + wr * odd_i + wi * odd_r;
+        power[k] = xr * xr + xi * xi;
+    }
+
+    // Inverse real FFT of the (real, symmetric) power spectrum. The inverse
+    // half-size transform is done as conj(FFT(conj(Z))), so the imaginary
+    // parts are negated on the way in and out.
+    for (int k = 0; k < half; ++k) {
+        const double even = 0.5 * (power[k] + power[half - k]);
+        const double s = 0.5 * (power[k] - power[half - k]);
+        const double wr = tw.re[k * unpack_stride];
+        const double wi = tw.im[k * unpack_stride];
+        re[k] = even + s * wi;
+        im[k] = -(s * wr);
+    }
+    fft_forward(re, im, half, tw);
+    const double scale = 1.0 / static_cast<double>(half);
+
+    const double total_energy = prefix[n];
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        const int m = lag >> 1;
+        const double r = ((lag & 1) ? -im[m] : re[m]) * scale;
+        const double d = prefix[n - lag] + (total_energy - prefix[lag]) - 2.0 * r;
+        diff[lag] = static_cast<T>(std::max(0.0, d));
+    }
+}
+
+template void FftDifference::compute<double>(const double*, int, int, int, double*);
+template void FftDifference::compute<float>(const float*, int, int, int, float*);
+
+}  // namespace pt_dsp
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace pt_dsp {
+
+// Largest real FFT length supported by FftDifference. Linear (non-circular)
+// autocorrelation of an n-sample buffer up to max_lag needs a transform of at
+// least n + max_lag + 1 points, so this covers 4096-sample windows.
+constexpr int kMaxFftSize = 8192;
+
+// Computes the YIN difference function
+//   d(tau) = sum_{i < n - tau} (x[i] - x[i + tau])^2
+// as E_head(tau) + E_tail(tau) - 2 * r(tau), where r is the autocorrelation
+// obtained from a real FFT and the energy terms come from a prefix sum of x^2.
+// Cost is O(n log n) per call instead of O(n * lags) for the direct loop.
+//
+// All scratch is allocated by the constructor, or supplied to it, and the
+// twiddle table is shared and immutable, so compute() does not allocate or
+// lock.
+class FftDifference {
+public:
+    // Doubles of scratch an instance for max_samples needs.
+    static std::size_t storage_size(int max_samples);
+
+    explicit FftDifference(int max_samples);
+    // Uses storage_size(max_samples) doubles at storage, which must outlive
+    // the instance.
+    FftDifference(int max_samples, double* storage);
+    FftDifference(const FftDifference&) = delete;
+    FftDifference& operator=(const FftDifference&) = delete;
+
+    // False when max_samples is out of range or the constructor could not
+    // allocate its scratch buffers.
+    bool valid() const { return re_ != nullptr; }
+
+    // Writes diff[lag] for every lag in [min_lag, max_lag].
+    // Requires 0 < min_lag <= max_lag < n <= max_samples. T is double or
+    // float; the transform itself always runs in double.
+    template <typename T>
+    void compute(const T* x, int n, int min_lag, int max_lag, T* diff);
+
+private:
+    void attach(int max_samples, double* storage);
+
+    int max_samples_ = 0;
+    std::unique_ptr<double[]> owned_;  // scratch when none was supplied
+    double* re_ = nullptr;
+    double* im_ = nullptr;
+    double* spectrum_ = nullptr;
+    double* prefix_energy_ = nullptr;
+};
+
+}  // namespace pt_dsp
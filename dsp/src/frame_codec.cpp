@@ -0,0 +1,247 @@
+#include "pt_dsp/frame_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PT_DSP_SSE2_CODEC 1
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define PT_DSP_NEON_CODEC 1
+#include <arm_neon.h>
+#endif
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "frame_codec.cpp copies record fields in host order and assumes a little-endian host"
+#endif
+
+static_assert(sizeof(PTPackedFrameHeader) == 24, "header layout is part of the format");
+
+namespace {
+// Frames converted per pass: fields are gathered into arrays of this length
+// so the conversions below run over contiguous data.
+constexpr size_t kBlock = 64;
+constexpr int kUnvoicedMidi = 255;
+constexpr double kMaxDeltaTicks = 65535.0;
+// Largest first timestamp a block takes: leaves room in int64_t for every
+// delta the decoder adds to it.
+constexpr double kMaxBaseTicks = 4611686018427387904.0;  // 2^62
+
+// out[i] = x[i] * scale clamped to [lo, hi] and rounded to nearest (ties to
+// even); NaN becomes lo. All paths give identical results.
+void quantize(const double* x, size_t n, double scale, double lo, double hi, int32_t* out) {
+    size_t i = 0;
+#if PT_DSP_SSE2_CODEC
+    const __m128d s = _mm_set1_pd(scale);
+    const __m128d l = _mm_set1_pd(lo);
+    const __m128d h = _mm_set1_pd(hi);
+    for (; i + 2 <= n; i += 2) {
+        // maxpd returns its second operand when either is NaN.
+        const __m128d v = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_loadu_pd(x + i), s), l), h);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_cvtpd_epi32(v));
+    }
+#elif PT_DSP_NEON_CODEC
+    const float64x2_t s = vdupq_n_f64(scale);
+    const float64x2_t l = vdupq_n_f64(lo);
+    const float64x2_t h = vdupq_n_f64(hi);
+    for (; i + 2 <= n; i += 2) {
+        const float64x2_t v = vminq_f64(vmaxnmq_f64(vmulq_f64(vld1q_f64(x + i), s), l), h);
+        vst1_s32(out + i, vmovn_s64(vcvtnq_s64_f64(v)));
+    }
+#endif
+    for (; i < n; ++i) {
+        double v = x[i] * scale;
+        v = v >= lo ? std::min(v, hi) : lo;
+        out[i] = static_cast<int32_t>(std::nearbyint(v));
+    }
+}
+
+// out[i] = q[i] / divisor.
+void dequantize(const int32_t* q, size_t n, double divisor, double* out) {
+    size_t i = 0;
+#if PT_DSP_SSE2_CODEC
+    const __m128d d = _mm_set1_pd(divisor);
+    for (; i + 2 <= n; i += 2) {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + i));
+        _mm_storeu_pd(out + i, _mm_div_pd(_mm_cvtepi32_pd(v), d));
+    }
+#elif PT_DSP_NEON_CODEC
+    const float64x2_t d = vdupq_n_f64(divisor);
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vdivq_f64(vcvtq_f64_s64(vmovl_s32(vld1_s32(q + i))), d));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = static_cast<double>(q[i]) / divisor;
+    }
+}
+
+// Pitch ratios for rebuilding freq_hz without a pow() per frame: a note's
+// ratio to A4, and 2^(c / 120000) for quantised cents c split into its high
+// and low byte.
+struct PitchTables {
+    double semitone[kUnvoicedMidi];
+    double cents_high[256];
+    double cents_low[256];
+
+    PitchTables() {
+        for (int n = 0; n < kUnvoicedMidi; ++n) {
+            semitone[n] = std::exp2((n - 69) / 12.0);
+        }
+        for (int b = 0; b < 256; ++b) {
+            cents_high[b] = std::exp2((b - 128) * 256 / 120000.0);
+            cents_low[b] = std::exp2(b / 120000.0);
+        }
+    }
+};
+
+const PitchTables& pitch_tables() {
+    static const PitchTables tables;
+    return tables;
+}
+
+template <typename V>
+void put(uint8_t* record, size_t offset, V value) {
+    std::memcpy(record + offset, &value, sizeof(V));
+}
+
+template <typename V>
+V get(const uint8_t* record, size_t offset) {
+    V value;
+    std::memcpy(&value, record + offset, sizeof(V));
+    return value;
+}
+
+bool is_voiced(const DSPFrameOutput& f) {
+    return std::isfinite(f.freq_hz) && f.freq_hz > 0.0 && f.nearest_midi >= 0 && f.nearest_midi < kUnvoicedMidi &&
+           std::isfinite(f.cents_error);
+}
+
+bool has_vibrato(const DSPFrameOutput& f) {
+    return f.vibrato_detected && std::isfinite(f.vibrato_rate_hz) && std::isfinite(f.vibrato_depth_cents);
+}
+
+double to_ticks(double timestamp_ms) { return std::nearbyint(timestamp_ms * PT_DSP_PACKED_TICKS_PER_MS); }
+}  // namespace
+
+extern "C" {
+
+size_t pt_dsp_encode_frames(const DSPFrameOutput* frames, size_t count, double a4_hz,
+                            PTPackedFrameHeader* header, uint8_t* out_records) {
+    header->magic = PT_DSP_PACKED_FRAME_MAGIC;
+    header->version = PT_DSP_PACKED_FRAME_VERSION;
+    header->frame_bytes = PT_DSP_PACKED_FRAME_BYTES;
+    header->frame_count = 0;
+    header->a4_hz = static_cast<float>(a4_hz);
+    const double base_ticks = count > 0 ? to_ticks(frames[0].timestamp_ms) : 0.0;
+    if (!(std::fabs(base_ticks) <= kMaxBaseTicks)) {  // NaN, infinite or out of int64_t range
+        header->base_ticks = 0;
+        return 0;
+    }
+    header->base_ticks = static_cast<int64_t>(base_ticks);
+    count = std::min<size_t>(count, UINT32_MAX);
+
+    double cents[kBlock], confidence[kBlock], depth[kBlock], rate[kBlock];
+    int32_t q_cents[kBlock], q_confidence[kBlock], q_depth[kBlock], q_rate[kBlock];
+    double previous_ticks = base_ticks;
+    size_t encoded = 0;
+    while (encoded < count) {
+        const DSPFrameOutput* block = frames + encoded;
+        const size_t n = std::min(kBlock, count - encoded);
+        for (size_t i = 0; i < n; ++i) {
+            cents[i] = block[i].cents_error;
+            confidence[i] = block[i].confidence;
+            depth[i] = block[i].vibrato_depth_cents;
+            rate[i] = block[i].vibrato_rate_hz;
+        }
+        quantize(cents, n, 100.0, -32767.0, 32767.0, q_cents);
+        quantize(confidence, n, 65535.0, 0.0, 65535.0, q_confidence);
+        quantize(depth, n, 100.0, 0.0, 65535.0, q_depth);
+        quantize(rate, n, 10.0, 0.0, 255.0, q_rate);
+
+        for (size_t i = 0; i < n; ++i) {
+            const DSPFrameOutput& f = block[i];
+            const double ticks = to_ticks(f.timestamp_ms);
+            const double dt = ticks - previous_ticks;
+            if (!(dt >= 0.0 && dt <= kMaxDeltaTicks)) {
+                header->frame_count = static_cast<uint32_t>(encoded);
+                return encoded;
+            }
+            previous_ticks = ticks;
+            const bool voiced = is_voiced(f);
+            const bool vibrato = has_vibrato(f);
+            uint8_t* record = out_records + encoded * PT_DSP_PACKED_FRAME_BYTES;
+            put<uint16_t>(record, 0, static_cast<uint16_t>(dt));
+            put<int16_t>(record, 2, static_cast<int16_t>(voiced ? q_cents[i] : 0));
+            put<uint16_t>(record, 4, static_cast<uint16_t>(q_confidence[i]));
+            put<uint16_t>(record, 6, static_cast<uint16_t>(vibrato ? q_depth[i] : 0));
+            record[8] = static_cast<uint8_t>(vibrato ? q_rate[i] : 0);
+            record[9] = static_cast<uint8_t>(voiced ? f.nearest_midi : kUnvoicedMidi);
+            record[10] = static_cast<uint8_t>((voiced ? PT_DSP_PACKED_VOICED : 0) |
+                                              (vibrato ? PT_DSP_PACKED_VIBRATO : 0));
+            record[11] = 0;
+            ++encoded;
+        }
+    }
+    header->frame_count = static_cast<uint32_t>(encoded);
+    return encoded;
+}
+
+size_t pt_dsp_decode_frames(const PTPackedFrameHeader* header, const uint8_t* records,
+                            DSPFrameOutput* out_frames) {
+    if (header->magic != PT_DSP_PACKED_FRAME_MAGIC || header->version != PT_DSP_PACKED_FRAME_VERSION ||
+        header->frame_bytes != PT_DSP_PACKED_FRAME_BYTES) {
+        return 0;
+    }
+    const PitchTables& tables = pitch_tables();
+    const double a4_hz = header->a4_hz;
+    const size_t count = header->frame_count;
+
+    int32_t q_cents[kBlock], q_confidence[kBlock], q_depth[kBlock], q_rate[kBlock];
+    double cents[kBlock], confidence[kBlock], depth[kBlock], rate[kBlock];
+    int64_t ticks = header->base_ticks;
+    for (size_t done = 0; done < count; done += kBlock) {
+        const uint8_t* block = records + done * PT_DSP_PACKED_FRAME_BYTES;
+        const size_t n = std::min(kBlock, count - done);
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* record = block + i * PT_DSP_PACKED_FRAME_BYTES;
+            q_cents[i] = get<int16_t>(record, 2);
+            q_confidence[i] = get<uint16_t>(record, 4);
+            q_depth[i] = get<uint16_t>(record, 6);
+            q_rate[i] = record[8];
+        }
+        dequantize(q_cents, n, 100.0, cents);
+        dequantize(q_confidence, n, 65535.0, confidence);
+        dequantize(q_depth, n, 100.0, depth);
+        dequantize(q_rate, n, 10.0, rate);
+
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* record = block + i * PT_DSP_PACKED_FRAME_BYTES;
+            const uint8_t flags = record[10];
+            const int midi = record[9];
+            DSPFrameOutput& f = out_frames[done + i];
+            ticks += get<uint16_t>(record, 0);
+            f.timestamp_ms = static_cast<double>(ticks) / PT_DSP_PACKED_TICKS_PER_MS;
+            f.confidence = confidence[i];
+            if ((flags & PT_DSP_PACKED_VOICED) != 0 && midi < kUnvoicedMidi) {
+                const uint32_t c = static_cast<uint32_t>(q_cents[i] + 32768);
+                f.freq_hz = a4_hz * tables.semitone[midi] * tables.cents_high[c >> 8] * tables.cents_low[c & 255];
+                f.midi_float = midi + cents[i] / 100.0;
+                f.nearest_midi = midi;
+                f.cents_error = cents[i];
+            } else {
+                f.freq_hz = NAN;
+                f.midi_float = NAN;
+                f.nearest_midi = -1;
+                f.cents_error = NAN;
+            }
+            f.vibrato_detected = (flags & PT_DSP_PACKED_VIBRATO) != 0;
+            f.vibrato_rate_hz = f.vibrato_detected ? rate[i] : NAN;
+            f.vibrato_depth_cents = f.vibrato_detected ? depth[i] : NAN;
+        }
+    }
+    return count;
+}
+
+}  // extern "C"
@@ -0,0 +1,75 @@
+#include "kernels.h"
+
+#include <initializer_list>
+
+namespace pt_dsp {
+namespace {
+bool cpu_supports(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::kScalar:
+            return true;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        case KernelIsa::kSse2:
+            return true;
+        case KernelIsa::kAvx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case KernelIsa::kAvx512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(__aarch64__)
+        case KernelIsa::kNeon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const Kernels* compiled_kernels(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::kScalar:
+            return &scalar_kernels();
+        case KernelIsa::kSse2:
+            return sse2_kernels();
+        case KernelIsa::kAvx2:
+            return avx2_kernels();
+        case KernelIsa::kAvx512:
+            return avx512_kernels();
+        case KernelIsa::kNeon:
+            return neon_kernels();
+    }
+    return nullptr;
+}
+
+const Kernels& detect_best_kernels() {
+    for (KernelIsa isa : {KernelIsa::kAvx512, KernelIsa::kAvx2, KernelIsa::kSse2, KernelIsa::kNeon}) {
+        if (const Kernels* k = kernels_for(isa)) {
+            return *k;
+        }
+    }
+    return scalar_kernels();
+}
+}  // namespace
+
+const Kernels* kernels_for(KernelIsa isa) {
+    const Kernels* k = compiled_kernels(isa);
+    return k != nullptr && cpu_supports(isa) ? k : nullptr;
+}
+
+const Kernels& best_kernels() {
+    static const Kernels& best = detect_best_kernels();
+    return best;
+}
+
+const ShapeKernels* shape_kernels_for(const Kernels& k, int sample_rate_hz, int frame_size) {
+    for (int i = 0; i < k.shape_count; ++i) {
+        if (k.shapes[i].sample_rate_hz == sample_rate_hz && k.shapes[i].frame_size == frame_size) {
+            return &k.shapes[i];
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace pt_dsp
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace pt_dsp {
+
+// Streams interleaved by the structure-of-arrays batch kernels.
+constexpr int kBatchLanes = 8;
+
+// Pitch range of the analysis. The lag range searched at a sample rate runs
+// from the period of kMaxFreqHz to that of kMinFreqHz, capped by the window.
+constexpr int kMinFreqHz = 80;
+constexpr int kMaxFreqHz = 1100;
+
+constexpr int min_lag_for(int sample_rate_hz) {
+    return sample_rate_hz / kMaxFreqHz > 1 ? sample_rate_hz / kMaxFreqHz : 1;
+}
+
+constexpr int max_lag_for(int sample_rate_hz, int frame_size) {
+    return sample_rate_hz / kMinFreqHz < frame_size - 1 ? sample_rate_hz / kMinFreqHz : frame_size - 1;
+}
+
+// Sample rate and analysis frame size pairs with difference kernels compiled
+// for their exact window length and lag range (see ShapeKernels).
+struct KernelShape {
+    int sample_rate_hz;
+    int frame_size;
+};
+
+constexpr KernelShape kKernelShapes[] = {
+    {44100, 256}, {44100, 512}, {44100, 1024}, {48000, 256}, {48000, 512}, {48000, 1024},
+};
+constexpr int kKernelShapeCount = static_cast<int>(sizeof(kKernelShapes) / sizeof(kKernelShapes[0]));
+
+enum class KernelIsa {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+// Inner loops of the YIN analysis for one sample type. Every variant computes
+// the same quantities as the scalar reference; only the summation order
+// differs, so results agree to within a few ulps of T.
+template <typename T>
+struct KernelOps {
+    // Returns sum(x[i]).
+    T (*sum)(const float* x, int n);
+    // Writes centered[i] = x[i] - mean and returns sum(centered[i]^2).
+    T (*center)(const float* x, int n, T mean, T* centered);
+    // Returns sum((a[i] - b[i])^2).
+    T (*sum_sq_diff)(const T* a, const T* b, int n);
+    // Returns sum((a[i] - b[i])^2) over raw float input, accumulated in T.
+    T (*sum_sq_diff_f32)(const float* a, const float* b, int n);
+    // Writes diff[lag] = sum_{i < n - lag} (x[i] - x[i + lag])^2 for lag in [min_lag, max_lag].
+    void (*difference)(const T* x, int n, int min_lag, int max_lag, T* diff);
+    // Cumulative-mean-normalised difference: cmndf[min_lag] = 1 and, for later
+    // lags, diff[lag] * lag / sum(diff[min_lag + 1 .. lag]) (1 when that sum is ~0).
+    // cmndf may be diff itself.
+    void (*cmndf)(const T* diff, int min_lag, int max_lag, T* cmndf);
+};
+
+// KernelOps::difference for one KernelShape, with the window length and lag
+// range as template constants so every trip count is fixed at compile time.
+// Only valid for windows of frame_size samples searched over exactly
+// [min_lag, max_lag].
+struct ShapeKernels {
+    int sample_rate_hz;
+    int frame_size;
+    int min_lag;
+    int max_lag;
+    void (*difference_f64)(const double* x, double* diff);
+    void (*difference_f32)(const float* x, float* diff);
+
+    void difference(const double* x, double* diff) const { difference_f64(x, diff); }
+    void difference(const float* x, float* diff) const { difference_f32(x, diff); }
+};
+
+template <class Impl, int SampleRate, int FrameSize>
+constexpr ShapeKernels make_shape_entry() {
+    constexpr int min_lag = min_lag_for(SampleRate);
+    constexpr int max_lag = max_lag_for(SampleRate, FrameSize);
+    return {
+        SampleRate,
+        FrameSize,
+        min_lag,
+        max_lag,
+        &Impl::template difference<FrameSize, min_lag, max_lag>,
+        &Impl::template difference<FrameSize, min_lag, max_lag>,
+    };
+}
+
+template <class Impl, std::size_t... I>
+constexpr std::array<ShapeKernels, kKernelShapeCount> make_shape_kernels(std::index_sequence<I...>) {
+    return {{make_shape_entry<Impl, kKernelShapes[I].sample_rate_hz, kKernelShapes[I].frame_size>()...}};
+}
+
+// One ShapeKernels per kKernelShapes entry from Impl, which provides
+//   template <int N, int MinLag, int MaxLag> static void difference(const T* x, T* diff);
+// for T = double and float.
+template <class Impl>
+constexpr std::array<ShapeKernels, kKernelShapeCount> make_shape_kernels() {
+    return make_shape_kernels<Impl>(std::make_index_sequence<kKernelShapeCount>());
+}
+
+struct Kernels {
+    KernelIsa isa;
+    const char* name;
+    KernelOps<double> f64;
+    KernelOps<float> f32;
+
+    // Structure-of-arrays kernels over kBatchLanes interleaved double streams,
+    // where element i of stream s lives at [i * kBatchLanes + s]. Lanes are
+    // independent, so no horizontal reductions are needed.
+    // Adds sum_{i < n} (a[i][s] - b[i][s])^2 to out[s].
+    void (*sum_sq_diff_x8)(const double* a, const double* b, int n, double* out);
+    // Per-lane equivalent of KernelOps::cmndf over diff[lag][s].
+    void (*cmndf_x8)(const double* diff, int min_lag, int max_lag, double* cmndf);
+
+    // Shape-specialised difference kernels, shape_count of them; empty for
+    // variants whose generic difference is already as fast.
+    const ShapeKernels* shapes;
+    int shape_count;
+
+    template <typename T>
+    const KernelOps<T>& ops() const;
+};
+
+template <>
+inline const KernelOps<double>& Kernels::ops<double>() const {
+    return f64;
+}
+
+template <>
+inline const KernelOps<float>& Kernels::ops<float>() const {
+    return f32;
+}
+
+const Kernels& scalar_kernels();
+
+// Per-ISA tables. Each returns nullptr when the variant is not compiled for
+// this target; callers must still check CPU support through kernels_for().
+const Kernels* sse2_kernels();
+const Kernels* avx2_kernels();
+const Kernels* avx512_kernels();
+const Kernels* neon_kernels();
+
+// Returns the variant for isa if it is compiled in and supported by this CPU,
+// otherwise nullptr.
+const Kernels* kernels_for(KernelIsa isa);
+
+// Widest variant supported by this CPU. Feature detection runs once.
+const Kernels& best_kernels();
+
+// k's specialised difference for this sample rate and frame size, or nullptr
+// when it has none and the generic kernel applies.
+const ShapeKernels* shape_kernels_for(const Kernels& k, int sample_rate_hz, int frame_size);
+
+}  // namespace pt_dsp
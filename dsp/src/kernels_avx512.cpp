@@ -0,0 +1,308 @@
+#include "kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PT_DSP_AVX512_KERNELS 1
+#include <immintrin.h>
+// AVX-512F only (no VL/DQ), selected at runtime by best_kernels().
+#define PT_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace pt_dsp {
+
+#if PT_DSP_AVX512_KERNELS
+namespace {
+PT_AVX512 inline __mmask8 tail_mask8(int remaining) {
+    return static_cast<__mmask8>((1u << remaining) - 1u);
+}
+
+PT_AVX512 inline __m512d load_f32_as_f64(const float* x, __mmask8 mask) {
+    const __m512 v = _mm512_maskz_loadu_ps(static_cast<__mmask16>(mask), x);
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+}
+
+PT_AVX512 double sum_avx512(const float* x, int n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_pd(acc0, _mm512_cvtps_pd(_mm256_loadu_ps(x + i)));
+        acc1 = _mm512_add_pd(acc1, _mm512_cvtps_pd(_mm256_loadu_ps(x + i + 8)));
+    }
+    for (; i < n; i += 8) {
+        const int remaining = n - i < 8 ? n - i : 8;
+        acc0 = _mm512_add_pd(acc0, load_f32_as_f64(x + i, tail_mask8(remaining)));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+PT_AVX512 double center_avx512(const float* x, int n, double mean, double* centered) {
+    const __m512d m = _mm512_set1_pd(mean);
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512d lo = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i)), m);
+        const __m512d hi = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x + i + 8)), m);
+        _mm512_storeu_pd(centered + i, lo);
+        _mm512_storeu_pd(centered + i + 8, hi);
+        acc0 = _mm512_fmadd_pd(lo, lo, acc0);
+        acc1 = _mm512_fmadd_pd(hi, hi, acc1);
+    }
+    for (; i < n; i += 8) {
+        const int remaining = n - i < 8 ? n - i : 8;
+        const __mmask8 mask = tail_mask8(remaining);
+        const __m512d v = _mm512_maskz_sub_pd(mask, load_f32_as_f64(x + i, mask), m);
+        _mm512_mask_storeu_pd(centered + i, mask, v);
+        acc0 = _mm512_fmadd_pd(v, v, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+PT_AVX512 inline double sum_sq_diff_impl(const double* a, const double* b, int n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        const __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    for (; i < n; i += 8) {
+        const int remaining = n - i < 8 ? n - i : 8;
+        const __mmask8 mask = tail_mask8(remaining);
+        const __m512d d = _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i));
+        acc0 = _mm512_fmadd_pd(d, d, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+PT_AVX512 double sum_sq_diff_avx512(const double* a, const double* b, int n) {
+    return sum_sq_diff_impl(a, b, n);
+}
+
+PT_AVX512 double sum_sq_diff_f32_avx512(const float* a, const float* b, int n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512d d0 =
+            _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i)), _mm512_cvtps_pd(_mm256_loadu_ps(b + i)));
+        const __m512d d1 =
+            _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8)), _mm512_cvtps_pd(_mm256_loadu_ps(b + i + 8)));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    for (; i < n; i += 8) {
+        const int remaining = n - i < 8 ? n - i : 8;
+        const __mmask8 mask = tail_mask8(remaining);
+        const __m512d d = _mm512_sub_pd(load_f32_as_f64(a + i, mask), load_f32_as_f64(b + i, mask));
+        acc0 = _mm512_fmadd_pd(d, d, acc0);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+PT_AVX512 void difference_avx512(const double* x, int n, int min_lag, int max_lag, double* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_impl(x, x + lag, n - lag);
+    }
+}
+
+PT_AVX512 void cmndf_avx512(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    cmndf[min_lag] = 1.0;
+    const __m512d floor = _mm512_set1_pd(1e-12);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d step = _mm512_set1_pd(8.0);
+    const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i last = _mm512_set1_epi64(7);
+    __m512d carry = _mm512_setzero_pd();
+    __m512d lags = _mm512_add_pd(_mm512_set1_pd(static_cast<double>(min_lag + 1)),
+                                 _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0));
+    for (int lag = min_lag + 1; lag <= max_lag; lag += 8) {
+        const int remaining = max_lag + 1 - lag < 8 ? max_lag + 1 - lag : 8;
+        const __mmask8 mask = tail_mask8(remaining);
+        const __m512d d = _mm512_maskz_loadu_pd(mask, diff + lag);
+        // In-register prefix sum over 8 lanes in three shift-and-add steps.
+        __m512d running = _mm512_add_pd(d, _mm512_maskz_permutexvar_pd(0xFE, shift1, d));
+        running = _mm512_add_pd(running, _mm512_maskz_permutexvar_pd(0xFC, shift2, running));
+        running = _mm512_add_pd(running, _mm512_maskz_permutexvar_pd(0xF0, shift4, running));
+        running = _mm512_add_pd(running, carry);
+        const __m512d value = _mm512_div_pd(_mm512_mul_pd(d, lags), running);
+        const __mmask8 tiny = _mm512_cmp_pd_mask(running, floor, _CMP_LE_OQ);
+        _mm512_mask_storeu_pd(cmndf + lag, mask, _mm512_mask_blend_pd(tiny, value, one));
+        carry = _mm512_permutexvar_pd(last, running);
+        lags = _mm512_add_pd(lags, step);
+    }
+}
+
+// Single precision: sixteen lanes per register, float accumulators.
+PT_AVX512 inline __mmask16 tail_mask16(int remaining) {
+    return static_cast<__mmask16>((1u << remaining) - 1u);
+}
+
+PT_AVX512 float sum_avx512_ps(const float* x, int n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(x + i));
+        acc1 = _mm512_add_ps(acc1, _mm512_loadu_ps(x + i + 16));
+    }
+    for (; i < n; i += 16) {
+        const int remaining = n - i < 16 ? n - i : 16;
+        acc0 = _mm512_add_ps(acc0, _mm512_maskz_loadu_ps(tail_mask16(remaining), x + i));
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+PT_AVX512 float center_avx512_ps(const float* x, int n, float mean, float* centered) {
+    const __m512 m = _mm512_set1_ps(mean);
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m512 lo = _mm512_sub_ps(_mm512_loadu_ps(x + i), m);
+        const __m512 hi = _mm512_sub_ps(_mm512_loadu_ps(x + i + 16), m);
+        _mm512_storeu_ps(centered + i, lo);
+        _mm512_storeu_ps(centered + i + 16, hi);
+        acc0 = _mm512_fmadd_ps(lo, lo, acc0);
+        acc1 = _mm512_fmadd_ps(hi, hi, acc1);
+    }
+    for (; i < n; i += 16) {
+        const int remaining = n - i < 16 ? n - i : 16;
+        const __mmask16 mask = tail_mask16(remaining);
+        const __m512 v = _mm512_maskz_sub_ps(mask, _mm512_maskz_loadu_ps(mask, x + i), m);
+        _mm512_mask_storeu_ps(centered + i, mask, v);
+        acc0 = _mm512_fmadd_ps(v, v, acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+PT_AVX512 inline float sum_sq_diff_impl_ps(const float* a, const float* b, int n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        const __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i < n; i += 16) {
+        const int remaining = n - i < 16 ? n - i : 16;
+        const __mmask16 mask = tail_mask16(remaining);
+        const __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        acc0 = _mm512_fmadd_ps(d, d, acc0);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+PT_AVX512 float sum_sq_diff_avx512_ps(const float* a, const float* b, int n) {
+    return sum_sq_diff_impl_ps(a, b, n);
+}
+
+PT_AVX512 void difference_avx512_ps(const float* x, int n, int min_lag, int max_lag, float* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_impl_ps(x, x + lag, n - lag);
+    }
+}
+
+PT_AVX512 void cmndf_avx512_ps(const float* diff, int min_lag, int max_lag, float* cmndf) {
+    cmndf[min_lag] = 1.0f;
+    const __m512 floor = _mm512_set1_ps(1e-12f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 step = _mm512_set1_ps(16.0f);
+    const __m512i iota = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i shift1 = _mm512_sub_epi32(iota, _mm512_set1_epi32(1));
+    const __m512i shift2 = _mm512_sub_epi32(iota, _mm512_set1_epi32(2));
+    const __m512i shift4 = _mm512_sub_epi32(iota, _mm512_set1_epi32(4));
+    const __m512i shift8 = _mm512_sub_epi32(iota, _mm512_set1_epi32(8));
+    const __m512i last = _mm512_set1_epi32(15);
+    __m512 carry = _mm512_setzero_ps();
+    __m512 lags = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(min_lag + 1)), _mm512_cvtepi32_ps(iota));
+    for (int lag = min_lag + 1; lag <= max_lag; lag += 16) {
+        const int remaining = max_lag + 1 - lag < 16 ? max_lag + 1 - lag : 16;
+        const __mmask16 mask = tail_mask16(remaining);
+        const __m512 d = _mm512_maskz_loadu_ps(mask, diff + lag);
+        // In-register prefix sum over 16 lanes in four shift-and-add steps.
+        __m512 running = _mm512_add_ps(d, _mm512_maskz_permutexvar_ps(0xFFFE, shift1, d));
+        running = _mm512_add_ps(running, _mm512_maskz_permutexvar_ps(0xFFFC, shift2, running));
+        running = _mm512_add_ps(running, _mm512_maskz_permutexvar_ps(0xFFF0, shift4, running));
+        running = _mm512_add_ps(running, _mm512_maskz_permutexvar_ps(0xFF00, shift8, running));
+        running = _mm512_add_ps(running, carry);
+        const __m512 value = _mm512_div_ps(_mm512_mul_ps(d, lags), running);
+        const __mmask16 tiny = _mm512_cmp_ps_mask(running, floor, _CMP_LE_OQ);
+        _mm512_mask_storeu_ps(cmndf + lag, mask, _mm512_mask_blend_ps(tiny, value, one));
+        carry = _mm512_permutexvar_ps(last, running);
+        lags = _mm512_add_ps(lags, step);
+    }
+}
+
+// Batch kernels: the eight lanes of one sample index fill one register.
+PT_AVX512 void sum_sq_diff_x8_avx512(const double* a, const double* b, int n, double* out) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const double* pa = a + i * kBatchLanes;
+        const double* pb = b + i * kBatchLanes;
+        const __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(pa), _mm512_loadu_pd(pb));
+        const __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(pa + 8), _mm512_loadu_pd(pb + 8));
+        const __m512d d2 = _mm512_sub_pd(_mm512_loadu_pd(pa + 16), _mm512_loadu_pd(pb + 16));
+        const __m512d d3 = _mm512_sub_pd(_mm512_loadu_pd(pa + 24), _mm512_loadu_pd(pb + 24));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+        acc2 = _mm512_fmadd_pd(d2, d2, acc2);
+        acc3 = _mm512_fmadd_pd(d3, d3, acc3);
+    }
+    for (; i < n; ++i) {
+        const __m512d d = _mm512_sub_pd(_mm512_loadu_pd(a + i * kBatchLanes), _mm512_loadu_pd(b + i * kBatchLanes));
+        acc0 = _mm512_fmadd_pd(d, d, acc0);
+    }
+    const __m512d sum = _mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3));
+    _mm512_storeu_pd(out, _mm512_add_pd(_mm512_loadu_pd(out), sum));
+}
+
+PT_AVX512 void cmndf_x8_avx512(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    const __m512d floor = _mm512_set1_pd(1e-12);
+    const __m512d one = _mm512_set1_pd(1.0);
+    __m512d running = _mm512_setzero_pd();
+    _mm512_storeu_pd(cmndf + min_lag * kBatchLanes, one);
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        const __m512d d = _mm512_loadu_pd(diff + lag * kBatchLanes);
+        running = _mm512_add_pd(running, d);
+        const __m512d value = _mm512_div_pd(_mm512_mul_pd(d, _mm512_set1_pd(static_cast<double>(lag))), running);
+        const __mmask8 tiny = _mm512_cmp_pd_mask(running, floor, _CMP_LE_OQ);
+        _mm512_storeu_pd(cmndf + lag * kBatchLanes, _mm512_mask_blend_pd(tiny, value, one));
+    }
+}
+
+const Kernels kAvx512Kernels = {
+    KernelIsa::kAvx512,
+    "avx512",
+    {sum_avx512, center_avx512, sum_sq_diff_avx512, sum_sq_diff_f32_avx512, difference_avx512, cmndf_avx512},
+    {sum_avx512_ps, center_avx512_ps, sum_sq_diff_avx512_ps, sum_sq_diff_avx512_ps, difference_avx512_ps,
+     cmndf_avx512_ps},
+    sum_sq_diff_x8_avx512,
+    cmndf_x8_avx512,
+    // No shape table: lag-blocked variants measured no faster than difference_avx512,
+    // which is already bound by its loads at these window sizes.
+    nullptr,
+    0,
+};
+}  // namespace
+
+const Kernels* avx512_kernels() {
+    return &kAvx512Kernels;
+}
+#else
+const Kernels* avx512_kernels() {
+    return nullptr;
+}
+#endif
+
+}  // namespace pt_dsp
@@ -0,0 +1,388 @@
+#include "kernels.h"
+
+// Double-precision NEON needs AArch64; 32-bit ARM builds use the scalar table.
+#if defined(__aarch64__)
+#define PT_DSP_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+namespace pt_dsp {
+
+#if PT_DSP_NEON_KERNELS
+namespace {
+double sum_neon(const float* x, int n) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(x + i);
+        acc0 = vaddq_f64(acc0, vcvt_f64_f32(vget_low_f32(v)));
+        acc1 = vaddq_f64(acc1, vcvt_high_f64_f32(v));
+    }
+    double sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+double center_neon(const float* x, int n, double mean, double* centered) {
+    const float64x2_t m = vdupq_n_f64(mean);
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vld1q_f32(x + i);
+        const float64x2_t lo = vsubq_f64(vcvt_f64_f32(vget_low_f32(v)), m);
+        const float64x2_t hi = vsubq_f64(vcvt_high_f64_f32(v), m);
+        vst1q_f64(centered + i, lo);
+        vst1q_f64(centered + i + 2, hi);
+        acc0 = vfmaq_f64(acc0, lo, lo);
+        acc1 = vfmaq_f64(acc1, hi, hi);
+    }
+    double energy = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        centered[i] = static_cast<double>(x[i]) - mean;
+        energy += centered[i] * centered[i];
+    }
+    return energy;
+}
+
+inline double sum_sq_diff_impl(const double* a, const double* b, int n) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    float64x2_t acc2 = vdupq_n_f64(0.0);
+    float64x2_t acc3 = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float64x2_t d0 = vsubq_f64(vld1q_f64(a + i), vld1q_f64(b + i));
+        const float64x2_t d1 = vsubq_f64(vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+        const float64x2_t d2 = vsubq_f64(vld1q_f64(a + i + 4), vld1q_f64(b + i + 4));
+        const float64x2_t d3 = vsubq_f64(vld1q_f64(a + i + 6), vld1q_f64(b + i + 6));
+        acc0 = vfmaq_f64(acc0, d0, d0);
+        acc1 = vfmaq_f64(acc1, d1, d1);
+        acc2 = vfmaq_f64(acc2, d2, d2);
+        acc3 = vfmaq_f64(acc3, d3, d3);
+    }
+    for (; i + 2 <= n; i += 2) {
+        const float64x2_t d0 = vsubq_f64(vld1q_f64(a + i), vld1q_f64(b + i));
+        acc0 = vfmaq_f64(acc0, d0, d0);
+    }
+    double d = vaddvq_f64(vaddq_f64(vaddq_f64(acc0, acc1), vaddq_f64(acc2, acc3)));
+    for (; i < n; ++i) {
+        const double delta = a[i] - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+double sum_sq_diff_neon(const double* a, const double* b, int n) {
+    return sum_sq_diff_impl(a, b, n);
+}
+
+double sum_sq_diff_f32_neon(const float* a, const float* b, int n) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t va = vld1q_f32(a + i);
+        const float32x4_t vb = vld1q_f32(b + i);
+        const float64x2_t d0 = vsubq_f64(vcvt_f64_f32(vget_low_f32(va)), vcvt_f64_f32(vget_low_f32(vb)));
+        const float64x2_t d1 = vsubq_f64(vcvt_high_f64_f32(va), vcvt_high_f64_f32(vb));
+        acc0 = vfmaq_f64(acc0, d0, d0);
+        acc1 = vfmaq_f64(acc1, d1, d1);
+    }
+    double d = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) {
+        const double delta = static_cast<double>(a[i]) - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+void difference_neon(const double* x, int n, int min_lag, int max_lag, double* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_impl(x, x + lag, n - lag);
+    }
+}
+
+void cmndf_neon(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    cmndf[min_lag] = 1.0;
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    const float64x2_t floor = vdupq_n_f64(1e-12);
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t step = vdupq_n_f64(2.0);
+    float64x2_t carry = zero;
+    float64x2_t lags = vcombine_f64(vdup_n_f64(static_cast<double>(min_lag + 1)),
+                                    vdup_n_f64(static_cast<double>(min_lag + 2)));
+    int lag = min_lag + 1;
+    for (; lag + 2 <= max_lag + 1; lag += 2) {
+        const float64x2_t d = vld1q_f64(diff + lag);
+        // In-register prefix sum: [d0, d0 + d1] on top of the running total.
+        const float64x2_t running = vaddq_f64(carry, vaddq_f64(d, vextq_f64(zero, d, 1)));
+        const float64x2_t value = vdivq_f64(vmulq_f64(d, lags), running);
+        vst1q_f64(cmndf + lag, vbslq_f64(vcleq_f64(running, floor), one, value));
+        carry = vdupq_laneq_f64(running, 1);
+        lags = vaddq_f64(lags, step);
+    }
+    double running_sum = vgetq_lane_f64(carry, 0);
+    for (; lag <= max_lag; ++lag) {
+        running_sum += diff[lag];
+        cmndf[lag] = running_sum <= 1e-12 ? 1.0 : diff[lag] * static_cast<double>(lag) / running_sum;
+    }
+}
+
+// Single precision: four lanes per register, float accumulators.
+float sum_neon_ps(const float* x, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vaddq_f32(acc0, vld1q_f32(x + i));
+        acc1 = vaddq_f32(acc1, vld1q_f32(x + i + 4));
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+float center_neon_ps(const float* x, int n, float mean, float* centered) {
+    const float32x4_t m = vdupq_n_f32(mean);
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t lo = vsubq_f32(vld1q_f32(x + i), m);
+        const float32x4_t hi = vsubq_f32(vld1q_f32(x + i + 4), m);
+        vst1q_f32(centered + i, lo);
+        vst1q_f32(centered + i + 4, hi);
+        acc0 = vfmaq_f32(acc0, lo, lo);
+        acc1 = vfmaq_f32(acc1, hi, hi);
+    }
+    float energy = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) {
+        centered[i] = x[i] - mean;
+        energy += centered[i] * centered[i];
+    }
+    return energy;
+}
+
+inline float sum_sq_diff_impl_ps(const float* a, const float* b, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        const float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        const float32x4_t d2 = vsubq_f32(vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        const float32x4_t d3 = vsubq_f32(vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+        acc0 = vfmaq_f32(acc0, d0, d0);
+        acc1 = vfmaq_f32(acc1, d1, d1);
+        acc2 = vfmaq_f32(acc2, d2, d2);
+        acc3 = vfmaq_f32(acc3, d3, d3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc0 = vfmaq_f32(acc0, d0, d0);
+    }
+    float d = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    for (; i < n; ++i) {
+        const float delta = a[i] - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+float sum_sq_diff_neon_ps(const float* a, const float* b, int n) {
+    return sum_sq_diff_impl_ps(a, b, n);
+}
+
+void difference_neon_ps(const float* x, int n, int min_lag, int max_lag, float* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_impl_ps(x, x + lag, n - lag);
+    }
+}
+
+void cmndf_neon_ps(const float* diff, int min_lag, int max_lag, float* cmndf) {
+    cmndf[min_lag] = 1.0f;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t floor = vdupq_n_f32(1e-12f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t step = vdupq_n_f32(4.0f);
+    const float first_lags[4] = {static_cast<float>(min_lag + 1), static_cast<float>(min_lag + 2),
+                                 static_cast<float>(min_lag + 3), static_cast<float>(min_lag + 4)};
+    float32x4_t carry = zero;
+    float32x4_t lags = vld1q_f32(first_lags);
+    int lag = min_lag + 1;
+    for (; lag + 4 <= max_lag + 1; lag += 4) {
+        const float32x4_t d = vld1q_f32(diff + lag);
+        // In-register prefix sum: shift by one lane, then by two.
+        const float32x4_t partial = vaddq_f32(d, vextq_f32(zero, d, 3));
+        const float32x4_t running = vaddq_f32(carry, vaddq_f32(partial, vextq_f32(zero, partial, 2)));
+        const float32x4_t value = vdivq_f32(vmulq_f32(d, lags), running);
+        vst1q_f32(cmndf + lag, vbslq_f32(vcleq_f32(running, floor), one, value));
+        carry = vdupq_laneq_f32(running, 3);
+        lags = vaddq_f32(lags, step);
+    }
+    float running_sum = vgetq_lane_f32(carry, 0);
+    for (; lag <= max_lag; ++lag) {
+        running_sum += diff[lag];
+        cmndf[lag] = running_sum <= 1e-12f ? 1.0f : diff[lag] * static_cast<float>(lag) / running_sum;
+    }
+}
+
+// Batch kernels: the eight lanes of one sample index span four registers.
+void sum_sq_diff_x8_neon(const double* a, const double* b, int n, double* out) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    float64x2_t acc2 = vdupq_n_f64(0.0);
+    float64x2_t acc3 = vdupq_n_f64(0.0);
+    for (int i = 0; i < n; ++i) {
+        const double* pa = a + i * kBatchLanes;
+        const double* pb = b + i * kBatchLanes;
+        const float64x2_t d0 = vsubq_f64(vld1q_f64(pa), vld1q_f64(pb));
+        const float64x2_t d1 = vsubq_f64(vld1q_f64(pa + 2), vld1q_f64(pb + 2));
+        const float64x2_t d2 = vsubq_f64(vld1q_f64(pa + 4), vld1q_f64(pb + 4));
+        const float64x2_t d3 = vsubq_f64(vld1q_f64(pa + 6), vld1q_f64(pb + 6));
+        acc0 = vfmaq_f64(acc0, d0, d0);
+        acc1 = vfmaq_f64(acc1, d1, d1);
+        acc2 = vfmaq_f64(acc2, d2, d2);
+        acc3 = vfmaq_f64(acc3, d3, d3);
+    }
+    vst1q_f64(out, vaddq_f64(vld1q_f64(out), acc0));
+    vst1q_f64(out + 2, vaddq_f64(vld1q_f64(out + 2), acc1));
+    vst1q_f64(out + 4, vaddq_f64(vld1q_f64(out + 4), acc2));
+    vst1q_f64(out + 6, vaddq_f64(vld1q_f64(out + 6), acc3));
+}
+
+void cmndf_x8_neon(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    const float64x2_t floor = vdupq_n_f64(1e-12);
+    const float64x2_t one = vdupq_n_f64(1.0);
+    float64x2_t running[4] = {vdupq_n_f64(0.0), vdupq_n_f64(0.0), vdupq_n_f64(0.0), vdupq_n_f64(0.0)};
+    for (int r = 0; r < 4; ++r) {
+        vst1q_f64(cmndf + min_lag * kBatchLanes + 2 * r, one);
+    }
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        const float64x2_t lag_v = vdupq_n_f64(static_cast<double>(lag));
+        for (int r = 0; r < 4; ++r) {
+            const float64x2_t d = vld1q_f64(diff + lag * kBatchLanes + 2 * r);
+            running[r] = vaddq_f64(running[r], d);
+            const float64x2_t value = vdivq_f64(vmulq_f64(d, lag_v), running[r]);
+            vst1q_f64(cmndf + lag * kBatchLanes + 2 * r, vbslq_f64(vcleq_f64(running[r], floor), one, value));
+        }
+    }
+}
+
+// Shape-specialised difference (see ShapeKernels): each pass over the
+// window serves kShapeLagBlock lags at two vectors a step, so x[i] is loaded
+// once per block and the fused multiply-adds have eight accumulators.
+constexpr int kShapeLagBlock = 4;
+
+template <int N, int MinLag, int MaxLag>
+void difference_shape_neon(const double* x, double* diff) {
+    constexpr int kBlockedEnd = MinLag + (MaxLag - MinLag + 1) / kShapeLagBlock * kShapeLagBlock;
+    for (int lag = MinLag; lag < kBlockedEnd; lag += kShapeLagBlock) {
+        float64x2_t acc[2 * kShapeLagBlock];
+        for (float64x2_t& a : acc) {
+            a = vdupq_n_f64(0.0);
+        }
+        // Every lag of the block has a pair up to the last lag's end.
+        const int shared = N - lag - (kShapeLagBlock - 1);
+        int i = 0;
+        for (; i + 4 <= shared; i += 4) {
+            const float64x2_t a0 = vld1q_f64(x + i);
+            const float64x2_t a1 = vld1q_f64(x + i + 2);
+            for (int k = 0; k < kShapeLagBlock; ++k) {
+                const float64x2_t d0 = vsubq_f64(a0, vld1q_f64(x + i + lag + k));
+                const float64x2_t d1 = vsubq_f64(a1, vld1q_f64(x + i + 2 + lag + k));
+                acc[k] = vfmaq_f64(acc[k], d0, d0);
+                acc[kShapeLagBlock + k] = vfmaq_f64(acc[kShapeLagBlock + k], d1, d1);
+            }
+        }
+        for (int k = 0; k < kShapeLagBlock; ++k) {
+            double d = vaddvq_f64(vaddq_f64(acc[k], acc[kShapeLagBlock + k]));
+            for (int j = i; j < N - lag - k; ++j) {
+                const double delta = x[j] - x[j + lag + k];
+                d += delta * delta;
+            }
+            diff[lag + k] = d;
+        }
+    }
+    for (int lag = kBlockedEnd; lag <= MaxLag; ++lag) {
+        diff[lag] = sum_sq_diff_impl(x, x + lag, N - lag);
+    }
+}
+
+template <int N, int MinLag, int MaxLag>
+void difference_shape_neon_ps(const float* x, float* diff) {
+    constexpr int kBlockedEnd = MinLag + (MaxLag - MinLag + 1) / kShapeLagBlock * kShapeLagBlock;
+    for (int lag = MinLag; lag < kBlockedEnd; lag += kShapeLagBlock) {
+        float32x4_t acc[2 * kShapeLagBlock];
+        for (float32x4_t& a : acc) {
+            a = vdupq_n_f32(0.0f);
+        }
+        const int shared = N - lag - (kShapeLagBlock - 1);
+        int i = 0;
+        for (; i + 8 <= shared; i += 8) {
+            const float32x4_t a0 = vld1q_f32(x + i);
+            const float32x4_t a1 = vld1q_f32(x + i + 4);
+            for (int k = 0; k < kShapeLagBlock; ++k) {
+                const float32x4_t d0 = vsubq_f32(a0, vld1q_f32(x + i + lag + k));
+                const float32x4_t d1 = vsubq_f32(a1, vld1q_f32(x + i + 4 + lag + k));
+                acc[k] = vfmaq_f32(acc[k], d0, d0);
+                acc[kShapeLagBlock + k] = vfmaq_f32(acc[kShapeLagBlock + k], d1, d1);
+            }
+        }
+        for (int k = 0; k < kShapeLagBlock; ++k) {
+            float d = vaddvq_f32(vaddq_f32(acc[k], acc[kShapeLagBlock + k]));
+            for (int j = i; j < N - lag - k; ++j) {
+                const float delta = x[j] - x[j + lag + k];
+                d += delta * delta;
+            }
+            diff[lag + k] = d;
+        }
+    }
+    for (int lag = kBlockedEnd; lag <= MaxLag; ++lag) {
+        diff[lag] = sum_sq_diff_impl_ps(x, x + lag, N - lag);
+    }
+}
+
+struct NeonShapes {
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const double* x, double* diff) {
+        difference_shape_neon<N, MinLag, MaxLag>(x, diff);
+    }
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const float* x, float* diff) {
+        difference_shape_neon_ps<N, MinLag, MaxLag>(x, diff);
+    }
+};
+
+constexpr auto kNeonShapes = make_shape_kernels<NeonShapes>();
+
+const Kernels kNeonKernels = {
+    KernelIsa::kNeon,
+    "neon",
+    {sum_neon, center_neon, sum_sq_diff_neon, sum_sq_diff_f32_neon, difference_neon, cmndf_neon},
+    {sum_neon_ps, center_neon_ps, sum_sq_diff_neon_ps, sum_sq_diff_neon_ps, difference_neon_ps, cmndf_neon_ps},
+    sum_sq_diff_x8_neon,
+    cmndf_x8_neon,
+    kNeonShapes.data(),
+    kKernelShapeCount,
+};
+}  // namespace
+
+const Kernels* neon_kernels() {
+    return &kNeonKernels;
+}
+#else
+const Kernels* neon_kernels() {
+    return nullptr;
+}
+#endif
+
+}  // namespace pt_dsp
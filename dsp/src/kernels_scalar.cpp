@@ -0,0 +1,165 @@
+#include "kernels.h"
+
+namespace pt_dsp {
+namespace {
+template <typename T>
+T sum_scalar(const float* x, int n) {
+    T sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+template <typename T>
+T center_scalar(const float* x, int n, T mean, T* centered) {
+    T energy = 0;
+    for (int i = 0; i < n; ++i) {
+        centered[i] = static_cast<T>(x[i]) - mean;
+        energy += centered[i] * centered[i];
+    }
+    return energy;
+}
+
+template <typename T>
+T sum_sq_diff_scalar(const T* a, const T* b, int n) {
+    T d = 0;
+    for (int i = 0; i < n; ++i) {
+        const T delta = a[i] - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+template <typename T>
+T sum_sq_diff_f32_scalar(const float* a, const float* b, int n) {
+    T d = 0;
+    for (int i = 0; i < n; ++i) {
+        const T delta = static_cast<T>(a[i]) - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+template <typename T>
+void difference_scalar(const T* x, int n, int min_lag, int max_lag, T* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_scalar(x, x + lag, n - lag);
+    }
+}
+
+template <typename T>
+void cmndf_scalar(const T* diff, int min_lag, int max_lag, T* cmndf) {
+    cmndf[min_lag] = 1;
+    T running_sum = 0;
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        running_sum += diff[lag];
+        if (running_sum <= static_cast<T>(1e-12)) {
+            cmndf[lag] = 1;
+            continue;
+        }
+        cmndf[lag] = diff[lag] * static_cast<T>(lag) / running_sum;
+    }
+}
+
+void sum_sq_diff_x8_scalar(const double* a, const double* b, int n, double* out) {
+    double acc[kBatchLanes] = {};
+    for (int i = 0; i < n; ++i) {
+        for (int s = 0; s < kBatchLanes; ++s) {
+            const double delta = a[i * kBatchLanes + s] - b[i * kBatchLanes + s];
+            acc[s] += delta * delta;
+        }
+    }
+    for (int s = 0; s < kBatchLanes; ++s) {
+        out[s] += acc[s];
+    }
+}
+
+void cmndf_x8_scalar(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    double running_sum[kBatchLanes] = {};
+    for (int s = 0; s < kBatchLanes; ++s) {
+        cmndf[min_lag * kBatchLanes + s] = 1.0;
+    }
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        for (int s = 0; s < kBatchLanes; ++s) {
+            const double d = diff[lag * kBatchLanes + s];
+            running_sum[s] += d;
+            cmndf[lag * kBatchLanes + s] =
+                running_sum[s] <= 1e-12 ? 1.0 : d * static_cast<double>(lag) / running_sum[s];
+        }
+    }
+}
+
+// difference_scalar for one KernelShape. Each pass over the window serves
+// kLagBlock lags, loading every x[i] once for all of them and adding into
+// independent accumulators. Each lag still sums in index order, so the
+// result is bit-identical to difference_scalar.
+template <typename T, int N, int MinLag, int MaxLag>
+void difference_shape_scalar(const T* x, T* diff) {
+    constexpr int kLagBlock = 4;
+    constexpr int kBlockedEnd = MinLag + (MaxLag - MinLag + 1) / kLagBlock * kLagBlock;
+    for (int lag = MinLag; lag < kBlockedEnd; lag += kLagBlock) {
+        T acc[kLagBlock] = {};
+        // Every lag of the block has a pair up to the last lag's end.
+        const int shared = N - lag - (kLagBlock - 1);
+        for (int i = 0; i < shared; ++i) {
+            for (int k = 0; k < kLagBlock; ++k) {
+                const T delta = x[i] - x[i + lag + k];
+                acc[k] += delta * delta;
+            }
+        }
+        for (int k = 0; k < kLagBlock; ++k) {
+            for (int i = shared; i < N - lag - k; ++i) {
+                const T delta = x[i] - x[i + lag + k];
+                acc[k] += delta * delta;
+            }
+            diff[lag + k] = acc[k];
+        }
+    }
+    for (int lag = kBlockedEnd; lag <= MaxLag; ++lag) {
+        diff[lag] = sum_sq_diff_scalar(x, x + lag, N - lag);
+    }
+}
+
+struct ScalarShapes {
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const double* x, double* diff) {
+        difference_shape_scalar<double, N, MinLag, MaxLag>(x, diff);
+    }
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const float* x, float* diff) {
+        difference_shape_scalar<float, N, MinLag, MaxLag>(x, diff);
+    }
+};
+
+constexpr auto kScalarShapes = make_shape_kernels<ScalarShapes>();
+
+template <typename T>
+constexpr KernelOps<T> scalar_ops() {
+    return {
+        sum_scalar<T>,
+        center_scalar<T>,
+        sum_sq_diff_scalar<T>,
+        sum_sq_diff_f32_scalar<T>,
+        difference_scalar<T>,
+        cmndf_scalar<T>,
+    };
+}
+
+const Kernels kScalarKernels = {
+    KernelIsa::kScalar,
+    "scalar",
+    scalar_ops<double>(),
+    scalar_ops<float>(),
+    sum_sq_diff_x8_scalar,
+    cmndf_x8_scalar,
+    kScalarShapes.data(),
+    kKernelShapeCount,
+};
+}  // namespace
+
+const Kernels& scalar_kernels() {
+    return kScalarKernels;
+}
+
+}  // namespace pt_dsp
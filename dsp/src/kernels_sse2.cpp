@@ -0,0 +1,378 @@
+#include "kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PT_DSP_SSE2_KERNELS 1
+#include <emmintrin.h>
+#endif
+
+namespace pt_dsp {
+
+#if PT_DSP_SSE2_KERNELS
+namespace {
+inline double hsum(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+double sum_sse2(const float* x, int n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(v));
+        acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    double sum = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+double center_sse2(const float* x, int n, double mean, double* centered) {
+    const __m128d m = _mm_set1_pd(mean);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        const __m128d lo = _mm_sub_pd(_mm_cvtps_pd(v), m);
+        const __m128d hi = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), m);
+        _mm_storeu_pd(centered + i, lo);
+        _mm_storeu_pd(centered + i + 2, hi);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(lo, lo));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(hi, hi));
+    }
+    double energy = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) {
+        centered[i] = static_cast<double>(x[i]) - mean;
+        energy += centered[i] * centered[i];
+    }
+    return energy;
+}
+
+double sum_sq_diff_sse2(const double* a, const double* b, int n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128d d0 = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+        const __m128d d1 = _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    double d = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) {
+        const double delta = a[i] - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+double sum_sq_diff_f32_sse2(const float* a, const float* b, int n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 va = _mm_loadu_ps(a + i);
+        const __m128 vb = _mm_loadu_ps(b + i);
+        const __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(va), _mm_cvtps_pd(vb));
+        const __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(va, va)), _mm_cvtps_pd(_mm_movehl_ps(vb, vb)));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    double d = hsum(_mm_add_pd(acc0, acc1));
+    for (; i < n; ++i) {
+        const double delta = static_cast<double>(a[i]) - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+void difference_sse2(const double* x, int n, int min_lag, int max_lag, double* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_sse2(x, x + lag, n - lag);
+    }
+}
+
+void cmndf_sse2(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    cmndf[min_lag] = 1.0;
+    const __m128d floor = _mm_set1_pd(1e-12);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d step = _mm_set1_pd(2.0);
+    __m128d carry = _mm_setzero_pd();
+    __m128d lags = _mm_set_pd(static_cast<double>(min_lag + 2), static_cast<double>(min_lag + 1));
+    int lag = min_lag + 1;
+    for (; lag + 2 <= max_lag + 1; lag += 2) {
+        const __m128d d = _mm_loadu_pd(diff + lag);
+        // In-register prefix sum: [d0, d0 + d1] on top of the running total.
+        const __m128d running = _mm_add_pd(carry, _mm_add_pd(d, _mm_unpacklo_pd(_mm_setzero_pd(), d)));
+        const __m128d value = _mm_div_pd(_mm_mul_pd(d, lags), running);
+        const __m128d tiny = _mm_cmple_pd(running, floor);
+        _mm_storeu_pd(cmndf + lag, _mm_or_pd(_mm_and_pd(tiny, one), _mm_andnot_pd(tiny, value)));
+        carry = _mm_unpackhi_pd(running, running);
+        lags = _mm_add_pd(lags, step);
+    }
+    double running_sum = _mm_cvtsd_f64(carry);
+    for (; lag <= max_lag; ++lag) {
+        running_sum += diff[lag];
+        cmndf[lag] = running_sum <= 1e-12 ? 1.0 : diff[lag] * static_cast<double>(lag) / running_sum;
+    }
+}
+
+// Single precision: four lanes per register, float accumulators.
+inline float hsum_ps(__m128 v) {
+    const __m128 pair = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 0x55)));
+}
+
+float sum_sse2_ps(const float* x, int n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_loadu_ps(x + i));
+        acc1 = _mm_add_ps(acc1, _mm_loadu_ps(x + i + 4));
+    }
+    float sum = hsum_ps(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+float center_sse2_ps(const float* x, int n, float mean, float* centered) {
+    const __m128 m = _mm_set1_ps(mean);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 lo = _mm_sub_ps(_mm_loadu_ps(x + i), m);
+        const __m128 hi = _mm_sub_ps(_mm_loadu_ps(x + i + 4), m);
+        _mm_storeu_ps(centered + i, lo);
+        _mm_storeu_ps(centered + i + 4, hi);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(lo, lo));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(hi, hi));
+    }
+    float energy = hsum_ps(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        centered[i] = x[i] - mean;
+        energy += centered[i] * centered[i];
+    }
+    return energy;
+}
+
+float sum_sq_diff_sse2_ps(const float* a, const float* b, int n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    if (i + 4 <= n) {
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        i += 4;
+    }
+    float d = hsum_ps(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        const float delta = a[i] - b[i];
+        d += delta * delta;
+    }
+    return d;
+}
+
+void difference_sse2_ps(const float* x, int n, int min_lag, int max_lag, float* diff) {
+    for (int lag = min_lag; lag <= max_lag; ++lag) {
+        diff[lag] = sum_sq_diff_sse2_ps(x, x + lag, n - lag);
+    }
+}
+
+inline __m128 shift_lanes_up_ps(__m128 v, int lanes) {
+    return lanes == 1 ? _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4))
+                      : _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8));
+}
+
+void cmndf_sse2_ps(const float* diff, int min_lag, int max_lag, float* cmndf) {
+    cmndf[min_lag] = 1.0f;
+    const __m128 floor = _mm_set1_ps(1e-12f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 step = _mm_set1_ps(4.0f);
+    __m128 carry = _mm_setzero_ps();
+    __m128 lags = _mm_set_ps(static_cast<float>(min_lag + 4), static_cast<float>(min_lag + 3),
+                             static_cast<float>(min_lag + 2), static_cast<float>(min_lag + 1));
+    int lag = min_lag + 1;
+    for (; lag + 4 <= max_lag + 1; lag += 4) {
+        const __m128 d = _mm_loadu_ps(diff + lag);
+        // In-register prefix sum: shift by one lane, then by two.
+        const __m128 partial = _mm_add_ps(d, shift_lanes_up_ps(d, 1));
+        const __m128 running = _mm_add_ps(carry, _mm_add_ps(partial, shift_lanes_up_ps(partial, 2)));
+        const __m128 value = _mm_div_ps(_mm_mul_ps(d, lags), running);
+        const __m128 tiny = _mm_cmple_ps(running, floor);
+        _mm_storeu_ps(cmndf + lag, _mm_or_ps(_mm_and_ps(tiny, one), _mm_andnot_ps(tiny, value)));
+        carry = _mm_shuffle_ps(running, running, 0xFF);
+        lags = _mm_add_ps(lags, step);
+    }
+    float running_sum = _mm_cvtss_f32(carry);
+    for (; lag <= max_lag; ++lag) {
+        running_sum += diff[lag];
+        cmndf[lag] = running_sum <= 1e-12f ? 1.0f : diff[lag] * static_cast<float>(lag) / running_sum;
+    }
+}
+
+// Batch kernels: the eight lanes of one sample index span four registers.
+void sum_sq_diff_x8_sse2(const double* a, const double* b, int n, double* out) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+    for (int i = 0; i < n; ++i) {
+        const double* pa = a + i * kBatchLanes;
+        const double* pb = b + i * kBatchLanes;
+        const __m128d d0 = _mm_sub_pd(_mm_loadu_pd(pa), _mm_loadu_pd(pb));
+        const __m128d d1 = _mm_sub_pd(_mm_loadu_pd(pa + 2), _mm_loadu_pd(pb + 2));
+        const __m128d d2 = _mm_sub_pd(_mm_loadu_pd(pa + 4), _mm_loadu_pd(pb + 4));
+        const __m128d d3 = _mm_sub_pd(_mm_loadu_pd(pa + 6), _mm_loadu_pd(pb + 6));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(d2, d2));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(d3, d3));
+    }
+    _mm_storeu_pd(out, _mm_add_pd(_mm_loadu_pd(out), acc0));
+    _mm_storeu_pd(out + 2, _mm_add_pd(_mm_loadu_pd(out + 2), acc1));
+    _mm_storeu_pd(out + 4, _mm_add_pd(_mm_loadu_pd(out + 4), acc2));
+    _mm_storeu_pd(out + 6, _mm_add_pd(_mm_loadu_pd(out + 6), acc3));
+}
+
+void cmndf_x8_sse2(const double* diff, int min_lag, int max_lag, double* cmndf) {
+    const __m128d floor = _mm_set1_pd(1e-12);
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d running[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    for (int r = 0; r < 4; ++r) {
+        _mm_storeu_pd(cmndf + min_lag * kBatchLanes + 2 * r, one);
+    }
+    for (int lag = min_lag + 1; lag <= max_lag; ++lag) {
+        const __m128d lag_v = _mm_set1_pd(static_cast<double>(lag));
+        for (int r = 0; r < 4; ++r) {
+            const __m128d d = _mm_loadu_pd(diff + lag * kBatchLanes + 2 * r);
+            running[r] = _mm_add_pd(running[r], d);
+            const __m128d value = _mm_div_pd(_mm_mul_pd(d, lag_v), running[r]);
+            const __m128d tiny = _mm_cmple_pd(running[r], floor);
+            _mm_storeu_pd(cmndf + lag * kBatchLanes + 2 * r,
+                          _mm_or_pd(_mm_and_pd(tiny, one), _mm_andnot_pd(tiny, value)));
+        }
+    }
+}
+
+// Shape-specialised difference (see ShapeKernels): each pass over the
+// window serves kShapeLagBlock lags at two vectors a step, sharing the loads
+// of x[i] and keeping eight independent accumulators.
+constexpr int kShapeLagBlock = 4;
+
+template <int N, int MinLag, int MaxLag>
+void difference_shape_sse2(const double* x, double* diff) {
+    constexpr int kBlockedEnd = MinLag + (MaxLag - MinLag + 1) / kShapeLagBlock * kShapeLagBlock;
+    for (int lag = MinLag; lag < kBlockedEnd; lag += kShapeLagBlock) {
+        __m128d acc[2 * kShapeLagBlock];
+        for (__m128d& a : acc) {
+            a = _mm_setzero_pd();
+        }
+        // Every lag of the block has a pair up to the last lag's end.
+        const int shared = N - lag - (kShapeLagBlock - 1);
+        int i = 0;
+        for (; i + 4 <= shared; i += 4) {
+            const __m128d a0 = _mm_loadu_pd(x + i);
+            const __m128d a1 = _mm_loadu_pd(x + i + 2);
+            for (int k = 0; k < kShapeLagBlock; ++k) {
+                const __m128d d0 = _mm_sub_pd(a0, _mm_loadu_pd(x + i + lag + k));
+                const __m128d d1 = _mm_sub_pd(a1, _mm_loadu_pd(x + i + 2 + lag + k));
+                acc[k] = _mm_add_pd(acc[k], _mm_mul_pd(d0, d0));
+                acc[kShapeLagBlock + k] = _mm_add_pd(acc[kShapeLagBlock + k], _mm_mul_pd(d1, d1));
+            }
+        }
+        for (int k = 0; k < kShapeLagBlock; ++k) {
+            double d = hsum(_mm_add_pd(acc[k], acc[kShapeLagBlock + k]));
+            for (int j = i; j < N - lag - k; ++j) {
+                const double delta = x[j] - x[j + lag + k];
+                d += delta * delta;
+            }
+            diff[lag + k] = d;
+        }
+    }
+    for (int lag = kBlockedEnd; lag <= MaxLag; ++lag) {
+        diff[lag] = sum_sq_diff_sse2(x, x + lag, N - lag);
+    }
+}
+
+template <int N, int MinLag, int MaxLag>
+void difference_shape_sse2_ps(const float* x, float* diff) {
+    constexpr int kBlockedEnd = MinLag + (MaxLag - MinLag + 1) / kShapeLagBlock * kShapeLagBlock;
+    for (int lag = MinLag; lag < kBlockedEnd; lag += kShapeLagBlock) {
+        __m128 acc[2 * kShapeLagBlock];
+        for (__m128& a : acc) {
+            a = _mm_setzero_ps();
+        }
+        const int shared = N - lag - (kShapeLagBlock - 1);
+        int i = 0;
+        for (; i + 8 <= shared; i += 8) {
+            const __m128 a0 = _mm_loadu_ps(x + i);
+            const __m128 a1 = _mm_loadu_ps(x + i + 4);
+            for (int k = 0; k < kShapeLagBlock; ++k) {
+                const __m128 d0 = _mm_sub_ps(a0, _mm_loadu_ps(x + i + lag + k));
+                const __m128 d1 = _mm_sub_ps(a1, _mm_loadu_ps(x + i + 4 + lag + k));
+                acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(d0, d0));
+                acc[kShapeLagBlock + k] = _mm_add_ps(acc[kShapeLagBlock + k], _mm_mul_ps(d1, d1));
+            }
+        }
+        for (int k = 0; k < kShapeLagBlock; ++k) {
+            float d = hsum_ps(_mm_add_ps(acc[k], acc[kShapeLagBlock + k]));
+            for (int j = i; j < N - lag - k; ++j) {
+                const float delta = x[j] - x[j + lag + k];
+                d += delta * delta;
+            }
+            diff[lag + k] = d;
+        }
+    }
+    for (int lag = kBlockedEnd; lag <= MaxLag; ++lag) {
+        diff[lag] = sum_sq_diff_sse2_ps(x, x + lag, N - lag);
+    }
+}
+
+struct Sse2Shapes {
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const double* x, double* diff) {
+        difference_shape_sse2<N, MinLag, MaxLag>(x, diff);
+    }
+    template <int N, int MinLag, int MaxLag>
+    static void difference(const float* x, float* diff) {
+        difference_shape_sse2_ps<N, MinLag, MaxLag>(x, diff);
+    }
+};
+
+constexpr auto kSse2Shapes = make_shape_kernels<Sse2Shapes>();
+
+const Kernels kSse2Kernels = {
+    KernelIsa::kSse2,
+    "sse2",
+    {sum_sse2, center_sse2, sum_sq_diff_sse2, sum_sq_diff_f32_sse2, difference_sse2, cmndf_sse2},
+    {sum_sse2_ps, center_sse2_ps, sum_sq_diff_sse2_ps, sum_sq_diff_sse2_ps, difference_sse2_ps, cmndf_sse2_ps},
+    sum_sq_diff_x8_sse2,
+    cmndf_x8_sse2,
+    kSse2Shapes.data(),
+    kKernelShapeCount,
+};
+}  // namespace
+
+const Kernels* sse2_kernels() {
+    return &kSse2Kernels;
+}
+#else
+const Kernels* sse2_kernels() {
+    return nullptr;
+}
+#endif
+
+}  // namespace pt_dsp
@@ -0,0 +1,57 @@
+#include "latency_histogram.h"
+
+namespace pt_dsp {
+namespace {
+uint64_t take(std::atomic<uint64_t>& counter, bool reset) {
+    return reset ? counter.exchange(0, std::memory_order_relaxed) : counter.load(std::memory_order_relaxed);
+}
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : calls_(0), total_ns_(0), max_ns_(0) {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::snapshot(DSPTimingStats* out, bool reset) {
+    out->calls = take(calls_, reset);
+    out->total_ns = take(total_ns_, reset);
+    out->max_ns = take(max_ns_, reset);
+    for (int i = 0; i < PT_DSP_TIMING_BUCKETS; ++i) {
+        out->histogram[i] = take(buckets_[i], reset);
+    }
+}
+
+}  // namespace pt_dsp
+
+uint64_t pt_dsp_timing_bucket_lower_ns(int bucket) {
+    if (bucket <= 0) {
+        return 0;
+    }
+    bucket = std::min(bucket, PT_DSP_TIMING_BUCKETS - 1);
+    return static_cast<uint64_t>(4 + bucket % 4) << (5 + bucket / 4);
+}
+
+uint64_t pt_dsp_timing_percentile_ns(const DSPTimingStats* stats, double fraction) {
+    if (!stats) {
+        return 0;
+    }
+    uint64_t total = 0;
+    for (uint64_t count : stats->histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total);
+    uint64_t seen = 0;
+    for (int i = 0; i < PT_DSP_TIMING_BUCKETS; ++i) {
+        seen += stats->histogram[i];
+        if (seen > 0 && static_cast<double>(seen) >= rank) {
+            const uint64_t upper =
+                i + 1 < PT_DSP_TIMING_BUCKETS ? pt_dsp_timing_bucket_lower_ns(i + 1) : stats->max_ns;
+            return stats->max_ns > 0 ? std::min(upper, stats->max_ns) : upper;
+        }
+    }
+    return stats->max_ns;
+}
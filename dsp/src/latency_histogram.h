@@ -0,0 +1,52 @@
+#pragma once
+
+#include "pt_dsp/dsp_api.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace pt_dsp {
+
+// Histogram bucket of a duration: four log-spaced buckets per octave from
+// 128 ns, with everything below 160 ns in bucket 0 and the top bucket open.
+inline int latency_bucket(uint64_t ns) {
+    if (ns < 128) {
+        return 0;
+    }
+    const int octave = 63 - __builtin_clzll(ns);
+    const int quarter = static_cast<int>((ns >> (octave - 2)) & 3);
+    return std::min(PT_DSP_TIMING_BUCKETS - 1, 4 * (octave - 7) + quarter);
+}
+
+// Call timing written by one realtime thread and read by any other. The
+// writer only issues relaxed atomic adds (plus a compare-exchange when a new
+// maximum is seen), so it never blocks and never waits on a reader.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t ns) {
+        calls_.fetch_add(1, std::memory_order_relaxed);
+        total_ns_.fetch_add(ns, std::memory_order_relaxed);
+        buckets_[latency_bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = max_ns_.load(std::memory_order_relaxed);
+        while (ns > seen && !max_ns_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Copies the counters into out, swapping each for zero when reset is set.
+    void snapshot(DSPTimingStats* out, bool reset);
+
+private:
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "timing counters must be lock-free");
+
+    std::atomic<uint64_t> calls_;
+    std::atomic<uint64_t> total_ns_;
+    std::atomic<uint64_t> max_ns_;
+    std::atomic<uint64_t> buckets_[PT_DSP_TIMING_BUCKETS];
+};
+
+}  // namespace pt_dsp
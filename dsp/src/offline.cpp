@@ -0,0 +1,174 @@
+#include "pt_dsp/dsp_api.h"
+
+#include "dsp_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+// Automatic chunking aims for this many chunks per thread, so threads that
+// finish early pick up the remaining chunks and stitching can start while
+// later chunks are still being analysed.
+constexpr int kChunksPerThread = 4;
+// Shortest automatic chunk, in hops. Each chunk pays for a fresh instance
+// and one replayed window.
+constexpr int64_t kMinChunkHops = 256;
+// Hops handed to push_periods per call.
+constexpr int kPushHops = 64;
+
+struct DspDeleter {
+    void operator()(PT_DSP* dsp) const { pt_dsp_destroy(dsp); }
+};
+using DspPtr = std::unique_ptr<PT_DSP, DspDeleter>;
+
+// Writes period estimates for hops [first_frame, end_frame) of the stream.
+// A fresh instance first replays the hops whose samples fall in the window of
+// first_frame, or in the decimation filter ahead of it, so every kept
+// estimate sees the same input as a sequential run would.
+bool estimate_chunk(const DSPConfig& cfg, const float* samples, int64_t first_frame, int64_t end_frame,
+                    pt_dsp::PeriodEstimate* out) {
+    DspPtr dsp(pt_dsp_create(cfg));
+    if (!dsp) {
+        return false;
+    }
+    const int hop = cfg.hop_size;
+    const int warmup_hops = (pt_dsp::warmup_samples(dsp.get()) + hop - 1) / hop;
+    int64_t frame = std::max<int64_t>(0, first_frame - warmup_hops);
+    pt_dsp::set_stream_origin(dsp.get(), frame * hop);
+    pt_dsp::PeriodEstimate discarded[kPushHops];
+    while (frame < end_frame) {
+        const bool warming_up = frame < first_frame;
+        const int64_t stop = warming_up ? first_frame : end_frame;
+        const int hops = static_cast<int>(std::min<int64_t>(kPushHops, stop - frame));
+        pt_dsp::PeriodEstimate* dst = warming_up ? discarded : out + frame;
+        if (pt_dsp::push_periods(dsp.get(), samples + frame * hop, hops * hop, dst, hops) != hops) {
+            return false;
+        }
+        frame += hops;
+    }
+    return true;
+}
+
+// Chunk bookkeeping shared by the calling thread and its helpers.
+struct ChunkQueue {
+    int64_t chunk_count = 0;
+    std::atomic<int64_t> next{0};
+    std::atomic<bool> failed{false};
+    std::unique_ptr<bool[]> done;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    // Claims and analyses the next chunk. Returns false when none are left.
+    template <typename Fn>
+    bool run_one(Fn&& analyze) {
+        const int64_t c = next.fetch_add(1);
+        if (c >= chunk_count) {
+            return false;
+        }
+        if (!failed.load(std::memory_order_relaxed) && !analyze(c)) {
+            failed.store(true);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done[c] = true;
+        }
+        finished.notify_all();
+        return true;
+    }
+};
+}  // namespace
+
+int64_t pt_dsp_analyze_offline(DSPConfig cfg, const float* mono_samples, int64_t num_samples, int num_threads,
+                               int chunk_frames, DSPFrameOutput* out_frames, int64_t max_frames) {
+    if (!mono_samples || num_samples < 0 || !out_frames || max_frames < 0) {
+        return -1;
+    }
+    // Chunk instances never see tracking state, so the tracked lag search
+    // could not narrow anything there.
+    if (cfg.lag_search == PT_DSP_LAG_SEARCH_TRACKED) {
+        cfg.lag_search = PT_DSP_LAG_SEARCH_FULL;
+    }
+    // Tracking and history run on this instance, one chunk at a time in stream
+    // order, so they see exactly the sequence a single pt_dsp_push would.
+    DspPtr tracker(pt_dsp_create(cfg));
+    if (!tracker) {
+        return -1;
+    }
+    cfg = pt_dsp::resolved_config(tracker.get());
+    const int hop = cfg.hop_size;
+    const int64_t total_frames = std::min(num_samples / hop, max_frames);
+    if (total_frames == 0) {
+        return 0;
+    }
+    if (num_threads <= 0) {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    int64_t chunk = chunk_frames;
+    if (chunk <= 0) {
+        chunk = std::max(kMinChunkHops, total_frames / (static_cast<int64_t>(num_threads) * kChunksPerThread));
+    }
+
+    ChunkQueue queue;
+    queue.chunk_count = (total_frames + chunk - 1) / chunk;
+    queue.done.reset(new (std::nothrow) bool[queue.chunk_count]());
+    std::unique_ptr<pt_dsp::PeriodEstimate[]> estimates(new (std::nothrow) pt_dsp::PeriodEstimate[total_frames]);
+    if (!queue.done || !estimates) {
+        return -1;
+    }
+    auto analyze = [&](int64_t c) {
+        const int64_t first = c * chunk;
+        return estimate_chunk(cfg, mono_samples, first, std::min(total_frames, first + chunk), estimates.get());
+    };
+
+    std::vector<std::thread> helpers;
+    const int64_t helper_count = std::min<int64_t>(num_threads, queue.chunk_count) - 1;
+    for (int64_t t = 0; t < helper_count; ++t) {
+        // Chunks no helper picks up are analysed by the calling thread below.
+        try {
+            helpers.emplace_back([&]() {
+                while (queue.run_one(analyze)) {
+                }
+            });
+        } catch (const std::exception&) {
+            break;
+        }
+    }
+
+    // Stitch chunks in order as they complete, analysing unclaimed chunks
+    // while the next one to stitch is still in progress.
+    for (int64_t c = 0; c < queue.chunk_count && !queue.failed.load(); ++c) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                if (queue.done[c]) {
+                    break;
+                }
+            }
+            if (!queue.run_one(analyze)) {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                queue.finished.wait(lock, [&]() { return queue.done[c]; });
+                break;
+            }
+        }
+        if (queue.failed.load()) {
+            break;
+        }
+        const int64_t end = std::min(total_frames, (c + 1) * chunk);
+        for (int64_t f = c * chunk; f < end; ++f) {
+            out_frames[f] = pt_dsp::finish_period(tracker.get(), estimates[f]);
+        }
+    }
+    // After a failure helpers drain the queue without analysing.
+    for (std::thread& t : helpers) {
+        t.join();
+    }
+    return queue.failed.load() ? -1 : total_frames;
+}
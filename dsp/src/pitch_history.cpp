@@ -0,0 +1,120 @@
+#include "pitch_history.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace pt_dsp {
+namespace {
+// Reference for the log-frequency sums. Any value works; one inside the
+// voice range keeps the squares small next to the spreads they resolve.
+constexpr double kLogReferenceHz = 440.0;
+// An entry changes side only once it is this far past the mean, so pitch
+// jitter around the mean does not count as vibrato cycles.
+constexpr double kCrossingHysteresisCents = 1.0;
+}  // namespace
+
+void PitchHistory::clear() {
+    *this = PitchHistory();
+}
+
+void PitchHistory::push(double cents_error, double freq_hz, double time_ms) {
+    if (count_ == kPitchHistorySize) {
+        pop_oldest();
+    }
+    const int64_t seq = next_seq_++;
+    Entry& e = entries_[slot(seq)];
+    e.cents = cents_error;
+    e.freq_hz = freq_hz;
+    e.log_cents = 1200.0 * std::log2(freq_hz / kLogReferenceHz);
+    e.time_ms = time_ms;
+    ++count_;
+    sum_cents_ += e.cents;
+    sum_freq_ += e.freq_hz;
+    sum_log_ += e.log_cents;
+    sum_log_sq_ += e.log_cents * e.log_cents;
+
+    while (min_cents_.len > 0 && at(min_cents_.back()).cents >= cents_error) {
+        min_cents_.pop_back();
+    }
+    min_cents_.push_back(seq);
+    while (max_cents_.len > 0 && at(max_cents_.back()).cents <= cents_error) {
+        max_cents_.pop_back();
+    }
+    max_cents_.push_back(seq);
+
+    const double centered = cents_error - sum_cents_ / static_cast<double>(count_);
+    const int side = centered > kCrossingHysteresisCents    ? 1
+                     : centered < -kCrossingHysteresisCents ? -1
+                                                            : last_side_;
+    e.crosses = count_ > 1 && last_side_ != 0 && side != last_side_;
+    crossings_ += e.crosses ? 1 : 0;
+    last_side_ = side;
+
+    if (next_seq_ % kPitchHistorySize == 0) {
+        resum();
+    }
+}
+
+void PitchHistory::pop_oldest() {
+    const int64_t oldest = next_seq_ - count_;
+    const Entry& e = at(oldest);
+    sum_cents_ -= e.cents;
+    sum_freq_ -= e.freq_hz;
+    sum_log_ -= e.log_cents;
+    sum_log_sq_ -= e.log_cents * e.log_cents;
+    --count_;
+    if (min_cents_.front() == oldest) {
+        min_cents_.pop_front();
+    }
+    if (max_cents_.front() == oldest) {
+        max_cents_.pop_front();
+    }
+    // The pair of the oldest entry and the next one leaves with it.
+    if (count_ > 0) {
+        Entry& next = entries_[slot(oldest + 1)];
+        crossings_ -= next.crosses ? 1 : 0;
+        next.crosses = false;
+    }
+}
+
+void PitchHistory::resum() {
+    sum_cents_ = 0.0;
+    sum_freq_ = 0.0;
+    sum_log_ = 0.0;
+    sum_log_sq_ = 0.0;
+    for (int64_t seq = next_seq_ - count_; seq < next_seq_; ++seq) {
+        const Entry& e = at(seq);
+        sum_cents_ += e.cents;
+        sum_freq_ += e.freq_hz;
+        sum_log_ += e.log_cents;
+        sum_log_sq_ += e.log_cents * e.log_cents;
+    }
+}
+
+double PitchHistory::frequency_rms_cents() const {
+    // Around the mean log frequency the squares sum to the spread; the mean
+    // frequency sits off that mean by offset and adds offset^2 per entry.
+    const double n = static_cast<double>(count_);
+    const double mean_log = sum_log_ / n;
+    const double spread = std::max(0.0, sum_log_sq_ / n - mean_log * mean_log);
+    const double offset = mean_log - 1200.0 * std::log2(sum_freq_ / n / kLogReferenceHz);
+    return std::sqrt(spread + offset * offset);
+}
+
+double PitchHistory::min_cents() const {
+    return at(min_cents_.front()).cents;
+}
+
+double PitchHistory::max_cents() const {
+    return at(max_cents_.front()).cents;
+}
+
+double PitchHistory::oldest_time_ms() const {
+    return at(next_seq_ - count_).time_ms;
+}
+
+double PitchHistory::newest_time_ms() const {
+    return at(next_seq_ - 1).time_ms;
+}
+
+}  // namespace pt_dsp
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace pt_dsp {
+
+constexpr int kPitchHistorySize = 64;
+
+// The last kPitchHistorySize voiced frames, with the statistics that the
+// stability confidence and the vibrato estimate read kept up to date as
+// frames enter and leave. Pushes and queries are O(1) whatever the window
+// size:
+//   - running sums of frequency and of log frequency (in cents) and its
+//     square, for the spread of the window around its mean frequency;
+//   - monotonic deques of cents error for the window minimum and maximum;
+//   - how many neighbouring entries sit on opposite sides of the mean cents
+//     error, each entry's side being taken against the window mean when it
+//     was pushed (the window's final mean is not known until it is read).
+// The running sums are recomputed from the entries once every
+// kPitchHistorySize pushes, so rounding from adding and removing entries
+// never builds up. Nothing allocates or locks.
+class PitchHistory {
+public:
+    void clear();
+    void push(double cents_error, double freq_hz, double time_ms);
+
+    int size() const { return count_; }
+    // RMS distance, in cents, of the entries' frequencies from their mean
+    // frequency. size() must be positive.
+    double frequency_rms_cents() const;
+    double min_cents() const;
+    double max_cents() const;
+    double oldest_time_ms() const;
+    double newest_time_ms() const;
+    // Sign changes of the cents error about its mean between neighbouring
+    // entries. Entries within a cent of the mean take the previous entry's
+    // side.
+    int mean_crossings() const { return crossings_; }
+
+private:
+    struct Entry {
+        double cents = 0.0;
+        double freq_hz = 0.0;
+        double log_cents = 0.0;  // frequency in cents above kLogReferenceHz
+        double time_ms = 0.0;
+        bool crosses = false;  // on the other side of the mean from the entry before
+    };
+
+    // Sequence numbers of entries whose cents error is a running minimum
+    // (or maximum), oldest first; a ring since it never holds more entries
+    // than the window.
+    struct ExtremaDeque {
+        std::array<int64_t, kPitchHistorySize> seq{};
+        int head = 0;
+        int len = 0;
+
+        int64_t front() const { return seq[head]; }
+        int64_t back() const { return seq[(head + len - 1) % kPitchHistorySize]; }
+        void pop_front() {
+            head = head + 1 == kPitchHistorySize ? 0 : head + 1;
+            --len;
+        }
+        void pop_back() { --len; }
+        void push_back(int64_t s) {
+            seq[(head + len) % kPitchHistorySize] = s;
+            ++len;
+        }
+    };
+
+    static int slot(int64_t seq) { return static_cast<int>(static_cast<uint64_t>(seq) % kPitchHistorySize); }
+    const Entry& at(int64_t seq) const { return entries_[slot(seq)]; }
+    void pop_oldest();
+    void resum();
+
+    std::array<Entry, kPitchHistorySize> entries_{};
+    int count_ = 0;
+    int64_t next_seq_ = 0;  // sequence number of the next push
+    double sum_cents_ = 0.0;
+    double sum_freq_ = 0.0;
+    double sum_log_ = 0.0;
+    double sum_log_sq_ = 0.0;
+    ExtremaDeque min_cents_;
+    ExtremaDeque max_cents_;
+    int crossings_ = 0;
+    int last_side_ = 0;  // side of the newest entry: -1, +1, or 0 before any off the mean
+};
+
+}  // namespace pt_dsp
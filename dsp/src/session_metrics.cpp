@@ -0,0 +1,332 @@
+#include "pt_dsp/session_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+namespace {
+constexpr int kWindow = PT_DSP_SESSION_METRICS_WINDOW;
+constexpr size_t kSnapshotWords = (sizeof(PTSessionMetrics) + 7) / 8;
+
+// A frame as the Dart side sees it after NativeAudioBridge normalises it.
+struct BridgeFrame {
+    int64_t timestamp_ms;
+    bool usable_pitch;
+    double cents_error;
+    double confidence;
+    bool vibrato_qualified;
+    double vibrato_rate_hz;
+    double vibrato_depth_cents;
+};
+
+BridgeFrame bridge_frame(const DSPFrameOutput& f) {
+    BridgeFrame b;
+    b.timestamp_ms = static_cast<int64_t>(f.timestamp_ms);
+    b.usable_pitch = std::isfinite(f.freq_hz) && std::isfinite(f.cents_error) && f.nearest_midi >= 0;
+    b.cents_error = f.cents_error;
+    b.confidence = std::isfinite(f.confidence) ? f.confidence : 0.0;
+    b.vibrato_qualified = f.vibrato_detected && std::isfinite(f.vibrato_rate_hz) &&
+                          std::isfinite(f.vibrato_depth_cents);
+    b.vibrato_rate_hz = f.vibrato_rate_hz;
+    b.vibrato_depth_cents = f.vibrato_depth_cents;
+    return b;
+}
+
+struct WindowEntry {
+    int64_t timestamp_ms;
+    double cents_error;
+};
+}  // namespace
+
+struct PT_SESSION_METRICS {
+    PTSessionMetricsConfig cfg;
+
+    // TrainingEngine state.
+    PTSessionState state;
+    PTSessionState return_state;  // where low confidence hands back to
+    bool has_last;
+    int64_t last_ms;
+    int64_t countdown_remaining_ms;
+    int64_t within_tolerance_ms;
+    int64_t outside_drift_ms;
+    int64_t locked_time_ms;
+    double effective_error;  // of the current UI state; NaN when it has none
+    WindowEntry window[kWindow];
+    int window_head;
+    int window_size;
+
+    // LiveSessionCoordinator accumulators; the error statistics are Welford
+    // running moments.
+    int64_t drift_count;
+    int64_t active_ms;
+    int64_t locked_ms;
+    uint64_t frames;
+    uint64_t error_count;
+    double abs_error_sum;
+    double error_mean;
+    double error_m2;
+
+    // Last snapshot, published seqlock-style: seq is odd while it is written.
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> snapshot[kSnapshotWords];
+};
+
+namespace {
+double clamp_cents(const PT_SESSION_METRICS* m, double cents) {
+    return std::min(std::max(cents, -m->cfg.cents_error_clamp), m->cfg.cents_error_clamp);
+}
+
+// TrainingEngine._effectiveError: records the frame in the vibrato window,
+// then smooths over the window only while the vibrato is in range.
+double effective_error(PT_SESSION_METRICS* m, const BridgeFrame& f) {
+    if (m->window_size == kWindow) {
+        m->window_head = (m->window_head + 1) % kWindow;
+        --m->window_size;
+    }
+    m->window[(m->window_head + m->window_size) % kWindow] = {f.timestamp_ms, f.cents_error};
+    ++m->window_size;
+    while (m->window_size > 0 &&
+           f.timestamp_ms - m->window[m->window_head].timestamp_ms > m->cfg.effective_error_window_ms) {
+        m->window_head = (m->window_head + 1) % kWindow;
+        --m->window_size;
+    }
+
+    const bool valid_vibrato = f.vibrato_qualified && f.vibrato_rate_hz >= m->cfg.vibrato_rate_min_hz &&
+                               f.vibrato_rate_hz <= m->cfg.vibrato_rate_max_hz &&
+                               f.vibrato_depth_cents <= m->cfg.vibrato_depth_limit_cents;
+    if (!valid_vibrato) {
+        return clamp_cents(m, f.cents_error);
+    }
+    // Oldest first, as the Dart reduce sums them.
+    double sum = 0.0;
+    for (int i = 0; i < m->window_size; ++i) {
+        sum += m->window[(m->window_head + i) % kWindow].cents_error;
+    }
+    return clamp_cents(m, sum / m->window_size);
+}
+
+// TrainingEngine.onDspFrame for a running session.
+void step(PT_SESSION_METRICS* m, const BridgeFrame& f, int64_t dt) {
+    const PTSessionMetricsConfig& cfg = m->cfg;
+    if (m->state == PT_SESSION_LOW_CONFIDENCE) {
+        if (!f.usable_pitch || f.confidence < cfg.recovery_confidence) {
+            m->effective_error = NAN;
+            return;
+        }
+        m->state = m->return_state;
+    } else if (!f.usable_pitch || f.confidence < cfg.min_confidence) {
+        m->return_state = m->state;
+        m->state = PT_SESSION_LOW_CONFIDENCE;
+        m->effective_error = NAN;
+        return;
+    }
+
+    const double error = effective_error(m, f);
+    const double abs_error = std::fabs(error);
+
+    if (m->state == PT_SESSION_COUNTDOWN) {
+        m->countdown_remaining_ms = std::max<int64_t>(0, m->countdown_remaining_ms - dt);
+        if (m->countdown_remaining_ms == 0) {
+            m->state = PT_SESSION_SEEKING_LOCK;
+            m->effective_error = error;
+        }
+        return;
+    }
+
+    PTSessionState next = m->state;
+    switch (m->state) {
+        case PT_SESSION_SEEKING_LOCK:
+            m->within_tolerance_ms = abs_error <= cfg.tolerance_cents ? m->within_tolerance_ms + dt : 0;
+            if (m->within_tolerance_ms >= cfg.lock_acquire_ms) {
+                next = PT_SESSION_LOCKED;
+                m->locked_time_ms = 0;
+                m->outside_drift_ms = 0;
+            }
+            break;
+        case PT_SESSION_LOCKED:
+            m->locked_time_ms += dt;
+            if (m->locked_time_ms >= cfg.lock_required_before_drift_ms) {
+                m->outside_drift_ms = abs_error > cfg.drift_threshold_cents ? m->outside_drift_ms + dt : 0;
+                if (m->outside_drift_ms >= cfg.drift_candidate_ms) {
+                    next = PT_SESSION_DRIFT_CANDIDATE;
+                    m->outside_drift_ms = 0;
+                }
+            }
+            break;
+        case PT_SESSION_DRIFT_CANDIDATE:
+            if (abs_error <= cfg.tolerance_cents) {
+                m->outside_drift_ms = 0;
+                next = PT_SESSION_LOCKED;
+            } else if (abs_error > cfg.drift_threshold_cents) {
+                m->outside_drift_ms += dt;
+                if (m->outside_drift_ms >= cfg.drift_confirm_ms) {
+                    next = PT_SESSION_DRIFT_CONFIRMED;
+                    ++m->drift_count;
+                }
+            }
+            break;
+        case PT_SESSION_DRIFT_CONFIRMED:
+            if (cfg.drift_awareness_mode && abs_error <= cfg.tolerance_cents) {
+                next = PT_SESSION_SEEKING_LOCK;
+                m->outside_drift_ms = 0;
+                m->within_tolerance_ms = 0;
+            }
+            break;
+        default:
+            break;
+    }
+    m->state = next;
+    m->effective_error = error;
+}
+
+// LiveSessionCoordinator._onFrame.
+void add_frame(PT_SESSION_METRICS* m, const DSPFrameOutput& frame) {
+    const BridgeFrame f = bridge_frame(frame);
+    const int64_t dt = m->has_last ? std::max<int64_t>(0, f.timestamp_ms - m->last_ms) : 0;
+    m->has_last = true;
+    m->last_ms = f.timestamp_ms;
+    step(m, f, dt);
+
+    ++m->frames;
+    m->active_ms += dt;
+    if (m->state == PT_SESSION_LOCKED) {
+        m->locked_ms += dt;
+    }
+    if (!std::isnan(m->effective_error)) {
+        const double x = m->effective_error;
+        m->abs_error_sum += std::fabs(x);
+        ++m->error_count;
+        const double delta = x - m->error_mean;
+        m->error_mean += delta / static_cast<double>(m->error_count);
+        m->error_m2 += delta * (x - m->error_mean);
+    }
+}
+
+void publish(PT_SESSION_METRICS* m) {
+    PTSessionMetrics s{};
+    if (m->error_count > 0) {
+        const double n = static_cast<double>(m->error_count);
+        s.avg_error_cents = m->abs_error_sum / n;
+        s.stability_cents = std::sqrt(std::max(0.0, m->error_m2 / n));
+    }
+    s.lock_ratio = m->active_ms == 0
+                       ? 0.0
+                       : std::min(1.0, static_cast<double>(m->locked_ms) / static_cast<double>(m->active_ms));
+    s.drift_count = m->drift_count;
+    s.active_duration_ms = m->active_ms;
+    s.locked_duration_ms = m->locked_ms;
+    s.frames = m->frames;
+    s.state = m->state;
+
+    uint64_t words[kSnapshotWords] = {};
+    std::memcpy(words, &s, sizeof(s));
+    const uint64_t seq = m->seq.load(std::memory_order_relaxed);
+    m->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kSnapshotWords; ++i) {
+        m->snapshot[i].store(words[i], std::memory_order_relaxed);
+    }
+    m->seq.store(seq + 2, std::memory_order_release);
+}
+
+void start_session(PT_SESSION_METRICS* m) {
+    m->state = PT_SESSION_COUNTDOWN;
+    m->return_state = PT_SESSION_COUNTDOWN;
+    m->has_last = false;
+    m->last_ms = 0;
+    m->countdown_remaining_ms = m->cfg.countdown_ms;
+    m->within_tolerance_ms = 0;
+    m->outside_drift_ms = 0;
+    m->locked_time_ms = 0;
+    m->effective_error = NAN;
+    m->window_head = 0;
+    m->window_size = 0;
+    m->drift_count = 0;
+    m->active_ms = 0;
+    m->locked_ms = 0;
+    m->frames = 0;
+    m->error_count = 0;
+    m->abs_error_sum = 0.0;
+    m->error_mean = 0.0;
+    m->error_m2 = 0.0;
+    publish(m);
+}
+}  // namespace
+
+extern "C" {
+
+PTSessionMetricsConfig pt_dsp_session_metrics_default_config(void) {
+    PTSessionMetricsConfig cfg;
+    cfg.tolerance_cents = 20.0;
+    cfg.drift_threshold_cents = 30.0;
+    cfg.drift_awareness_mode = false;
+    cfg.countdown_ms = 3000;
+    cfg.min_confidence = 0.60;
+    cfg.recovery_confidence = 0.65;
+    cfg.lock_acquire_ms = 300;
+    cfg.lock_required_before_drift_ms = 500;
+    cfg.drift_candidate_ms = 200;
+    cfg.drift_confirm_ms = 250;
+    cfg.effective_error_window_ms = 150;
+    cfg.vibrato_rate_min_hz = 4.0;
+    cfg.vibrato_rate_max_hz = 8.0;
+    cfg.vibrato_depth_limit_cents = 30.0;
+    cfg.cents_error_clamp = 50.0;
+    return cfg;
+}
+
+PT_SESSION_METRICS* pt_dsp_session_metrics_create(const PTSessionMetricsConfig* cfg) {
+    auto* metrics = new (std::nothrow) PT_SESSION_METRICS();
+    if (metrics == nullptr) {
+        return nullptr;
+    }
+    metrics->cfg = cfg != nullptr ? *cfg : pt_dsp_session_metrics_default_config();
+    start_session(metrics);
+    return metrics;
+}
+
+void pt_dsp_session_metrics_destroy(PT_SESSION_METRICS* metrics) {
+    delete metrics;
+}
+
+void pt_dsp_session_metrics_reset(PT_SESSION_METRICS* metrics) {
+    if (metrics != nullptr) {
+        start_session(metrics);
+    }
+}
+
+int pt_dsp_session_metrics_add(PT_SESSION_METRICS* metrics, const DSPFrameOutput* frames, int count) {
+    if (metrics == nullptr || count < 0 || (frames == nullptr && count > 0)) {
+        return -1;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (std::isfinite(frames[i].timestamp_ms)) {
+            add_frame(metrics, frames[i]);
+        }
+    }
+    publish(metrics);
+    return 0;
+}
+
+bool pt_dsp_session_metrics_snapshot(const PT_SESSION_METRICS* metrics, PTSessionMetrics* out) {
+    if (metrics == nullptr || out == nullptr) {
+        return false;
+    }
+    uint64_t words[kSnapshotWords];
+    uint64_t before = 0;
+    uint64_t after = 0;
+    do {
+        before = metrics->seq.load(std::memory_order_acquire);
+        for (size_t i = 0; i < kSnapshotWords; ++i) {
+            words[i] = metrics->snapshot[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = metrics->seq.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    std::memcpy(out, words, sizeof(*out));
+    return true;
+}
+
+}  // extern "C"
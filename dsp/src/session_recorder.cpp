@@ -0,0 +1,344 @@
+#include "pt_dsp/session_recorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pt_dsp {
+namespace {
+constexpr uint32_t kFileMagic = 0x52535450u;   // "PTSR"
+constexpr uint32_t kChunkMagic = 0x43535450u;  // "PTSC"
+constexpr uint16_t kFileVersion = 1;
+constexpr size_t kFileHeaderBytes = 64;
+constexpr size_t kChunkHeaderBytes = 64;
+constexpr size_t kBlockOffset = 8;  // PTPackedFrameHeader within a chunk header
+constexpr uint32_t kMaxChunkFrames = 1u << 20;
+// Files grow geometrically up to this step, then linearly.
+constexpr size_t kMaxGrowthBytes = size_t{16} << 20;
+constexpr int64_t kMaxDeltaTicks = 65535;
+
+// File header fields.
+constexpr size_t kMagicAt = 0;
+constexpr size_t kVersionAt = 4;
+constexpr size_t kHeaderBytesAt = 6;
+constexpr size_t kChunkFramesAt = 8;
+constexpr size_t kChunkStrideAt = 12;
+constexpr size_t kA4At = 16;
+constexpr size_t kFlagsAt = 20;
+
+template <typename V>
+void put(uint8_t* p, size_t offset, V value) {
+    std::memcpy(p + offset, &value, sizeof(V));
+}
+
+template <typename V>
+V get(const uint8_t* p, size_t offset) {
+    V value;
+    std::memcpy(&value, p + offset, sizeof(V));
+    return value;
+}
+
+size_t chunk_stride(uint32_t chunk_frames) {
+    const size_t bytes = kChunkHeaderBytes + size_t{chunk_frames} * PT_DSP_PACKED_FRAME_BYTES;
+    return (bytes + 63) & ~size_t{63};
+}
+}  // namespace
+
+SessionRecorder::~SessionRecorder() {
+    close();
+}
+
+bool SessionRecorder::fail(const char* reason) {
+    error_ = reason;
+    close();
+    return false;
+}
+
+bool SessionRecorder::open(const std::string& path, double a4_hz, uint32_t chunk_frames) {
+    close();
+    error_.clear();
+    if (chunk_frames == 0 || chunk_frames > kMaxChunkFrames) {
+        error_ = "chunk_frames out of range";
+        return false;
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        error_ = "cannot create file";
+        return false;
+    }
+    a4_hz_ = a4_hz;
+    chunk_frames_ = chunk_frames;
+    chunk_stride_ = chunk_stride(chunk_frames);
+    chunks_ = 0;
+    committed_ = 0;
+    last_ticks_ = 0;
+    frames_written_ = 0;
+    if (!ensure_mapped(kFileHeaderBytes + chunk_stride_)) {
+        return false;
+    }
+    put<uint32_t>(map_, kMagicAt, kFileMagic);
+    put<uint16_t>(map_, kVersionAt, kFileVersion);
+    put<uint16_t>(map_, kHeaderBytesAt, static_cast<uint16_t>(kFileHeaderBytes));
+    put<uint32_t>(map_, kChunkFramesAt, chunk_frames_);
+    put<uint32_t>(map_, kChunkStrideAt, static_cast<uint32_t>(chunk_stride_));
+    put<float>(map_, kA4At, static_cast<float>(a4_hz));
+    put<uint32_t>(map_, kFlagsAt, 0);
+    return true;
+}
+
+// Grows the file and its mapping to at least end bytes.
+bool SessionRecorder::ensure_mapped(size_t end) {
+    if (end <= map_size_) {
+        return true;
+    }
+    const size_t grown = map_size_ + std::min(std::max(map_size_, chunk_stride_), kMaxGrowthBytes);
+    const size_t size = std::max(end, grown);
+    if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        return fail("cannot grow file");
+    }
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        return fail("cannot map file");
+    }
+    map_ = static_cast<uint8_t*>(map);
+    map_size_ = size;
+    return true;
+}
+
+uint8_t* SessionRecorder::chunk_at(uint64_t index) const {
+    return map_ + kFileHeaderBytes + index * chunk_stride_;
+}
+
+bool SessionRecorder::start_chunk() {
+    if (!ensure_mapped(kFileHeaderBytes + (chunks_ + 1) * chunk_stride_)) {
+        return false;
+    }
+    uint8_t* chunk = chunk_at(chunks_);
+    put<uint32_t>(chunk, 0, kChunkMagic);
+    put<uint32_t>(chunk, 4, static_cast<uint32_t>(chunks_));
+    PTPackedFrameHeader block{};
+    block.magic = PT_DSP_PACKED_FRAME_MAGIC;
+    block.version = PT_DSP_PACKED_FRAME_VERSION;
+    block.frame_bytes = PT_DSP_PACKED_FRAME_BYTES;
+    block.a4_hz = static_cast<float>(a4_hz_);
+    std::memcpy(chunk + kBlockOffset, &block, sizeof(block));
+    ++chunks_;
+    committed_ = 0;
+    return true;
+}
+
+bool SessionRecorder::append(const DSPFrameOutput* frames, size_t count) {
+    if (map_ == nullptr) {
+        return false;
+    }
+    size_t i = 0;
+    while (i < count) {
+        if (!std::isfinite(frames[i].timestamp_ms)) {
+            ++i;
+            continue;
+        }
+        if (chunks_ == 0 || committed_ == chunk_frames_) {
+            if (!start_chunk()) {
+                return false;
+            }
+        }
+        uint8_t* chunk = chunk_at(chunks_ - 1);
+        auto* block = reinterpret_cast<PTPackedFrameHeader*>(chunk + kBlockOffset);
+        uint8_t* records = chunk + kChunkHeaderBytes + size_t{committed_} * PT_DSP_PACKED_FRAME_BYTES;
+        const size_t room = std::min<size_t>(count - i, chunk_frames_ - committed_);
+
+        // Records past frame_count are invisible to readers, so they can be
+        // written (and rewritten) in place before being committed.
+        PTPackedFrameHeader encoded;
+        const size_t n = pt_dsp_encode_frames(frames + i, room, a4_hz_, &encoded, records);
+        if (n == 0) {
+            ++i;  // a timestamp too large to store
+            continue;
+        }
+        int64_t ticks = encoded.base_ticks;
+        if (committed_ > 0) {
+            const int64_t dt = encoded.base_ticks - last_ticks_;
+            if (dt < 0 || dt > kMaxDeltaTicks) {
+                if (!start_chunk()) {
+                    return false;
+                }
+                continue;
+            }
+            put<uint16_t>(records, 0, static_cast<uint16_t>(dt));
+        } else {
+            block->base_ticks = encoded.base_ticks;
+        }
+        for (size_t k = 1; k < n; ++k) {
+            ticks += get<uint16_t>(records, k * PT_DSP_PACKED_FRAME_BYTES);
+        }
+        last_ticks_ = ticks;
+        committed_ += static_cast<uint32_t>(n);
+        __atomic_store_n(&block->frame_count, committed_, __ATOMIC_RELEASE);
+        frames_written_ += n;
+        i += n;
+    }
+    return true;
+}
+
+bool SessionRecorder::flush() {
+    return map_ != nullptr && msync(map_, map_size_, MS_SYNC) == 0;
+}
+
+void SessionRecorder::close() {
+    if (map_ != nullptr) {
+        size_t used = kFileHeaderBytes;
+        if (chunks_ > 0) {
+            used += (chunks_ - 1) * chunk_stride_ + kChunkHeaderBytes + size_t{committed_} * PT_DSP_PACKED_FRAME_BYTES;
+        }
+        put<uint32_t>(map_, kFlagsAt, kSessionClosedCleanly);
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+        if (ftruncate(fd_, static_cast<off_t>(used)) != 0) {
+            error_ = "cannot trim file";
+        }
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+SessionReader::~SessionReader() {
+    close();
+}
+
+bool SessionReader::fail(const char* reason) {
+    close();
+    error_ = reason;
+    return false;
+}
+
+void SessionReader::close() {
+    if (map_ != nullptr) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    map_size_ = 0;
+    frame_count_ = 0;
+    closed_cleanly_ = false;
+    chunks_.clear();
+}
+
+bool SessionReader::open(const std::string& path) {
+    close();
+    error_.clear();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return fail("cannot open file");
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kFileHeaderBytes)) {
+        ::close(fd);
+        return fail("not a session file");
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        map_ = nullptr;
+        return fail("cannot map file");
+    }
+    map_ = map;
+
+    const auto* base = static_cast<const uint8_t*>(map_);
+    const uint32_t chunk_frames = get<uint32_t>(base, kChunkFramesAt);
+    const size_t stride = get<uint32_t>(base, kChunkStrideAt);
+    if (get<uint32_t>(base, kMagicAt) != kFileMagic || get<uint16_t>(base, kVersionAt) != kFileVersion ||
+        get<uint16_t>(base, kHeaderBytesAt) != kFileHeaderBytes) {
+        return fail("not a session file");
+    }
+    if (chunk_frames == 0 || chunk_frames > kMaxChunkFrames || stride != chunk_stride(chunk_frames)) {
+        return fail("corrupt file header");
+    }
+    a4_hz_ = get<float>(base, kA4At);
+    closed_cleanly_ = (get<uint32_t>(base, kFlagsAt) & kSessionClosedCleanly) != 0;
+
+    uint32_t index = 0;
+    for (size_t offset = kFileHeaderBytes; offset + kChunkHeaderBytes <= map_size_; offset += stride, ++index) {
+        const uint8_t* chunk = base + offset;
+        if (get<uint32_t>(chunk, 0) != kChunkMagic || get<uint32_t>(chunk, 4) != index) {
+            break;
+        }
+        Chunk c{};
+        std::memcpy(&c.header, chunk + kBlockOffset, sizeof(c.header));
+        c.header.frame_count = __atomic_load_n(
+            reinterpret_cast<const uint32_t*>(chunk + kBlockOffset + offsetof(PTPackedFrameHeader, frame_count)),
+            __ATOMIC_ACQUIRE);
+        if (c.header.magic != PT_DSP_PACKED_FRAME_MAGIC || c.header.version != PT_DSP_PACKED_FRAME_VERSION ||
+            c.header.frame_bytes != PT_DSP_PACKED_FRAME_BYTES || c.header.frame_count > chunk_frames) {
+            break;
+        }
+        const size_t available = (map_size_ - offset - kChunkHeaderBytes) / PT_DSP_PACKED_FRAME_BYTES;
+        c.header.frame_count = static_cast<uint32_t>(std::min<size_t>(c.header.frame_count, available));
+        if (c.header.frame_count == 0) {
+            continue;
+        }
+        c.records = chunk + kChunkHeaderBytes;
+        c.first_frame = frame_count_;
+        frame_count_ += c.header.frame_count;
+        chunks_.push_back(c);
+    }
+    scratch_.resize(chunk_frames);
+    return true;
+}
+
+size_t SessionReader::read(uint64_t first, size_t count, DSPFrameOutput* out) {
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), first,
+                               [](uint64_t frame, const Chunk& c) { return frame < c.first_frame; });
+    if (it == chunks_.begin()) {
+        return 0;
+    }
+    --it;
+    size_t done = 0;
+    for (; it != chunks_.end() && done < count; ++it) {
+        const uint64_t skip = first + done - it->first_frame;
+        if (skip >= it->header.frame_count) {
+            break;
+        }
+        pt_dsp_decode_frames(&it->header, it->records, scratch_.data());
+        const size_t n = std::min<size_t>(count - done, it->header.frame_count - skip);
+        std::copy_n(scratch_.begin() + static_cast<std::ptrdiff_t>(skip), n, out + done);
+        done += n;
+    }
+    return done;
+}
+
+uint64_t SessionReader::seek(double timestamp_ms) const {
+    const auto at_or_after = [timestamp_ms](int64_t ticks) {
+        return static_cast<double>(ticks) / PT_DSP_PACKED_TICKS_PER_MS >= timestamp_ms;
+    };
+    // First chunk that starts at or after the target; the frame sought is its
+    // first one unless the chunk before reaches the target.
+    auto it = std::partition_point(chunks_.begin(), chunks_.end(),
+                                   [&](const Chunk& c) { return !at_or_after(c.header.base_ticks); });
+    const uint64_t next = it == chunks_.end() ? frame_count_ : it->first_frame;
+    if (it == chunks_.begin()) {
+        return next;
+    }
+    const Chunk& previous = *(it - 1);
+    int64_t ticks = previous.header.base_ticks;
+    for (uint32_t k = 0; k < previous.header.frame_count; ++k) {
+        ticks += get<uint16_t>(previous.records, size_t{k} * PT_DSP_PACKED_FRAME_BYTES);
+        if (at_or_after(ticks)) {
+            return previous.first_frame + k;
+        }
+    }
+    return next;
+}
+
+}  // namespace pt_dsp
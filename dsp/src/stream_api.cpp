@@ -0,0 +1,151 @@
+#include "pt_dsp/stream_api.h"
+
+#include "dsp_internal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+static_assert(sizeof(PTDSPFrameRing) <= PT_DSP_STREAM_RING_HEADER_BYTES, "ring header fits before slot 0");
+static_assert(PT_DSP_STREAM_RING_HEADER_BYTES % alignof(DSPFrameOutput) == 0, "slots are aligned");
+
+struct PT_DSP_STREAM {
+    PT_DSP* dsp;
+    int chunk_samples;     // input per pt_dsp_push call, at most kPushFrames hops
+    PTDSPFrameRing* ring;  // header and slots, one cache-line-aligned block
+};
+
+namespace {
+// Frames produced per pt_dsp_push call before they are copied to the ring.
+constexpr int kPushFrames = 64;
+constexpr std::align_val_t kRingAlignment{PT_DSP_INSTANCE_ALIGNMENT};
+
+DSPFrameOutput* slots(const PTDSPFrameRing* ring) {
+    const auto* base = reinterpret_cast<const unsigned char*>(ring) + PT_DSP_STREAM_RING_HEADER_BYTES;
+    return reinterpret_cast<DSPFrameOutput*>(const_cast<unsigned char*>(base));
+}
+
+DSPFrameOutput* slot(const PTDSPFrameRing* ring, uint64_t seq) {
+    return slots(ring) + (seq & (ring->capacity - 1));
+}
+
+uint64_t oldest_intact(uint64_t begun, uint32_t capacity) { return begun > capacity ? begun - capacity : 0; }
+
+// Copies the last frames of a push into the ring and publishes them; see
+// PTDSPFrameRing for the protocol readers follow.
+void publish(PTDSPFrameRing* ring, const DSPFrameOutput* frames, int count) {
+    const uint64_t written = __atomic_load_n(&ring->frames_written, __ATOMIC_RELAXED);
+    const uint64_t end = written + static_cast<uint64_t>(count);
+    __atomic_store_n(&ring->frames_begun, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    const int keep = std::min<int>(count, static_cast<int>(ring->capacity));
+    for (int i = count - keep; i < count; ++i) {
+        *slot(ring, written + static_cast<uint64_t>(i)) = frames[i];
+    }
+    __atomic_store_n(&ring->frames_written, end, __ATOMIC_RELEASE);
+}
+}  // namespace
+
+extern "C" {
+
+PT_DSP_STREAM* pt_dsp_stream_open(DSPConfig cfg, uint32_t ring_capacity) {
+    if (ring_capacity > (1u << 30)) {
+        return nullptr;
+    }
+    uint32_t capacity = 2;
+    while (capacity < ring_capacity) {
+        capacity <<= 1;
+    }
+    auto* stream = new (std::nothrow) PT_DSP_STREAM{};
+    if (stream == nullptr) {
+        return nullptr;
+    }
+    stream->dsp = pt_dsp_create(cfg);
+    const size_t bytes = PT_DSP_STREAM_RING_HEADER_BYTES + size_t{capacity} * sizeof(DSPFrameOutput);
+    void* block = stream->dsp != nullptr ? ::operator new(bytes, kRingAlignment, std::nothrow) : nullptr;
+    if (block == nullptr) {
+        pt_dsp_stream_close(stream);
+        return nullptr;
+    }
+    std::memset(block, 0, bytes);
+    stream->ring = static_cast<PTDSPFrameRing*>(block);
+    stream->ring->capacity = capacity;
+    stream->ring->frame_stride = sizeof(DSPFrameOutput);
+
+    // The instance's hop, after pt_dsp_create's defaults and clamping: one
+    // chunk then produces at most kPushFrames frames.
+    stream->chunk_samples = pt_dsp::resolved_config(stream->dsp).hop_size * kPushFrames;
+    return stream;
+}
+
+void pt_dsp_stream_close(PT_DSP_STREAM* stream) {
+    if (stream == nullptr) {
+        return;
+    }
+    if (stream->ring != nullptr) {
+        ::operator delete(stream->ring, kRingAlignment);
+    }
+    pt_dsp_destroy(stream->dsp);
+    delete stream;
+}
+
+int pt_dsp_stream_push(PT_DSP_STREAM* stream, const float* mono_samples, int num_samples) {
+    if (stream == nullptr || num_samples < 0 || (mono_samples == nullptr && num_samples > 0)) {
+        return -1;
+    }
+    DSPFrameOutput frames[kPushFrames];
+    int published = 0;
+    for (int offset = 0; offset < num_samples; offset += stream->chunk_samples) {
+        const int n = std::min(stream->chunk_samples, num_samples - offset);
+        const int produced = pt_dsp_push(stream->dsp, mono_samples + offset, n, frames, kPushFrames);
+        if (produced > 0) {
+            publish(stream->ring, frames, std::min(produced, kPushFrames));
+            published += std::min(produced, kPushFrames);
+        }
+    }
+    return published;
+}
+
+const PTDSPFrameRing* pt_dsp_stream_ring(const PT_DSP_STREAM* stream) {
+    return stream != nullptr ? stream->ring : nullptr;
+}
+
+uint64_t pt_dsp_stream_frames_written(const PT_DSP_STREAM* stream) {
+    return __atomic_load_n(&stream->ring->frames_written, __ATOMIC_ACQUIRE);
+}
+
+uint64_t pt_dsp_stream_frames_begun(const PT_DSP_STREAM* stream) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&stream->ring->frames_begun, __ATOMIC_RELAXED);
+}
+
+int pt_dsp_stream_read(const PT_DSP_STREAM* stream, uint64_t* cursor, DSPFrameOutput* out_frames, int max_frames,
+                       uint64_t* dropped) {
+    if (stream == nullptr || cursor == nullptr || max_frames < 0 || (out_frames == nullptr && max_frames > 0)) {
+        return -1;
+    }
+    const PTDSPFrameRing* ring = stream->ring;
+    const uint64_t written = pt_dsp_stream_frames_written(stream);
+    const uint64_t from = std::min(*cursor, written);
+    const uint64_t start = std::max(from, oldest_intact(written, ring->capacity));
+    const uint64_t end = start + std::min<uint64_t>(written - start, static_cast<uint64_t>(max_frames));
+    for (uint64_t seq = start; seq < end; ++seq) {
+        out_frames[seq - start] = *slot(ring, seq);
+    }
+
+    // Frames the writer started to overwrite during the copy are dropped too.
+    const uint64_t intact = std::max(start, oldest_intact(pt_dsp_stream_frames_begun(stream), ring->capacity));
+    const uint64_t kept_from = std::min(intact, end);
+    const uint64_t kept = end - kept_from;
+    if (kept_from > start) {
+        std::memmove(out_frames, out_frames + (kept_from - start), kept * sizeof(DSPFrameOutput));
+    }
+    const uint64_t next = std::max(intact, end);
+    if (dropped != nullptr) {
+        *dropped = next - kept - from;
+    }
+    *cursor = next;
+    return static_cast<int>(kept);
+}
+
+}  // extern "C"
@@ -0,0 +1,675 @@
+#include "pt_dsp/wav_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PT_DSP_SSE2_WAV 1
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define PT_DSP_NEON_WAV 1
+#include <arm_neon.h>
+#endif
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "wav_io.cpp loads samples in host order and assumes a little-endian host"
+#endif
+
+namespace pt_dsp {
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+constexpr size_t kWavHeaderBytes = 44;
+constexpr float kPcm16Scale = 1.0f / 32768.0f;
+constexpr float kPcm32Scale = 1.0f / 2147483648.0f;
+
+uint16_t load_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t load_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void store_u16(uint8_t* p, uint16_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+void store_u32(uint8_t* p, uint32_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// Parses the RIFF header through fetch(offset, size, dst), which returns
+// false for bytes past the end of the file. Returns nullptr on success or a
+// short reason.
+template <typename Fetch>
+const char* parse_wav(Fetch fetch, uint64_t file_size, WavFormat* format) {
+    uint8_t riff[12];
+    if (file_size < sizeof(riff) || !fetch(0, sizeof(riff), riff)) {
+        return "too short";
+    }
+    if (std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return "not a RIFF/WAVE file";
+    }
+
+    uint16_t tag = 0;
+    uint16_t bits = 0;
+    uint64_t data_offset = 0;
+    uint64_t data_size = 0;
+    bool have_fmt = false;
+    uint64_t pos = 12;
+    while (pos + 8 <= file_size) {
+        uint8_t chunk[8];
+        if (!fetch(pos, sizeof(chunk), chunk)) {
+            break;
+        }
+        const uint64_t size = load_u32(chunk + 4);
+        const uint64_t body = pos + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16 && body + size <= file_size) {
+            uint8_t fmt[26];
+            if (!fetch(body, std::min<uint64_t>(size, sizeof(fmt)), fmt)) {
+                return "too short";
+            }
+            tag = load_u16(fmt);
+            format->channels = load_u16(fmt + 2);
+            format->sample_rate = static_cast<int>(load_u32(fmt + 4));
+            bits = load_u16(fmt + 14);
+            if (tag == kFormatExtensible && size >= 26) {
+                // The first two bytes of the subformat GUID carry the format tag.
+                tag = load_u16(fmt + 24);
+            }
+            have_fmt = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            // Streaming writers may leave the size unset; use what is on disk.
+            data_offset = body;
+            data_size = std::min(size, file_size - body);
+            break;
+        }
+        pos = body + size + (size & 1);
+    }
+
+    if (!have_fmt) {
+        return "missing fmt chunk";
+    }
+    if (data_offset == 0) {
+        return "missing data chunk";
+    }
+    if (format->channels < 1 || format->sample_rate <= 0) {
+        return "invalid format";
+    }
+    if (tag == kFormatPcm && bits == 16) {
+        format->encoding = WavEncoding::kPcm16;
+    } else if (tag == kFormatPcm && bits == 24) {
+        format->encoding = WavEncoding::kPcm24;
+    } else if (tag == kFormatPcm && bits == 32) {
+        format->encoding = WavEncoding::kPcm32;
+    } else if (tag == kFormatFloat && bits == 32) {
+        format->encoding = WavEncoding::kFloat32;
+    } else {
+        return "unsupported sample format";
+    }
+    format->data_offset = data_offset;
+    format->frames = static_cast<int64_t>(data_size / static_cast<uint64_t>(format->frame_bytes()));
+    return nullptr;
+}
+
+// Little-endian sample loads. The data chunk has no alignment guarantee, so
+// multi-byte samples go through memcpy, which compiles to a plain load.
+template <WavEncoding E>
+float load_sample(const uint8_t* p) {
+    if constexpr (E == WavEncoding::kPcm16) {
+        int16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return static_cast<float>(v) * kPcm16Scale;
+    } else if constexpr (E == WavEncoding::kPcm24) {
+        const int32_t v = static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                                               static_cast<uint32_t>(p[2]) << 24) >> 8;
+        return static_cast<float>(v) * (1.0f / 8388608.0f);
+    } else if constexpr (E == WavEncoding::kPcm32) {
+        int32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        // Exact: the scale is a power of two and the int rounds like this.
+        return static_cast<float>(v) * kPcm32Scale;
+    } else {
+        float v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+}
+
+template <WavEncoding E>
+void convert(const uint8_t* src, int channels, size_t count, float* out) {
+    constexpr int bytes = E == WavEncoding::kPcm16 ? 2 : E == WavEncoding::kPcm24 ? 3 : 4;
+    const size_t stride = static_cast<size_t>(bytes) * channels;
+    if (channels == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = load_sample<E>(src + i * stride);
+        }
+        return;
+    }
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* frame = src + i * stride;
+        float sum = 0.0f;
+        for (int ch = 0; ch < channels; ++ch) {
+            sum += load_sample<E>(frame + ch * bytes);
+        }
+        out[i] = sum * scale;
+    }
+}
+
+// Vector versions of convert for mono and stereo 16- and 32-bit data. Each
+// returns the number of frames done, leaving the tail to convert; results
+// are identical, since every step is the scalar one lane-wise.
+#if PT_DSP_SSE2_WAV
+__m128 to_float(__m128i v, WavEncoding encoding, __m128 scale) {
+    return encoding == WavEncoding::kFloat32 ? _mm_castsi128_ps(v) : _mm_mul_ps(_mm_cvtepi32_ps(v), scale);
+}
+
+size_t convert_vector(const uint8_t* src, WavEncoding encoding, int channels, size_t count, float* out) {
+    size_t i = 0;
+    const __m128 half = _mm_set1_ps(0.5f);
+    if (encoding == WavEncoding::kPcm16) {
+        const __m128 scale = _mm_set1_ps(kPcm16Scale);
+        // Eight samples per load: widen with sign, convert, scale.
+        const auto widen = [scale](__m128i v, __m128* lo, __m128* hi) {
+            *lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale);
+            *hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale);
+        };
+        if (channels == 1) {
+            for (; i + 8 <= count; i += 8) {
+                __m128 lo, hi;
+                widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i)), &lo, &hi);
+                _mm_storeu_ps(out + i, lo);
+                _mm_storeu_ps(out + i + 4, hi);
+            }
+        } else if (channels == 2) {
+            for (; i + 4 <= count; i += 4) {
+                __m128 a, b;
+                widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i)), &a, &b);
+                const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+            }
+        }
+    } else if (encoding == WavEncoding::kPcm32 || encoding == WavEncoding::kFloat32) {
+        const __m128 scale = _mm_set1_ps(kPcm32Scale);
+        if (channels == 1) {
+            for (; i + 4 <= count; i += 4) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+                _mm_storeu_ps(out + i, to_float(v, encoding, scale));
+            }
+        } else if (channels == 2) {
+            for (; i + 4 <= count; i += 4) {
+                const __m128 a = to_float(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * i)), encoding,
+                                          scale);
+                const __m128 b = to_float(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * i + 16)),
+                                          encoding, scale);
+                const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+            }
+        }
+    }
+    return i;
+}
+
+size_t encode_pcm16_vector(const float* src, size_t count, uint8_t* dst) {
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const auto quantize = [&](const float* p) {
+        __m128 v = _mm_loadu_ps(p);
+        v = _mm_and_ps(v, _mm_cmpord_ps(v, v));  // NaN -> 0
+        return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, lo), hi), scale));
+    };
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i),
+                         _mm_packs_epi32(quantize(src + i), quantize(src + i + 4)));
+    }
+    return i;
+}
+#elif PT_DSP_NEON_WAV
+float32x4_t to_float(int32x4_t v, WavEncoding encoding, float32x4_t scale) {
+    return encoding == WavEncoding::kFloat32 ? vreinterpretq_f32_s32(v) : vmulq_f32(vcvtq_f32_s32(v), scale);
+}
+
+int32x4_t load_s32(const uint8_t* p) {
+    return vreinterpretq_s32_u8(vld1q_u8(p));
+}
+
+size_t convert_vector(const uint8_t* src, WavEncoding encoding, int channels, size_t count, float* out) {
+    size_t i = 0;
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    if (encoding == WavEncoding::kPcm16) {
+        const float32x4_t scale = vdupq_n_f32(kPcm16Scale);
+        const auto widen_lo = [scale](int16x8_t v) {
+            return vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale);
+        };
+        const auto widen_hi = [scale](int16x8_t v) {
+            return vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale);
+        };
+        if (channels == 1) {
+            for (; i + 8 <= count; i += 8) {
+                const int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(src + 2 * i));
+                vst1q_f32(out + i, widen_lo(v));
+                vst1q_f32(out + i + 4, widen_hi(v));
+            }
+        } else if (channels == 2) {
+            for (; i + 8 <= count; i += 8) {
+                const int16x8x2_t lr = vuzpq_s16(vreinterpretq_s16_u8(vld1q_u8(src + 4 * i)),
+                                                 vreinterpretq_s16_u8(vld1q_u8(src + 4 * i + 16)));
+                vst1q_f32(out + i, vmulq_f32(vaddq_f32(widen_lo(lr.val[0]), widen_lo(lr.val[1])), half));
+                vst1q_f32(out + i + 4, vmulq_f32(vaddq_f32(widen_hi(lr.val[0]), widen_hi(lr.val[1])), half));
+            }
+        }
+    } else if (encoding == WavEncoding::kPcm32 || encoding == WavEncoding::kFloat32) {
+        const float32x4_t scale = vdupq_n_f32(kPcm32Scale);
+        if (channels == 1) {
+            for (; i + 4 <= count; i += 4) {
+                vst1q_f32(out + i, to_float(load_s32(src + 4 * i), encoding, scale));
+            }
+        } else if (channels == 2) {
+            for (; i + 4 <= count; i += 4) {
+                const float32x4x2_t lr = vuzpq_f32(to_float(load_s32(src + 8 * i), encoding, scale),
+                                                   to_float(load_s32(src + 8 * i + 16), encoding, scale));
+                vst1q_f32(out + i, vmulq_f32(vaddq_f32(lr.val[0], lr.val[1]), half));
+            }
+        }
+    }
+    return i;
+}
+
+size_t encode_pcm16_vector(const float* src, size_t count, uint8_t* dst) {
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    const auto quantize = [&](const float* p) {
+        float32x4_t v = vld1q_f32(p);
+        v = vbslq_f32(vceqq_f32(v, v), v, vdupq_n_f32(0.0f));  // NaN -> 0
+        return vcvtnq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(v, lo), hi), scale));
+    };
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u8(dst + 2 * i,
+                 vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(quantize(src + i)), vqmovn_s32(quantize(src + i + 4)))));
+    }
+    return i;
+}
+#else
+size_t convert_vector(const uint8_t*, WavEncoding, int, size_t, float*) {
+    return 0;
+}
+
+size_t encode_pcm16_vector(const float*, size_t, uint8_t*) {
+    return 0;
+}
+#endif
+
+float clamp_unit(float s) {
+    return s == s ? std::min(std::max(s, -1.0f), 1.0f) : 0.0f;
+}
+
+// Writes all of size bytes at offset, or appends them when offset < 0.
+bool write_all(int fd, const uint8_t* data, size_t size, off_t offset = -1) {
+    while (size > 0) {
+        const ssize_t n = offset < 0 ? ::write(fd, data, size) : pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        if (offset >= 0) {
+            offset += n;
+        }
+    }
+    return true;
+}
+
+bool read_all(int fd, uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        const ssize_t n = pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+}  // namespace
+
+int wav_bytes_per_sample(WavEncoding encoding) {
+    switch (encoding) {
+        case WavEncoding::kPcm16:
+            return 2;
+        case WavEncoding::kPcm24:
+            return 3;
+        case WavEncoding::kPcm32:
+        case WavEncoding::kFloat32:
+            return 4;
+    }
+    return 0;
+}
+
+void wav_to_mono(const uint8_t* src, WavEncoding encoding, int channels, size_t count, float* out) {
+    const size_t done = convert_vector(src, encoding, channels, count, out);
+    src += done * static_cast<size_t>(wav_bytes_per_sample(encoding)) * channels;
+    count -= done;
+    out += done;
+    switch (encoding) {
+        case WavEncoding::kPcm16:
+            convert<WavEncoding::kPcm16>(src, channels, count, out);
+            break;
+        case WavEncoding::kPcm24:
+            convert<WavEncoding::kPcm24>(src, channels, count, out);
+            break;
+        case WavEncoding::kPcm32:
+            convert<WavEncoding::kPcm32>(src, channels, count, out);
+            break;
+        case WavEncoding::kFloat32:
+            convert<WavEncoding::kFloat32>(src, channels, count, out);
+            break;
+    }
+}
+
+void wav_from_float(const float* src, size_t count, WavEncoding encoding, uint8_t* dst) {
+    switch (encoding) {
+        case WavEncoding::kPcm16: {
+            for (size_t i = encode_pcm16_vector(src, count, dst); i < count; ++i) {
+                const int16_t v = static_cast<int16_t>(std::lrint(clamp_unit(src[i]) * 32767.0f));
+                std::memcpy(dst + 2 * i, &v, sizeof(v));
+            }
+            break;
+        }
+        case WavEncoding::kPcm24:
+            for (size_t i = 0; i < count; ++i) {
+                const auto v = static_cast<int32_t>(std::lrint(static_cast<double>(clamp_unit(src[i])) * 8388607.0));
+                dst[3 * i] = static_cast<uint8_t>(v);
+                dst[3 * i + 1] = static_cast<uint8_t>(v >> 8);
+                dst[3 * i + 2] = static_cast<uint8_t>(v >> 16);
+            }
+            break;
+        case WavEncoding::kPcm32:
+            for (size_t i = 0; i < count; ++i) {
+                const auto v =
+                    static_cast<int32_t>(std::lrint(static_cast<double>(clamp_unit(src[i])) * 2147483647.0));
+                std::memcpy(dst + 4 * i, &v, sizeof(v));
+            }
+            break;
+        case WavEncoding::kFloat32:
+            std::memcpy(dst, src, count * sizeof(float));
+            break;
+    }
+}
+
+MappedWav::~MappedWav() {
+    close();
+}
+
+void MappedWav::close() {
+    if (map_) {
+        munmap(map_, map_size_);
+    }
+    map_ = nullptr;
+    map_size_ = 0;
+    data_ = nullptr;
+    format_ = WavFormat{};
+}
+
+bool MappedWav::fail(const char* reason) {
+    close();
+    error_ = reason;
+    return false;
+}
+
+bool MappedWav::open(const std::string& path) {
+    close();
+    error_.clear();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return fail("cannot open");
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < 12) {
+        ::close(fd);
+        return fail("too short");
+    }
+    map_size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        map_size_ = 0;
+        return fail("mmap failed");
+    }
+    map_ = map;
+    // The analysis reads front to back once.
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    const uint8_t* base = static_cast<const uint8_t*>(map_);
+    const auto fetch = [base](uint64_t offset, size_t size, uint8_t* dst) {
+        std::memcpy(dst, base + offset, size);
+        return true;
+    };
+    if (const char* reason = parse_wav(fetch, map_size_, &format_)) {
+        return fail(reason);
+    }
+    data_ = base + format_.data_offset;
+    return true;
+}
+
+const float* MappedWav::float_data() const {
+    if (!data_ || format_.encoding != WavEncoding::kFloat32 || format_.channels != 1 ||
+        reinterpret_cast<uintptr_t>(data_) % alignof(float) != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(data_);
+}
+
+int MappedWav::read_mono(int64_t first_frame, int count, float* out) const {
+    if (!data_ || first_frame < 0 || first_frame >= format_.frames || count <= 0) {
+        return 0;
+    }
+    count = static_cast<int>(std::min<int64_t>(count, format_.frames - first_frame));
+    const uint8_t* src = data_ + static_cast<size_t>(first_frame) * format_.frame_bytes();
+    wav_to_mono(src, format_.encoding, format_.channels, static_cast<size_t>(count), out);
+    return count;
+}
+
+WavStreamReader::~WavStreamReader() {
+    close();
+}
+
+void WavStreamReader::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    format_ = WavFormat{};
+    position_ = 0;
+}
+
+bool WavStreamReader::fail(const char* reason) {
+    close();
+    error_ = reason;
+    return false;
+}
+
+bool WavStreamReader::open(const std::string& path, size_t buffer_bytes) {
+    close();
+    error_.clear();
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return fail("cannot open");
+    }
+    struct stat st {};
+    if (fstat(fd_, &st) != 0) {
+        return fail("cannot stat");
+    }
+    const int fd = fd_;
+    const auto fetch = [fd](uint64_t offset, size_t size, uint8_t* dst) { return read_all(fd, dst, size, offset); };
+    if (const char* reason = parse_wav(fetch, static_cast<uint64_t>(st.st_size), &format_)) {
+        return fail(reason);
+    }
+#if defined(__linux__)
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    const size_t frame_bytes = static_cast<size_t>(format_.frame_bytes());
+    buffer_.resize(std::max(frame_bytes, buffer_bytes / frame_bytes * frame_bytes));
+    return true;
+}
+
+bool WavStreamReader::seek(int64_t frame) {
+    if (fd_ < 0 || frame < 0 || frame > format_.frames) {
+        return false;
+    }
+    position_ = frame;
+    return true;
+}
+
+int WavStreamReader::read_mono(int count, float* out) {
+    if (fd_ < 0 || count <= 0) {
+        return 0;
+    }
+    const size_t frame_bytes = static_cast<size_t>(format_.frame_bytes());
+    const size_t buffer_frames = buffer_.size() / frame_bytes;
+    int done = 0;
+    while (done < count && position_ < format_.frames) {
+        const size_t n = static_cast<size_t>(
+            std::min<int64_t>({count - done, format_.frames - position_, static_cast<int64_t>(buffer_frames)}));
+        const uint64_t offset = format_.data_offset + static_cast<uint64_t>(position_) * frame_bytes;
+        if (!read_all(fd_, buffer_.data(), n * frame_bytes, offset)) {
+            error_ = "read failed";
+            return -1;
+        }
+        wav_to_mono(buffer_.data(), format_.encoding, format_.channels, n, out + done);
+        done += static_cast<int>(n);
+        position_ += static_cast<int64_t>(n);
+    }
+    return done;
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::fail(const char* reason) {
+    error_ = reason;
+    failed_ = true;
+    return false;
+}
+
+bool WavWriter::open(const std::string& path, int sample_rate, int channels, WavEncoding encoding) {
+    close();
+    error_.clear();
+    failed_ = false;
+    if (sample_rate <= 0 || channels < 1 || channels > 0xFFFF) {
+        return fail("invalid format");
+    }
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return fail("cannot create");
+    }
+    channels_ = channels;
+    encoding_ = encoding;
+    frames_written_ = 0;
+    buffer_.resize(kBufferBytes);
+
+    // The sizes at 4 and 40 are filled in by close().
+    const int bytes = wav_bytes_per_sample(encoding);
+    uint8_t* h = buffer_.data();
+    std::memcpy(h, "RIFF\0\0\0\0WAVEfmt ", 16);
+    store_u32(h + 16, 16);
+    store_u16(h + 20, encoding == WavEncoding::kFloat32 ? kFormatFloat : kFormatPcm);
+    store_u16(h + 22, static_cast<uint16_t>(channels));
+    store_u32(h + 24, static_cast<uint32_t>(sample_rate));
+    store_u32(h + 28, static_cast<uint32_t>(sample_rate) * static_cast<uint32_t>(bytes * channels));
+    store_u16(h + 32, static_cast<uint16_t>(bytes * channels));
+    store_u16(h + 34, static_cast<uint16_t>(bytes * 8));
+    std::memcpy(h + 36, "data\0\0\0\0", 8);
+    buffered_ = kWavHeaderBytes;
+    return true;
+}
+
+bool WavWriter::flush() {
+    if (buffered_ > 0 && !write_all(fd_, buffer_.data(), buffered_)) {
+        buffered_ = 0;
+        return fail("write failed");
+    }
+    buffered_ = 0;
+    return true;
+}
+
+bool WavWriter::write(const float* interleaved, size_t count) {
+    if (fd_ < 0 || failed_) {
+        return false;
+    }
+    const size_t frame_bytes = static_cast<size_t>(wav_bytes_per_sample(encoding_)) * channels_;
+    while (count > 0) {
+        const size_t room = (buffer_.size() - buffered_) / frame_bytes;
+        if (room == 0) {
+            if (!flush()) {
+                return false;
+            }
+            continue;
+        }
+        const size_t n = std::min(room, count);
+        wav_from_float(interleaved, n * channels_, encoding_, buffer_.data() + buffered_);
+        buffered_ += n * frame_bytes;
+        interleaved += n * channels_;
+        count -= n;
+        frames_written_ += static_cast<int64_t>(n);
+    }
+    return true;
+}
+
+bool WavWriter::close() {
+    if (fd_ < 0) {
+        return false;
+    }
+    const uint64_t data_bytes = static_cast<uint64_t>(frames_written_) * wav_bytes_per_sample(encoding_) * channels_;
+    bool ok = !failed_;
+    if (ok && (data_bytes & 1) != 0) {
+        // RIFF chunks are padded to even sizes.
+        ok = buffered_ < buffer_.size() || flush();
+        if (ok) {
+            buffer_[buffered_++] = 0;
+        }
+    }
+    ok = ok && flush();
+    if (ok) {
+        // Oversized files keep the maximum; readers fall back to the file size.
+        uint8_t size[4];
+        store_u32(size, static_cast<uint32_t>(std::min<uint64_t>(36 + data_bytes + (data_bytes & 1), UINT32_MAX)));
+        ok = write_all(fd_, size, sizeof(size), 4);
+        store_u32(size, static_cast<uint32_t>(std::min<uint64_t>(data_bytes, UINT32_MAX)));
+        ok = ok && write_all(fd_, size, sizeof(size), 40);
+        if (!ok) {
+            fail("write failed");
+        }
+    }
+    ::close(fd_);
+    fd_ = -1;
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    return ok;
+}
+
+}  // namespace pt_dsp
@@ -0,0 +1,157 @@
+#include "pt_dsp/analysis_worker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+constexpr size_t kBurst = 192;  // a typical low-latency callback
+
+DSPConfig worker_config() {
+    DSPConfig cfg{};
+    cfg.a4_hz = 440.0;
+    cfg.sample_rate_hz = kSampleRate;
+    cfg.frame_size = 1024;
+    cfg.hop_size = 256;
+    return cfg;
+}
+
+// Synthetic source: a glide from A3 to A4 with a gap of silence.
+std::vector<float> make_source(size_t size) {
+    std::vector<float> buf(size);
+    double phase = 0.0;
+    for (size_t i = 0; i < size; ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        phase += 2.0 * M_PI * 220.0 * std::pow(2.0, t / 2.0) / kSampleRate;
+        const bool silent = i > size / 2 && i < size / 2 + 9600;
+        buf[i] = silent ? 0.0f : static_cast<float>(0.5 * std::sin(phase));
+    }
+    return buf;
+}
+
+bool same_bits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+[[maybe_unused]] bool same_frame(const DSPFrameOutput& a, const DSPFrameOutput& b) {
+    return same_bits(a.timestamp_ms, b.timestamp_ms) && same_bits(a.freq_hz, b.freq_hz) &&
+           same_bits(a.midi_float, b.midi_float) && a.nearest_midi == b.nearest_midi &&
+           same_bits(a.cents_error, b.cents_error) && same_bits(a.confidence, b.confidence) &&
+           a.vibrato_detected == b.vibrato_detected && same_bits(a.vibrato_rate_hz, b.vibrato_rate_hz) &&
+           same_bits(a.vibrato_depth_cents, b.vibrato_depth_cents);
+}
+
+void collect(void* user, const DSPFrameOutput* frames, size_t count) {
+    auto* out = static_cast<std::vector<DSPFrameOutput>*>(user);
+    out->insert(out->end(), frames, frames + count);
+}
+
+std::vector<DSPFrameOutput> reference_frames(const std::vector<float>& source, DSPConfig cfg) {
+    PT_DSP* dsp = pt_dsp_create(cfg);
+    std::vector<DSPFrameOutput> frames(source.size() / 256 + 1);
+    const int n = pt_dsp_push(dsp, source.data(), static_cast<int>(source.size()), frames.data(),
+                              static_cast<int>(frames.size()));
+    frames.resize(static_cast<size_t>(n));
+    pt_dsp_destroy(dsp);
+    return frames;
+}
+}  // namespace
+
+int main() {
+    const std::vector<float> source = make_source(4 * kSampleRate);
+    const std::vector<DSPFrameOutput> expected = reference_frames(source, worker_config());
+    assert(expected.size() == source.size() / 256);
+
+    // A producer thread pushing callback-sized bursts faster than real time,
+    // backing off only when the ring is nearly full, gets exactly the frames
+    // of a direct pt_dsp_push run.
+    {
+        PT_DSP* dsp = pt_dsp_create(worker_config());
+        std::vector<DSPFrameOutput> frames;
+        pt_dsp::AnalysisWorker worker(dsp, worker_config(), collect, &frames);
+        [[maybe_unused]] const bool started = worker.start();
+        [[maybe_unused]] const bool restarted = worker.start();
+        assert(started && !restarted);
+        std::thread producer([&]() {
+            for (size_t pos = 0; pos < source.size(); pos += kBurst) {
+                while (worker.stats().backlog_samples + kBurst > pt_dsp::AnalysisWorker::kSampleRingSize) {
+                    std::this_thread::yield();
+                }
+                const size_t n = std::min(kBurst, source.size() - pos);
+                [[maybe_unused]] const size_t queued = worker.push(source.data() + pos, n);
+                assert(queued == n);
+            }
+        });
+        producer.join();
+        worker.stop();
+        [[maybe_unused]] const pt_dsp::AnalysisWorkerStats stats = worker.stats();
+        assert(stats.overruns == 0 && stats.samples_dropped == 0);
+        assert(stats.samples_pushed == source.size() && stats.samples_analyzed == source.size());
+        assert(stats.backlog_samples == 0 && stats.frames == expected.size());
+        assert(frames.size() == expected.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            assert(same_frame(frames[i], expected[i]));
+        }
+        pt_dsp_destroy(dsp);
+    }
+
+    // A stalled worker: the ring fills, further pushes count as overruns, and
+    // once running the worker catches up on the whole backlog.
+    {
+        PT_DSP* dsp = pt_dsp_create(worker_config());
+        std::vector<DSPFrameOutput> frames;
+        pt_dsp::AnalysisWorker worker(dsp, worker_config(), collect, &frames);
+        constexpr size_t kRing = pt_dsp::AnalysisWorker::kSampleRingSize;
+        size_t pushed = 0;
+        for (size_t pos = 0; pos + kBurst <= 2 * kRing; pos += kBurst) {
+            pushed += worker.push(source.data() + pos, kBurst);
+        }
+        pt_dsp::AnalysisWorkerStats stats = worker.stats();
+        assert(pushed == kRing && stats.samples_pushed == kRing && stats.backlog_samples == kRing);
+        assert(stats.samples_dropped == (2 * kRing / kBurst) * kBurst - kRing && stats.overruns > 0);
+
+        [[maybe_unused]] const bool started = worker.start();
+        assert(started);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (worker.stats().samples_analyzed < kRing && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        worker.stop();
+        stats = worker.stats();
+        assert(stats.samples_analyzed == kRing && stats.backlog_samples == 0);
+        assert(stats.max_backlog_samples == kRing);
+        assert(frames.size() == kRing / 256 && stats.frames == frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            assert(same_frame(frames[i], expected[i]));
+        }
+        pt_dsp_destroy(dsp);
+    }
+
+    // Zero frame and hop sizes take pt_dsp_create's defaults; the worker
+    // chunks its input by the hop the instance actually runs with.
+    {
+        DSPConfig cfg = worker_config();
+        cfg.frame_size = 0;
+        cfg.hop_size = 0;
+        const std::vector<DSPFrameOutput> reference = reference_frames(source, cfg);
+        PT_DSP* dsp = pt_dsp_create(cfg);
+        std::vector<DSPFrameOutput> frames;
+        pt_dsp::AnalysisWorker worker(dsp, cfg, collect, &frames);
+        const size_t n = 4 * 1024;
+        [[maybe_unused]] const size_t pushed = worker.push(source.data(), n);
+        assert(pushed == n);
+        [[maybe_unused]] const bool started = worker.start();
+        assert(started);
+        worker.stop();
+        [[maybe_unused]] const pt_dsp::AnalysisWorkerStats stats = worker.stats();
+        assert(stats.samples_analyzed == n && frames.size() == 4 && stats.frames == 4);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            assert(same_frame(frames[i], reference[i]));
+        }
+        pt_dsp_destroy(dsp);
+    }
+    return 0;
+}
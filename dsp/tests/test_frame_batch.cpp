@@ -0,0 +1,66 @@
+#include "pt_dsp/frame_batch.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+bool same_bits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+[[maybe_unused]] bool same_frame(const DSPFrameOutput& a, const DSPFrameOutput& b) {
+    return same_bits(a.timestamp_ms, b.timestamp_ms) && same_bits(a.freq_hz, b.freq_hz) &&
+           same_bits(a.midi_float, b.midi_float) && a.nearest_midi == b.nearest_midi &&
+           same_bits(a.cents_error, b.cents_error) && same_bits(a.confidence, b.confidence) &&
+           a.vibrato_detected == b.vibrato_detected && same_bits(a.vibrato_rate_hz, b.vibrato_rate_hz) &&
+           same_bits(a.vibrato_depth_cents, b.vibrato_depth_cents);
+}
+}  // namespace
+
+int main() {
+    std::vector<DSPFrameOutput> frames(40);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        DSPFrameOutput& f = frames[i];
+        f.timestamp_ms = 5.333 * static_cast<double>(i);
+        f.freq_hz = 110.0 + 7.25 * static_cast<double>(i);
+        f.midi_float = 45.0 + 0.1 * static_cast<double>(i);
+        f.nearest_midi = i % 5 == 0 ? -1 : 45 + static_cast<int>(i);
+        f.cents_error = -49.5 + 2.5 * static_cast<double>(i);
+        f.confidence = static_cast<double>(i) / 40.0;
+        f.vibrato_detected = i % 3 == 0;
+        f.vibrato_rate_hz = i % 3 == 0 ? 5.5 : NAN;
+        f.vibrato_depth_cents = i % 3 == 0 ? 30.0 : NAN;
+    }
+
+    // Round trip is bit-exact, NaN and negative fields included.
+    std::vector<uint8_t> bytes(frames.size() * pt_dsp::kPackedFrameBytes, 0xAB);
+    [[maybe_unused]] size_t packed = pt_dsp::pack_frames(frames.data(), frames.size(), bytes.data(), bytes.size());
+    assert(packed == frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        assert(same_frame(pt_dsp::unpack_frame(bytes.data() + i * pt_dsp::kPackedFrameBytes), frames[i]));
+    }
+
+    // Fields sit at the documented offsets, which the JVM side reads directly.
+    const uint8_t* record = bytes.data() + 3 * pt_dsp::kPackedFrameBytes;
+    double freq = 0.0;
+    int32_t midi = 0;
+    uint32_t flags = 0;
+    std::memcpy(&freq, record + pt_dsp::kPackedFreqHz, sizeof(freq));
+    std::memcpy(&midi, record + pt_dsp::kPackedNearestMidi, sizeof(midi));
+    std::memcpy(&flags, record + pt_dsp::kPackedFlags, sizeof(flags));
+    assert(freq == frames[3].freq_hz && midi == frames[3].nearest_midi && flags == pt_dsp::kPackedFlagVibrato);
+    // Little-endian: the low byte comes first.
+    assert(record[pt_dsp::kPackedNearestMidi] == 48 && record[pt_dsp::kPackedNearestMidi + 3] == 0);
+
+    // Packing stops at the last whole record that fits and leaves the rest.
+    std::vector<uint8_t> small(2 * pt_dsp::kPackedFrameBytes + 10, 0xCD);
+    packed = pt_dsp::pack_frames(frames.data(), frames.size(), small.data(), small.size());
+    assert(packed == 2);
+    for (size_t i = 2 * pt_dsp::kPackedFrameBytes; i < small.size(); ++i) {
+        assert(small[i] == 0xCD);
+    }
+    packed = pt_dsp::pack_frames(frames.data(), frames.size(), small.data(), pt_dsp::kPackedFrameBytes - 1);
+    assert(packed == 0);
+    return 0;
+}
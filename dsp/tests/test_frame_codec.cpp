@@ -0,0 +1,158 @@
+#include "pt_dsp/frame_codec.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+
+// A sung-like line: notes with vibrato separated by silence, through the DSP.
+std::vector<DSPFrameOutput> analysed_frames() {
+    DSPConfig cfg{};
+    cfg.a4_hz = 442.0;
+    cfg.sample_rate_hz = kSampleRate;
+    cfg.frame_size = 1024;
+    cfg.hop_size = 256;
+    std::vector<float> pcm(6 * kSampleRate, 0.0f);
+    double phase = 0.0;
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        const double note_hz = t < 2.0 ? 220.0 : 329.63;
+        const double hz = note_hz * std::exp2(40.0 * std::sin(2.0 * M_PI * 5.5 * t) / 1200.0);
+        phase += 2.0 * M_PI * hz / kSampleRate;
+        const bool silent = t > 2.6 && t < 3.0;
+        pcm[i] = silent ? 0.0f : static_cast<float>(0.5 * std::sin(phase));
+    }
+    PT_DSP* dsp = pt_dsp_create(cfg);
+    std::vector<DSPFrameOutput> frames(pcm.size() / 256);
+    [[maybe_unused]] const int n = pt_dsp_push(dsp, pcm.data(), static_cast<int>(pcm.size()), frames.data(),
+                              static_cast<int>(frames.size()));
+    assert(n == static_cast<int>(frames.size()));
+    pt_dsp_destroy(dsp);
+    return frames;
+}
+
+[[maybe_unused]] bool both_nan_or_within(double a, double b, double tolerance) {
+    return std::isnan(a) ? std::isnan(b) : std::fabs(a - b) <= tolerance;
+}
+
+DSPFrameOutput voiced_frame(double timestamp_ms, double cents) {
+    DSPFrameOutput f{};
+    f.timestamp_ms = timestamp_ms;
+    f.nearest_midi = 69;
+    f.cents_error = cents;
+    f.midi_float = 69.0 + cents / 100.0;
+    f.freq_hz = 440.0 * std::exp2(cents / 1200.0);
+    f.confidence = 0.9;
+    f.vibrato_rate_hz = NAN;
+    f.vibrato_depth_cents = NAN;
+    return f;
+}
+}  // namespace
+
+int main() {
+    static_assert(sizeof(DSPFrameOutput) >= 6 * PT_DSP_PACKED_FRAME_BYTES, "at least 6x smaller");
+
+    // Round trip of real DSP output stays within half a quantisation step of
+    // every field and keeps flags, notes and NaNs exactly.
+    {
+        const std::vector<DSPFrameOutput> frames = analysed_frames();
+        std::vector<uint8_t> records(frames.size() * PT_DSP_PACKED_FRAME_BYTES);
+        PTPackedFrameHeader header{};
+        [[maybe_unused]] size_t n = pt_dsp_encode_frames(frames.data(), frames.size(), 442.0, &header, records.data());
+        assert(n == frames.size());
+        assert(header.frame_count == frames.size() && header.version == PT_DSP_PACKED_FRAME_VERSION);
+        std::vector<DSPFrameOutput> decoded(frames.size());
+        n = pt_dsp_decode_frames(&header, records.data(), decoded.data());
+        assert(n == frames.size());
+
+        size_t voiced = 0;
+        size_t vibrato = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const DSPFrameOutput& a = frames[i];
+            [[maybe_unused]] const DSPFrameOutput& b = decoded[i];
+            assert(std::fabs(a.timestamp_ms - b.timestamp_ms) <= 0.005 + 1e-9);
+            assert(std::fabs(a.confidence - b.confidence) <= 0.5 / 65535.0 + 1e-12);
+            assert(a.nearest_midi == b.nearest_midi && a.vibrato_detected == b.vibrato_detected);
+            assert(both_nan_or_within(a.cents_error, b.cents_error, 0.005 + 1e-9));
+            assert(both_nan_or_within(a.midi_float, b.midi_float, 0.00005 + 1e-9));
+            assert(both_nan_or_within(a.vibrato_depth_cents, b.vibrato_depth_cents, 0.005 + 1e-9));
+            assert(both_nan_or_within(a.vibrato_rate_hz, b.vibrato_rate_hz, 0.05 + 1e-9));
+            if (std::isfinite(a.freq_hz)) {
+                assert(std::fabs(1200.0 * std::log2(b.freq_hz / a.freq_hz)) <= 0.005 + 1e-6);
+                ++voiced;
+            } else {
+                assert(std::isnan(b.freq_hz));
+            }
+            vibrato += a.vibrato_detected ? 1 : 0;
+        }
+        assert(voiced > frames.size() / 2 && voiced < frames.size() && vibrato > 0);
+
+        // Decoded frames encode back to the same bytes.
+        std::vector<uint8_t> again(records.size());
+        PTPackedFrameHeader header2{};
+        n = pt_dsp_encode_frames(decoded.data(), decoded.size(), 442.0, &header2, again.data());
+        assert(n == frames.size());
+        assert(again == records && header2.base_ticks == header.base_ticks);
+
+        PTPackedFrameHeader bad = header;
+        bad.version = PT_DSP_PACKED_FRAME_VERSION + 1;
+        n = pt_dsp_decode_frames(&bad, records.data(), decoded.data());
+        assert(n == 0);
+    }
+
+    // A block ends before a gap its deltas cannot hold or a step backwards.
+    {
+        const DSPFrameOutput frames[] = {voiced_frame(1000.0, 1.0), voiced_frame(1005.333, 2.0),
+                                         voiced_frame(1661.0, 3.0), voiced_frame(1666.0, 4.0)};
+        uint8_t records[4 * PT_DSP_PACKED_FRAME_BYTES];
+        PTPackedFrameHeader header{};
+        [[maybe_unused]] size_t n = pt_dsp_encode_frames(frames, 4, 440.0, &header, records);
+        assert(n == 2 && header.frame_count == 2 && header.base_ticks == 100000);
+        n = pt_dsp_encode_frames(frames + 2, 2, 440.0, &header, records);
+        assert(n == 2);
+        const DSPFrameOutput backwards[] = {voiced_frame(10.0, 0.0), voiced_frame(9.0, 0.0)};
+        n = pt_dsp_encode_frames(backwards, 2, 440.0, &header, records);
+        assert(n == 1);
+        n = pt_dsp_encode_frames(frames, 0, 440.0, &header, records);
+        assert(n == 0 && header.frame_count == 0);
+        const double out_of_range[] = {NAN, INFINITY, -1e300, 1e300, 1e17};  // last is 1e19 ticks
+        for (double t : out_of_range) {
+            const DSPFrameOutput unencodable[] = {voiced_frame(t, 0.0), voiced_frame(t, 0.0)};
+            header.base_ticks = 1;
+            n = pt_dsp_encode_frames(unencodable, 2, 440.0, &header, records);
+            assert(n == 0 && header.frame_count == 0 && header.base_ticks == 0);
+        }
+        const DSPFrameOutput late[] = {voiced_frame(4e16, 0.0), voiced_frame(4e16 + 5.0, 0.0)};
+        n = pt_dsp_encode_frames(late, 2, 440.0, &header, records);
+        assert(n == 2 && header.base_ticks == 4000000000000000000);
+    }
+
+    // Out-of-range values are clamped, and pitches without a storable note
+    // become unvoiced.
+    {
+        DSPFrameOutput frames[] = {voiced_frame(0.0, 400.0), voiced_frame(5.0, -0.004), voiced_frame(10.0, 0.0)};
+        frames[1].confidence = NAN;
+        frames[2].nearest_midi = 300;
+        frames[2].vibrato_detected = true;
+        frames[2].vibrato_rate_hz = 40.0;
+        frames[2].vibrato_depth_cents = 12.346;
+        uint8_t records[3 * PT_DSP_PACKED_FRAME_BYTES];
+        PTPackedFrameHeader header{};
+        [[maybe_unused]] const size_t encoded = pt_dsp_encode_frames(frames, 3, 440.0, &header, records);
+        assert(encoded == 3);
+        DSPFrameOutput decoded[3];
+        [[maybe_unused]] const size_t decoded_count = pt_dsp_decode_frames(&header, records, decoded);
+        assert(decoded_count == 3);
+        assert(decoded[0].cents_error == 327.67);
+        assert(decoded[1].cents_error == 0.0 && decoded[1].confidence == 0.0);
+        assert(decoded[2].nearest_midi == -1 && std::isnan(decoded[2].freq_hz));
+        assert(decoded[2].vibrato_detected && decoded[2].vibrato_rate_hz == 25.5);
+        assert(std::fabs(decoded[2].vibrato_depth_cents - 12.35) < 1e-12);
+        assert(decoded[2].timestamp_ms == 10.0);
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include "kernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+using pt_dsp::KernelIsa;
+using pt_dsp::KernelOps;
+using pt_dsp::Kernels;
+
+// Relative tolerance per sample type: variants only reorder the summations.
+template <typename T>
+constexpr double kTolerance = 1e-12;
+template <>
+constexpr double kTolerance<float> = 2e-5;
+
+template <typename T>
+bool close(T expected, T actual, double scale) {
+    return std::abs(static_cast<double>(expected) - static_cast<double>(actual)) <=
+           kTolerance<T> * std::max(1.0, std::abs(scale));
+}
+
+std::vector<float> make_noise(int n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> out(n);
+    for (float& v : out) {
+        v = dist(rng);
+    }
+    return out;
+}
+
+template <typename T>
+void check_ops(const KernelOps<T>& k, const KernelOps<T>& ref) {
+    // Odd sizes and offsets exercise every vector tail and unaligned loads.
+    for (int n : {0, 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 255, 256, 1023, 1024, 4095, 4096}) {
+        const auto x = make_noise(n + 3, static_cast<unsigned>(n) + 1);
+        const float* input = x.data() + 1;
+
+        const T ref_sum = ref.sum(input, n);
+        [[maybe_unused]] const T sum = k.sum(input, n);
+        assert(close(ref_sum, sum, n));
+
+        const T mean = n > 0 ? ref_sum / static_cast<T>(n) : T(0);
+        std::vector<T> ref_centered(n + 1, T(-7));
+        std::vector<T> centered(n + 1, T(-7));
+        [[maybe_unused]] const T ref_energy = ref.center(input, n, mean, ref_centered.data());
+        [[maybe_unused]] const T energy = k.center(input, n, mean, centered.data());
+        assert(close(ref_energy, energy, ref_energy));
+        for (int i = 0; i < n; ++i) {
+            assert(close(ref_centered[i], centered[i], 1.0));
+        }
+        assert(centered[n] == T(-7));
+
+        if (n >= 2) {
+            const int half = n / 2;
+            [[maybe_unused]] const T ref_sq = ref.sum_sq_diff(ref_centered.data(), ref_centered.data() + 1, n - 1);
+            [[maybe_unused]] const T sq = k.sum_sq_diff(ref_centered.data(), ref_centered.data() + 1, n - 1);
+            assert(close(ref_sq, sq, ref_sq));
+            [[maybe_unused]] const T ref_sq32 = ref.sum_sq_diff_f32(input, input + half, n - half);
+            [[maybe_unused]] const T sq32 = k.sum_sq_diff_f32(input, input + half, n - half);
+            assert(close(ref_sq32, sq32, ref_sq32));
+        }
+    }
+
+    for (int n : {64, 257, 1024, 4096}) {
+        const auto x = make_noise(n, 99u + static_cast<unsigned>(n));
+        std::vector<T> centered(n);
+        ref.center(x.data(), n, T(0), centered.data());
+        const int min_lag = 43;
+        const int max_lag = std::min(n - 1, 600);
+        std::vector<T> ref_diff(n, T(0));
+        std::vector<T> diff(n, T(0));
+        ref.difference(centered.data(), n, min_lag, max_lag, ref_diff.data());
+        k.difference(centered.data(), n, min_lag, max_lag, diff.data());
+        for (int lag = min_lag; lag <= max_lag; ++lag) {
+            assert(close(ref_diff[lag], diff[lag], ref_diff[lag]));
+        }
+
+        // Every tail length of the prefix-sum loop, plus the near-zero branch.
+        for (int end = min_lag + 1; end <= max_lag; end += (end < min_lag + 20 ? 1 : 97)) {
+            std::vector<T> ref_cmndf(n, T(-1));
+            std::vector<T> cmndf(n, T(-1));
+            ref.cmndf(ref_diff.data(), min_lag, end, ref_cmndf.data());
+            k.cmndf(ref_diff.data(), min_lag, end, cmndf.data());
+            for (int lag = min_lag; lag <= end; ++lag) {
+                assert(close(ref_cmndf[lag], cmndf[lag], ref_cmndf[lag]));
+            }
+            if (end + 1 < n) {
+                assert(cmndf[end + 1] == T(-1));
+            }
+            // Compact instances write the CMNDF over the difference function.
+            std::vector<T> in_place = ref_diff;
+            k.cmndf(in_place.data(), min_lag, end, in_place.data());
+            for (int lag = min_lag; lag <= end; ++lag) {
+                assert(in_place[lag] == cmndf[lag]);
+            }
+        }
+        std::vector<T> zeros(n, T(0));
+        std::vector<T> cmndf(n, T(-1));
+        k.cmndf(zeros.data(), min_lag, max_lag, cmndf.data());
+        for (int lag = min_lag; lag <= max_lag; ++lag) {
+            assert(cmndf[lag] == T(1));
+        }
+    }
+}
+
+// The structure-of-arrays kernels must match the per-stream scalar loops lane by lane.
+void check_batch(const Kernels& k) {
+    constexpr int L = pt_dsp::kBatchLanes;
+    const KernelOps<double>& ref = pt_dsp::scalar_kernels().f64;
+    for (int n : {1, 2, 3, 5, 64, 257, 1024}) {
+        std::vector<std::vector<double>> lanes(L);
+        std::vector<double> soa(static_cast<size_t>(n) * L);
+        for (int s = 0; s < L; ++s) {
+            const auto x = make_noise(n, 500u + static_cast<unsigned>(n * L + s));
+            lanes[s].assign(x.begin(), x.end());
+            for (int i = 0; i < n; ++i) {
+                soa[static_cast<size_t>(i) * L + s] = lanes[s][i];
+            }
+        }
+        const int min_lag = std::min(n - 1, 3);
+        const int max_lag = n - 1;
+        std::vector<double> diff_soa(static_cast<size_t>(n) * L, 0.0);
+        for (int lag = min_lag; lag <= max_lag; ++lag) {
+            k.sum_sq_diff_x8(soa.data(), soa.data() + lag * L, n - lag, diff_soa.data() + lag * L);
+        }
+        std::vector<double> cmndf_soa(static_cast<size_t>(n) * L, -1.0);
+        k.cmndf_x8(diff_soa.data(), min_lag, max_lag, cmndf_soa.data());
+        for (int s = 0; s < L; ++s) {
+            std::vector<double> diff(n, 0.0);
+            std::vector<double> cmndf(n, -1.0);
+            ref.difference(lanes[s].data(), n, min_lag, max_lag, diff.data());
+            ref.cmndf(diff.data(), min_lag, max_lag, cmndf.data());
+            for (int lag = min_lag; lag <= max_lag; ++lag) {
+                assert(close(diff[lag], diff_soa[lag * L + s], diff[lag]));
+                assert(close(cmndf[lag], cmndf_soa[lag * L + s], cmndf[lag]));
+            }
+        }
+    }
+    // Silent lanes take the near-zero branch without disturbing their neighbours.
+    std::vector<double> zeros(64 * L, 0.0);
+    std::vector<double> cmndf(64 * L, -1.0);
+    k.cmndf_x8(zeros.data(), 2, 63, cmndf.data());
+    for (int i = 2 * L; i < 64 * L; ++i) {
+        assert(cmndf[i] == 1.0);
+    }
+}
+
+// Shape-specialised differences must match the generic scalar difference
+// over their lag range and write nothing outside it.
+template <typename T>
+void check_shape(const pt_dsp::ShapeKernels& shape) {
+    const int n = shape.frame_size;
+    assert(shape.min_lag == pt_dsp::min_lag_for(shape.sample_rate_hz));
+    assert(shape.max_lag == pt_dsp::max_lag_for(shape.sample_rate_hz, n));
+    const KernelOps<T>& ref = pt_dsp::scalar_kernels().ops<T>();
+    const auto x = make_noise(n, 700u + static_cast<unsigned>(n + shape.sample_rate_hz));
+    std::vector<T> centered(n);
+    ref.center(x.data(), n, T(0), centered.data());
+    std::vector<T> ref_diff(n + 1, T(-3));
+    std::vector<T> diff(n + 1, T(-3));
+    ref.difference(centered.data(), n, shape.min_lag, shape.max_lag, ref_diff.data());
+    shape.difference(centered.data(), diff.data());
+    for (int lag = 0; lag <= n; ++lag) {
+        if (lag < shape.min_lag || lag > shape.max_lag) {
+            assert(diff[lag] == T(-3));
+            continue;
+        }
+        assert(close(ref_diff[lag], diff[lag], ref_diff[lag]));
+    }
+}
+
+void check_shapes(const Kernels& k) {
+    for (int i = 0; i < k.shape_count; ++i) {
+        const pt_dsp::ShapeKernels& shape = k.shapes[i];
+        assert(pt_dsp::shape_kernels_for(k, shape.sample_rate_hz, shape.frame_size) == &shape);
+        check_shape<double>(shape);
+        check_shape<float>(shape);
+    }
+    assert(pt_dsp::shape_kernels_for(k, 16000, 1024) == nullptr);
+    assert(pt_dsp::shape_kernels_for(k, 48000, 2048) == nullptr);
+}
+
+void check_variant(const Kernels& k) {
+    const Kernels& ref = pt_dsp::scalar_kernels();
+    check_ops(k.f64, ref.f64);
+    check_ops(k.f32, ref.f32);
+    check_batch(k);
+    check_shapes(k);
+}
+}  // namespace
+
+int main() {
+    const Kernels& best = pt_dsp::best_kernels();
+    assert(pt_dsp::kernels_for(best.isa) == &best);
+    assert(pt_dsp::kernels_for(KernelIsa::kScalar) == &pt_dsp::scalar_kernels());
+
+    check_batch(pt_dsp::scalar_kernels());
+    check_shapes(pt_dsp::scalar_kernels());
+
+    int checked = 0;
+    for (KernelIsa isa : {KernelIsa::kSse2, KernelIsa::kAvx2, KernelIsa::kAvx512, KernelIsa::kNeon}) {
+        const Kernels* k = pt_dsp::kernels_for(isa);
+        if (k == nullptr) {
+            continue;
+        }
+        check_variant(*k);
+        std::printf("kernels_%s=PASS\n", k->name);
+        ++checked;
+    }
+    std::printf("checked_variants=%d best=%s\n", checked, best.name);
+    return 0;
+}
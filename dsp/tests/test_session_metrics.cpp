@@ -0,0 +1,333 @@
+#include "pt_dsp/session_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr double kHopMs = 256.0 / 48000.0 * 1000.0;
+
+// Straight port of TrainingEngine.onDspFrame and LiveSessionCoordinator's
+// metrics, keeping every error like the Dart code does.
+class ReferenceSession {
+public:
+    explicit ReferenceSession(const PTSessionMetricsConfig& cfg) : cfg_(cfg), countdown_(cfg.countdown_ms) {}
+
+    void add(const DSPFrameOutput& frame) {
+        const int64_t ts = static_cast<int64_t>(frame.timestamp_ms);
+        const int64_t dt = has_last_ ? std::max<int64_t>(0, ts - last_) : 0;
+        has_last_ = true;
+        last_ = ts;
+        on_frame(frame, ts, dt);
+        active_ += dt;
+        if (state_ == PT_SESSION_LOCKED) {
+            locked_ += dt;
+        }
+        if (!std::isnan(effective_)) {
+            errors_.push_back(effective_);
+        }
+    }
+
+    void check([[maybe_unused]] const PTSessionMetrics& m) const {
+        double abs_sum = 0.0;
+        double sum = 0.0;
+        for (double e : errors_) {
+            abs_sum += std::fabs(e);
+            sum += e;
+        }
+        [[maybe_unused]] double avg = 0.0;
+        [[maybe_unused]] double stability = 0.0;
+        if (!errors_.empty()) {
+            const double mean = sum / errors_.size();
+            double variance = 0.0;
+            for (double e : errors_) {
+                variance += (e - mean) * (e - mean);
+            }
+            avg = abs_sum / errors_.size();
+            stability = std::sqrt(variance / errors_.size());
+        }
+        assert(m.state == state_);
+        assert(m.drift_count == drifts_);
+        assert(m.active_duration_ms == active_);
+        assert(m.locked_duration_ms == locked_);
+        assert(m.lock_ratio == (active_ == 0 ? 0.0 : std::min(1.0, double(locked_) / double(active_))));
+        assert(m.avg_error_cents == avg);
+        assert(std::fabs(m.stability_cents - stability) < 1e-9);
+    }
+
+private:
+    static bool usable(const DSPFrameOutput& f) {
+        return std::isfinite(f.freq_hz) && std::isfinite(f.cents_error) && f.nearest_midi >= 0;
+    }
+
+    double clamp(double cents) const {
+        return std::min(std::max(cents, -cfg_.cents_error_clamp), cfg_.cents_error_clamp);
+    }
+
+    double effective_error(const DSPFrameOutput& f, int64_t ts) {
+        recent_.push_back({ts, f.cents_error});
+        while (!recent_.empty() && ts - recent_.front().first > cfg_.effective_error_window_ms) {
+            recent_.pop_front();
+        }
+        const bool vibrato = f.vibrato_detected && std::isfinite(f.vibrato_rate_hz) &&
+                             std::isfinite(f.vibrato_depth_cents) && f.vibrato_rate_hz >= cfg_.vibrato_rate_min_hz &&
+                             f.vibrato_rate_hz <= cfg_.vibrato_rate_max_hz &&
+                             f.vibrato_depth_cents <= cfg_.vibrato_depth_limit_cents;
+        if (!vibrato) {
+            return clamp(f.cents_error);
+        }
+        double sum = 0.0;
+        for (const auto& r : recent_) {
+            sum += r.second;
+        }
+        return clamp(sum / recent_.size());
+    }
+
+    void on_frame(const DSPFrameOutput& f, int64_t ts, int64_t dt) {
+        if (state_ == PT_SESSION_LOW_CONFIDENCE) {
+            if (!usable(f) || f.confidence < cfg_.recovery_confidence) {
+                effective_ = NAN;
+                return;
+            }
+            state_ = return_state_;
+        } else if (!usable(f) || f.confidence < cfg_.min_confidence) {
+            return_state_ = state_;
+            state_ = PT_SESSION_LOW_CONFIDENCE;
+            effective_ = NAN;
+            return;
+        }
+        const double error = effective_error(f, ts);
+        const double abs_error = std::fabs(error);
+        if (state_ == PT_SESSION_COUNTDOWN) {
+            countdown_ = std::max<int64_t>(0, countdown_ - dt);
+            if (countdown_ == 0) {
+                state_ = PT_SESSION_SEEKING_LOCK;
+                effective_ = error;
+            }
+            return;
+        }
+        PTSessionState next = state_;
+        if (state_ == PT_SESSION_SEEKING_LOCK) {
+            within_ = abs_error <= cfg_.tolerance_cents ? within_ + dt : 0;
+            if (within_ >= cfg_.lock_acquire_ms) {
+                next = PT_SESSION_LOCKED;
+                locked_time_ = 0;
+                outside_ = 0;
+            }
+        } else if (state_ == PT_SESSION_LOCKED) {
+            locked_time_ += dt;
+            if (locked_time_ >= cfg_.lock_required_before_drift_ms) {
+                outside_ = abs_error > cfg_.drift_threshold_cents ? outside_ + dt : 0;
+                if (outside_ >= cfg_.drift_candidate_ms) {
+                    next = PT_SESSION_DRIFT_CANDIDATE;
+                    outside_ = 0;
+                }
+            }
+        } else if (state_ == PT_SESSION_DRIFT_CANDIDATE) {
+            if (abs_error <= cfg_.tolerance_cents) {
+                outside_ = 0;
+                next = PT_SESSION_LOCKED;
+            } else if (abs_error > cfg_.drift_threshold_cents) {
+                outside_ += dt;
+                if (outside_ >= cfg_.drift_confirm_ms) {
+                    next = PT_SESSION_DRIFT_CONFIRMED;
+                    ++drifts_;
+                }
+            }
+        } else if (state_ == PT_SESSION_DRIFT_CONFIRMED && cfg_.drift_awareness_mode &&
+                   abs_error <= cfg_.tolerance_cents) {
+            next = PT_SESSION_SEEKING_LOCK;
+            outside_ = 0;
+            within_ = 0;
+        }
+        state_ = next;
+        effective_ = error;
+    }
+
+    PTSessionMetricsConfig cfg_;
+    PTSessionState state_ = PT_SESSION_COUNTDOWN;
+    PTSessionState return_state_ = PT_SESSION_COUNTDOWN;
+    bool has_last_ = false;
+    int64_t last_ = 0;
+    int64_t countdown_;
+    int64_t within_ = 0;
+    int64_t outside_ = 0;
+    int64_t locked_time_ = 0;
+    double effective_ = NAN;
+    std::deque<std::pair<int64_t, double>> recent_;
+    std::vector<double> errors_;
+    int64_t active_ = 0;
+    int64_t locked_ = 0;
+    int64_t drifts_ = 0;
+};
+
+DSPFrameOutput frame_at(double t_ms, double cents, double confidence, bool vibrato) {
+    DSPFrameOutput f{};
+    f.timestamp_ms = t_ms;
+    f.nearest_midi = 60;
+    f.cents_error = cents;
+    f.midi_float = 60.0 + cents / 100.0;
+    f.freq_hz = 261.63 * std::exp2(cents / 1200.0);
+    f.confidence = confidence;
+    f.vibrato_detected = vibrato;
+    f.vibrato_rate_hz = vibrato ? 5.5 : NAN;
+    f.vibrato_depth_cents = vibrato ? 25.0 : NAN;
+    return f;
+}
+
+DSPFrameOutput unvoiced_at(double t_ms) {
+    DSPFrameOutput f = frame_at(t_ms, 0.0, 0.2, false);
+    f.freq_hz = NAN;
+    f.midi_float = NAN;
+    f.nearest_midi = -1;
+    f.cents_error = NAN;
+    return f;
+}
+
+// A take that goes through every state: countdown, settling in, a long lock
+// with vibrato, a slow drift flat, a confident return, breaths, and a drop
+// of a few frames.
+std::vector<DSPFrameOutput> scripted_take() {
+    std::vector<DSPFrameOutput> frames;
+    uint32_t noise = 12345;
+    const auto jitter = [&noise]() {
+        noise = noise * 1664525u + 1013904223u;
+        return static_cast<double>(noise >> 8) / (1u << 24) - 0.5;
+    };
+    for (int i = 0; i < 3000; ++i) {
+        const double t = 40.0 + i * kHopMs;
+        const double s = t / 1000.0;
+        if ((s > 9.0 && s < 9.4) || (s > 14.0 && s < 14.1)) {
+            frames.push_back(unvoiced_at(t));
+            continue;
+        }
+        if (s > 11.0 && s < 11.05) {
+            continue;  // frames lost on the way
+        }
+        double cents = 30.0 * std::exp(-s) + 4.0 * jitter();
+        const bool vibrato = s > 5.0 && s < 8.0;
+        if (vibrato) {
+            cents += 25.0 * std::sin(2.0 * M_PI * 5.5 * s);
+        }
+        if (s > 10.0 && s < 12.5) {
+            cents -= 20.0 * (s - 10.0);  // drifting flat, up to 50 cents
+        }
+        const double confidence = s > 3.5 && s < 3.6 ? 0.62 : 0.9 + 0.05 * jitter();
+        frames.push_back(frame_at(t, cents, confidence, vibrato));
+    }
+    return frames;
+}
+
+void run_against_reference(const PTSessionMetricsConfig& cfg, int batch) {
+    const auto frames = scripted_take();
+    PT_SESSION_METRICS* metrics = pt_dsp_session_metrics_create(&cfg);
+    assert(metrics != nullptr);
+    ReferenceSession reference(cfg);
+    PTSessionMetrics m;
+    for (size_t i = 0; i < frames.size(); i += batch) {
+        const int n = static_cast<int>(std::min<size_t>(batch, frames.size() - i));
+        [[maybe_unused]] const int added = pt_dsp_session_metrics_add(metrics, frames.data() + i, n);
+        assert(added == 0);
+        for (int k = 0; k < n; ++k) {
+            reference.add(frames[i + k]);
+        }
+        [[maybe_unused]] const bool snapped = pt_dsp_session_metrics_snapshot(metrics, &m);
+        assert(snapped);
+        reference.check(m);
+    }
+    assert(m.frames == frames.size());
+    pt_dsp_session_metrics_destroy(metrics);
+}
+
+void test_matches_reference() {
+    PTSessionMetricsConfig cfg = pt_dsp_session_metrics_default_config();
+    run_against_reference(cfg, 1);
+    run_against_reference(cfg, 64);
+    cfg.drift_awareness_mode = true;
+    run_against_reference(cfg, 7);
+    cfg.tolerance_cents = 8.0;
+    cfg.drift_threshold_cents = 15.0;
+    cfg.countdown_ms = 0;
+    run_against_reference(cfg, 1);
+}
+
+void test_scripted_outcome() {
+    const auto frames = scripted_take();
+    PT_SESSION_METRICS* metrics = pt_dsp_session_metrics_create(nullptr);
+    [[maybe_unused]] const int added = pt_dsp_session_metrics_add(metrics, frames.data(),
+                                                                  static_cast<int>(frames.size()));
+    PTSessionMetrics m;
+    [[maybe_unused]] bool snapped = pt_dsp_session_metrics_snapshot(metrics, &m);
+    assert(added == 0 && snapped);
+    assert(m.drift_count == 1);
+    assert(m.state == PT_SESSION_DRIFT_CONFIRMED);
+    assert(m.lock_ratio > 0.3 && m.lock_ratio < 0.8);
+    assert(m.avg_error_cents > 0.0 && m.stability_cents > 0.0);
+
+    // A new session starts over in its countdown.
+    pt_dsp_session_metrics_reset(metrics);
+    snapped = pt_dsp_session_metrics_snapshot(metrics, &m);
+    assert(snapped);
+    assert(m.frames == 0 && m.active_duration_ms == 0 && m.drift_count == 0);
+    assert(m.state == PT_SESSION_COUNTDOWN);
+    pt_dsp_session_metrics_destroy(metrics);
+}
+
+void test_invalid_arguments() {
+    PT_SESSION_METRICS* metrics = pt_dsp_session_metrics_create(nullptr);
+    DSPFrameOutput nan_time = frame_at(NAN, 0.0, 0.9, false);
+    [[maybe_unused]] int added = pt_dsp_session_metrics_add(metrics, &nan_time, 1);
+    PTSessionMetrics m;
+    [[maybe_unused]] bool snapped = pt_dsp_session_metrics_snapshot(metrics, &m);
+    assert(added == 0 && snapped && m.frames == 0);
+    added = pt_dsp_session_metrics_add(nullptr, &nan_time, 1);
+    assert(added == -1);
+    added = pt_dsp_session_metrics_add(metrics, nullptr, 1);
+    assert(added == -1);
+    added = pt_dsp_session_metrics_add(metrics, &nan_time, -1);
+    assert(added == -1);
+    snapped = pt_dsp_session_metrics_snapshot(metrics, nullptr);
+    assert(!snapped);
+    snapped = pt_dsp_session_metrics_snapshot(nullptr, &m);
+    assert(!snapped);
+    pt_dsp_session_metrics_destroy(metrics);
+    pt_dsp_session_metrics_destroy(nullptr);
+}
+
+// Snapshots polled from another thread are always whole: each one matches
+// the frame count it reports.
+void test_concurrent_snapshots() {
+    PT_SESSION_METRICS* metrics = pt_dsp_session_metrics_create(nullptr);
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        PTSessionMetrics m;
+        [[maybe_unused]] uint64_t last_frames = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            [[maybe_unused]] const bool snapped = pt_dsp_session_metrics_snapshot(metrics, &m);
+            assert(snapped && m.frames >= last_frames);
+            assert(m.active_duration_ms == (m.frames == 0 ? 0 : static_cast<int64_t>(m.frames - 1) * 5));
+            last_frames = m.frames;
+        }
+    });
+    for (int i = 0; i < 20000; ++i) {
+        const DSPFrameOutput f = frame_at(i * 5.0, 3.0, 0.9, false);
+        [[maybe_unused]] const int added = pt_dsp_session_metrics_add(metrics, &f, 1);
+        assert(added == 0);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    pt_dsp_session_metrics_destroy(metrics);
+}
+}  // namespace
+
+int main() {
+    test_matches_reference();
+    test_scripted_outcome();
+    test_invalid_arguments();
+    test_concurrent_snapshots();
+    return 0;
+}
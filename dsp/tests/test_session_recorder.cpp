@@ -0,0 +1,244 @@
+#include "pt_dsp/session_recorder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+constexpr double kA4 = 442.0;
+constexpr double kHopMs = 256.0 / 48000.0 * 1000.0;
+
+std::string temp_path(const char* name) {
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/pt_dsp_" + name + "_" + std::to_string(getpid()) + ".ptsr";
+}
+
+// A pitch track at hop rate starting at start_ms: voiced notes with vibrato,
+// every seventh frame unvoiced.
+std::vector<DSPFrameOutput> track(size_t count, double start_ms) {
+    std::vector<DSPFrameOutput> frames(count);
+    for (size_t i = 0; i < count; ++i) {
+        DSPFrameOutput& f = frames[i];
+        f.timestamp_ms = start_ms + static_cast<double>(i) * kHopMs;
+        f.confidence = 0.5 + 0.4 * std::sin(static_cast<double>(i) * 0.1);
+        if (i % 7 == 3) {
+            f.freq_hz = NAN;
+            f.midi_float = NAN;
+            f.nearest_midi = -1;
+            f.cents_error = NAN;
+        } else {
+            f.nearest_midi = 57 + static_cast<int>(i / 50 % 12);
+            f.cents_error = 30.0 * std::sin(static_cast<double>(i) * 0.37);
+            f.midi_float = f.nearest_midi + f.cents_error / 100.0;
+            f.freq_hz = kA4 * std::exp2((f.midi_float - 69.0) / 12.0);
+        }
+        f.vibrato_detected = i % 3 == 0;
+        f.vibrato_rate_hz = f.vibrato_detected ? 5.5 : NAN;
+        f.vibrato_depth_cents = f.vibrato_detected ? 35.25 : NAN;
+    }
+    return frames;
+}
+
+// What a single frame_codec block makes of frames: the recorder must store
+// exactly that, whatever its chunking.
+std::vector<DSPFrameOutput> round_trip(const std::vector<DSPFrameOutput>& frames) {
+    PTPackedFrameHeader header;
+    std::vector<uint8_t> records(frames.size() * PT_DSP_PACKED_FRAME_BYTES);
+    const size_t n = pt_dsp_encode_frames(frames.data(), frames.size(), kA4, &header, records.data());
+    assert(n == frames.size());
+    std::vector<DSPFrameOutput> out(n);
+    pt_dsp_decode_frames(&header, records.data(), out.data());
+    return out;
+}
+
+[[maybe_unused]] bool same(double a, double b) {
+    return std::isnan(a) ? std::isnan(b) : a == b;
+}
+
+void assert_same([[maybe_unused]] const DSPFrameOutput& a, [[maybe_unused]] const DSPFrameOutput& b) {
+    assert(same(a.timestamp_ms, b.timestamp_ms));
+    assert(same(a.freq_hz, b.freq_hz));
+    assert(same(a.midi_float, b.midi_float));
+    assert(a.nearest_midi == b.nearest_midi);
+    assert(same(a.cents_error, b.cents_error));
+    assert(same(a.confidence, b.confidence));
+    assert(a.vibrato_detected == b.vibrato_detected);
+    assert(same(a.vibrato_rate_hz, b.vibrato_rate_hz));
+    assert(same(a.vibrato_depth_cents, b.vibrato_depth_cents));
+}
+
+std::vector<DSPFrameOutput> read_all(pt_dsp::SessionReader& reader) {
+    std::vector<DSPFrameOutput> out(reader.frame_count());
+    [[maybe_unused]] const size_t n = reader.read(0, out.size(), out.data());
+    assert(n == out.size());
+    return out;
+}
+
+// Odd-sized appends across many small chunks read back like one block, and
+// reads from any offset agree with the whole.
+void test_round_trip_across_chunks() {
+    const std::string path = temp_path("round_trip");
+    const auto frames = track(1000, 12.5);
+    pt_dsp::SessionRecorder recorder;
+    [[maybe_unused]] const bool opened = recorder.open(path, kA4, 64);
+    assert(opened);
+    for (size_t i = 0; i < frames.size();) {
+        const size_t n = std::min<size_t>(37, frames.size() - i);
+        [[maybe_unused]] const bool appended = recorder.append(frames.data() + i, n);
+        assert(appended);
+        i += n;
+    }
+    assert(recorder.frames_written() == frames.size());
+    recorder.close();
+
+    // Closing trims to the last record: 16 chunks, the last holding 40.
+    struct stat st {};
+    [[maybe_unused]] const int stat_result = stat(path.c_str(), &st);
+    assert(stat_result == 0);
+    [[maybe_unused]] const size_t stride = 64 + 64 * PT_DSP_PACKED_FRAME_BYTES;
+    assert(static_cast<size_t>(st.st_size) == 64 + 15 * stride + 64 + 40 * PT_DSP_PACKED_FRAME_BYTES);
+
+    pt_dsp::SessionReader reader;
+    [[maybe_unused]] const bool reader_open = reader.open(path);
+    assert(reader_open);
+    assert(reader.closed_cleanly());
+    assert(reader.a4_hz() == kA4);
+    assert(reader.frame_count() == frames.size());
+    const auto expected = round_trip(frames);
+    const auto all = read_all(reader);
+    for (size_t i = 0; i < all.size(); ++i) {
+        assert_same(all[i], expected[i]);
+    }
+
+    std::vector<DSPFrameOutput> part(100);
+    [[maybe_unused]] size_t n = reader.read(500, part.size(), part.data());
+    assert(n == part.size());
+    for (size_t i = 0; i < part.size(); ++i) {
+        assert_same(part[i], expected[500 + i]);
+    }
+    n = reader.read(950, part.size(), part.data());
+    assert(n == 50);
+    n = reader.read(frames.size(), part.size(), part.data());
+    assert(n == 0);
+    unlink(path.c_str());
+}
+
+// Steps a delta cannot hold start a new chunk instead of losing frames; NaN
+// timestamps are skipped.
+void test_gaps_and_restarts() {
+    const std::string path = temp_path("gaps");
+    std::vector<DSPFrameOutput> frames = track(30, 1000.0);
+    const auto later = track(30, 5000.0);    // 3.8 s gap
+    const auto earlier = track(30, 200.0);   // clock restarted
+    frames.insert(frames.end(), later.begin(), later.end());
+    frames.insert(frames.end(), earlier.begin(), earlier.end());
+    std::vector<DSPFrameOutput> with_nan = frames;
+    with_nan.insert(with_nan.begin() + 45, with_nan[45]);
+    with_nan[45].timestamp_ms = NAN;
+
+    pt_dsp::SessionRecorder recorder;
+    [[maybe_unused]] const bool opened = recorder.open(path, kA4);
+    [[maybe_unused]] const bool appended = recorder.append(with_nan.data(), with_nan.size());
+    assert(opened && appended);
+    assert(recorder.frames_written() == frames.size());
+    recorder.close();
+
+    pt_dsp::SessionReader reader;
+    [[maybe_unused]] const bool reader_open = reader.open(path);
+    assert(reader_open && reader.frame_count() == frames.size());
+    const auto all = read_all(reader);
+    for (size_t i = 0; i < all.size(); ++i) {
+        assert(std::fabs(all[i].timestamp_ms - frames[i].timestamp_ms) <= 0.005 + 1e-9);
+    }
+    unlink(path.c_str());
+}
+
+void test_seek() {
+    const std::string path = temp_path("seek");
+    const auto frames = track(500, 100.0);
+    pt_dsp::SessionRecorder recorder;
+    [[maybe_unused]] const bool opened = recorder.open(path, kA4, 32);
+    [[maybe_unused]] const bool appended = recorder.append(frames.data(), frames.size());
+    assert(opened && appended);
+    recorder.close();
+
+    pt_dsp::SessionReader reader;
+    [[maybe_unused]] const bool reader_open = reader.open(path);
+    assert(reader_open);
+    const auto stored = read_all(reader);
+    assert(reader.seek(0.0) == 0);
+    assert(reader.seek(stored[0].timestamp_ms) == 0);
+    assert(reader.seek(1e9) == reader.frame_count());
+    for ([[maybe_unused]] size_t i : {1u, 31u, 32u, 33u, 250u, 499u}) {
+        assert(reader.seek(stored[i].timestamp_ms) == i);
+        assert(reader.seek(stored[i].timestamp_ms - 0.001) == i);
+        assert(reader.seek(stored[i - 1].timestamp_ms + 0.001) == i);
+    }
+    unlink(path.c_str());
+}
+
+// A writer that dies without close leaves every frame it appended readable.
+void test_crashed_writer() {
+    const std::string path = temp_path("crash");
+    const auto frames = track(700, 0.0);
+    const pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        pt_dsp::SessionRecorder recorder;
+        if (!recorder.open(path, kA4, 128) || !recorder.append(frames.data(), 333)) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    int status = 0;
+    [[maybe_unused]] const pid_t waited = waitpid(child, &status, 0);
+    assert(waited == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    pt_dsp::SessionReader reader;
+    [[maybe_unused]] const bool reader_open = reader.open(path);
+    assert(reader_open && !reader.closed_cleanly());
+    assert(reader.frame_count() == 333);
+    const auto expected = round_trip(std::vector<DSPFrameOutput>(frames.begin(), frames.begin() + 333));
+    const auto all = read_all(reader);
+    for (size_t i = 0; i < all.size(); ++i) {
+        assert_same(all[i], expected[i]);
+    }
+    unlink(path.c_str());
+}
+
+void test_rejects_other_files() {
+    const std::string path = temp_path("other");
+    FILE* file = std::fopen(path.c_str(), "wb");
+    assert(file != nullptr);
+    const std::vector<uint8_t> junk(256, 0x5a);
+    std::fwrite(junk.data(), 1, junk.size(), file);
+    std::fclose(file);
+    pt_dsp::SessionReader reader;
+    [[maybe_unused]] bool opened = reader.open(path);
+    assert(!opened && !reader.error().empty());
+    opened = reader.open(path + ".missing");
+    assert(!opened);
+    unlink(path.c_str());
+
+    pt_dsp::SessionRecorder recorder;
+    opened = recorder.open(path, kA4, 0);
+    assert(!opened && !recorder.is_open());
+}
+}  // namespace
+
+int main() {
+    test_round_trip_across_chunks();
+    test_gaps_and_restarts();
+    test_seek();
+    test_crashed_writer();
+    test_rejects_other_files();
+    return 0;
+}
@@ -1,7 +1,10 @@
 #include "pt_dsp/dsp_api.h"
 
 #include <cassert>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -26,7 +29,7 @@ int main() {
     assert(dsp);
 
     auto buf = make_sine(cfg.sample_rate_hz, cfg.hop_size, 440.0, 0.7);
-    auto out = pt_dsp_process(dsp, buf.data(), static_cast<int>(buf.size()));
+    [[maybe_unused]] auto out = pt_dsp_process(dsp, buf.data(), static_cast<int>(buf.size()));
 
     assert(out.timestamp_ms >= 0.0);
     assert(std::isfinite(out.freq_hz));
@@ -42,17 +45,538 @@ int main() {
                                     0.05 * std::sin(2.0 * M_PI * 1000.0 * t));
     }
 
-    auto noisy_out = pt_dsp_process(dsp, buf.data(), static_cast<int>(buf.size()));
+    [[maybe_unused]] auto noisy_out = pt_dsp_process(dsp, buf.data(), static_cast<int>(buf.size()));
     assert(std::isfinite(noisy_out.freq_hz));
     assert(std::abs(noisy_out.freq_hz - 329.63) < 6.5);
     assert(noisy_out.confidence > 0.5);
 
     std::vector<float> dc_buf(cfg.hop_size, 0.1f);
-    auto dc_out = pt_dsp_process(dsp, dc_buf.data(), static_cast<int>(dc_buf.size()));
+    [[maybe_unused]] auto dc_out = pt_dsp_process(dsp, dc_buf.data(), static_cast<int>(dc_buf.size()));
     assert(!std::isfinite(dc_out.freq_hz));
     assert(dc_out.nearest_midi == -1);
     assert(dc_out.confidence == 0.0);
 
     pt_dsp_destroy(dsp);
+
+    // The FFT difference engine must track the direct loop on the same input.
+    DSPConfig fft_cfg = cfg;
+    fft_cfg.diff_engine = PT_DSP_DIFF_FFT;
+    PT_DSP* direct_dsp = pt_dsp_create(cfg);
+    PT_DSP* fft_dsp = pt_dsp_create(fft_cfg);
+    assert(direct_dsp && fft_dsp);
+    for (double hz : {98.0, 220.0, 440.0, 987.77}) {
+        auto tone = make_sine(cfg.sample_rate_hz, cfg.hop_size, hz, 0.5);
+        [[maybe_unused]] auto direct_out = pt_dsp_process(direct_dsp, tone.data(), static_cast<int>(tone.size()));
+        [[maybe_unused]] auto fft_out = pt_dsp_process(fft_dsp, tone.data(), static_cast<int>(tone.size()));
+        assert(std::isfinite(direct_out.freq_hz) && std::isfinite(fft_out.freq_hz));
+        assert(std::abs(1200.0 * std::log2(fft_out.freq_hz / direct_out.freq_hz)) < 0.01);
+        assert(std::abs(fft_out.confidence - direct_out.confidence) < 1e-6);
+    }
+    pt_dsp_destroy(direct_dsp);
+    pt_dsp_destroy(fft_dsp);
+
+    // Single precision stays within a fraction of a cent of the double path,
+    // including across sliding-difference updates and with the FFT engine.
+    for (DSPDiffEngine engine : {PT_DSP_DIFF_DIRECT, PT_DSP_DIFF_FFT}) {
+        DSPConfig f64_cfg = cfg;
+        f64_cfg.hop_size = 256;
+        f64_cfg.diff_engine = engine;
+        DSPConfig f32_cfg = f64_cfg;
+        f32_cfg.precision = PT_DSP_PRECISION_FLOAT;
+        PT_DSP* f64_dsp = pt_dsp_create(f64_cfg);
+        PT_DSP* f32_dsp = pt_dsp_create(f32_cfg);
+        assert(f64_dsp && f32_dsp);
+        for (double hz : {98.0, 220.0, 440.0, 987.77}) {
+            auto tone = make_sine(cfg.sample_rate_hz, 4800, hz, 0.5);
+            DSPFrameOutput f64_frames[32];
+            DSPFrameOutput f32_frames[32];
+            const int f64_count = pt_dsp_push(f64_dsp, tone.data(), static_cast<int>(tone.size()), f64_frames, 32);
+            [[maybe_unused]] const int f32_count = pt_dsp_push(f32_dsp, tone.data(),
+                                                               static_cast<int>(tone.size()), f32_frames, 32);
+            assert(f64_count == f32_count && f64_count <= 32);
+            for (int i = 0; i < f64_count; ++i) {
+                assert(std::isfinite(f64_frames[i].freq_hz) == std::isfinite(f32_frames[i].freq_hz));
+                if (std::isfinite(f64_frames[i].freq_hz)) {
+                    assert(std::abs(1200.0 * std::log2(f32_frames[i].freq_hz / f64_frames[i].freq_hz)) < 0.1);
+                    assert(std::abs(f32_frames[i].confidence - f64_frames[i].confidence) < 1e-3);
+                }
+            }
+        }
+        pt_dsp_destroy(f64_dsp);
+        pt_dsp_destroy(f32_dsp);
+    }
+
+    // The coarse-to-fine lag search lands on the same period as the full
+    // search, with and without sliding updates and in both precisions.
+    for (int hop : {256, 1024}) {
+        for (DSPPrecision precision : {PT_DSP_PRECISION_DOUBLE, PT_DSP_PRECISION_FLOAT}) {
+            DSPConfig full_cfg = cfg;
+            full_cfg.hop_size = hop;
+            full_cfg.precision = precision;
+            DSPConfig coarse_cfg = full_cfg;
+            coarse_cfg.lag_search = PT_DSP_LAG_SEARCH_COARSE_TO_FINE;
+            for (double hz : {82.41, 196.0, 440.0, 783.99}) {
+                PT_DSP* full_dsp = pt_dsp_create(full_cfg);
+                PT_DSP* coarse_dsp = pt_dsp_create(coarse_cfg);
+                assert(full_dsp && coarse_dsp);
+                auto tone = make_sine(cfg.sample_rate_hz, 9600, hz, 0.5);
+                for (int i = 0; i < static_cast<int>(tone.size()); ++i) {
+                    tone[i] += static_cast<float>(0.2 * std::sin(4.0 * M_PI * hz * i / cfg.sample_rate_hz));
+                }
+                DSPFrameOutput full_frames[40];
+                DSPFrameOutput coarse_frames[40];
+                const int full_count =
+                    pt_dsp_push(full_dsp, tone.data(), static_cast<int>(tone.size()), full_frames, 40);
+                [[maybe_unused]] const int coarse_count =
+                    pt_dsp_push(coarse_dsp, tone.data(), static_cast<int>(tone.size()), coarse_frames, 40);
+                assert(full_count == coarse_count && full_count > 0);
+                for (int i = 0; i < full_count; ++i) {
+                    assert(std::isfinite(full_frames[i].freq_hz) == std::isfinite(coarse_frames[i].freq_hz));
+                    if (std::isfinite(full_frames[i].freq_hz)) {
+                        assert(std::abs(1200.0 * std::log2(coarse_frames[i].freq_hz / full_frames[i].freq_hz)) < 0.25);
+                        assert(std::abs(coarse_frames[i].confidence - full_frames[i].confidence) < 5e-3);
+                    }
+                }
+                pt_dsp_destroy(full_dsp);
+                pt_dsp_destroy(coarse_dsp);
+            }
+        }
+    }
+
+    // The tracked lag search follows a gliding note and a note change with the
+    // same frames as the full search.
+    for (int hop : {256, 1024}) {
+        DSPConfig full_cfg = cfg;
+        full_cfg.hop_size = hop;
+        DSPConfig tracked_cfg = full_cfg;
+        tracked_cfg.lag_search = PT_DSP_LAG_SEARCH_TRACKED;
+        std::vector<float> phrase(cfg.sample_rate_hz);
+        double phase = 0.0;
+        for (int i = 0; i < static_cast<int>(phrase.size()); ++i) {
+            const double t = static_cast<double>(i) / cfg.sample_rate_hz;
+            const double hz = t < 0.5 ? 196.0 * std::pow(2.0, t / 6.0) : 329.63;
+            phase += 2.0 * M_PI * hz / cfg.sample_rate_hz;
+            phrase[i] = static_cast<float>(0.5 * std::sin(phase) + 0.2 * std::sin(2.0 * phase));
+        }
+        const int count = static_cast<int>(phrase.size()) / hop;
+        std::vector<DSPFrameOutput> full_frames(count);
+        std::vector<DSPFrameOutput> tracked_frames(count);
+        PT_DSP* full_dsp = pt_dsp_create(full_cfg);
+        PT_DSP* tracked_dsp = pt_dsp_create(tracked_cfg);
+        assert(full_dsp && tracked_dsp);
+        [[maybe_unused]] const int full_count =
+            pt_dsp_push(full_dsp, phrase.data(), static_cast<int>(phrase.size()), full_frames.data(), count);
+        [[maybe_unused]] const int tracked_count =
+            pt_dsp_push(tracked_dsp, phrase.data(), static_cast<int>(phrase.size()), tracked_frames.data(), count);
+        assert(full_count == count && tracked_count == count);
+        for (int i = 0; i < count; ++i) {
+            assert(std::isfinite(full_frames[i].freq_hz) == std::isfinite(tracked_frames[i].freq_hz));
+            if (std::isfinite(full_frames[i].freq_hz)) {
+                assert(std::abs(1200.0 * std::log2(tracked_frames[i].freq_hz / full_frames[i].freq_hz)) < 0.01);
+                assert(std::abs(tracked_frames[i].confidence - full_frames[i].confidence) < 1e-6);
+            }
+        }
+        pt_dsp_destroy(full_dsp);
+        pt_dsp_destroy(tracked_dsp);
+    }
+
+    // Vibrato depth and rate come from the pitch history, which keeps sliding
+    // long after it first fills. At hop 1024 its 64 frames span several
+    // vibrato cycles.
+    {
+        DSPConfig vibrato_cfg = cfg;
+        vibrato_cfg.hop_size = 1024;
+        std::vector<float> sung(8 * cfg.sample_rate_hz);
+        double phase = 0.0;
+        for (int i = 0; i < static_cast<int>(sung.size()); ++i) {
+            const double t = static_cast<double>(i) / cfg.sample_rate_hz;
+            const double hz = 196.0 * std::pow(2.0, 20.0 * std::sin(2.0 * M_PI * 5.5 * t) / 1200.0);
+            phase += 2.0 * M_PI * hz / cfg.sample_rate_hz;
+            sung[i] = static_cast<float>(0.5 * std::sin(phase) + 0.2 * std::sin(2.0 * phase));
+        }
+        const int count = static_cast<int>(sung.size()) / vibrato_cfg.hop_size;
+        std::vector<DSPFrameOutput> frames(count);
+        PT_DSP* vibrato_dsp = pt_dsp_create(vibrato_cfg);
+        assert(vibrato_dsp);
+        [[maybe_unused]] const int produced = pt_dsp_push(vibrato_dsp, sung.data(),
+                                                          static_cast<int>(sung.size()), frames.data(), count);
+        assert(produced == count);
+        pt_dsp_destroy(vibrato_dsp);
+        for (int i = count / 4; i < count; ++i) {
+            assert(frames[i].vibrato_detected);
+            assert(std::abs(frames[i].vibrato_depth_cents - 20.0) < 6.0);
+            assert(std::abs(frames[i].vibrato_rate_hz - 5.5) < 1.0);
+        }
+    }
+
+    // Analyses happen once per hop over the last frame_size samples, whatever
+    // the burst size of the caller.
+    DSPConfig hop_cfg = cfg;
+    hop_cfg.frame_size = 1024;
+    hop_cfg.hop_size = 256;
+    auto long_tone = make_sine(hop_cfg.sample_rate_hz, hop_cfg.sample_rate_hz / 2, 261.63, 0.6);
+    std::vector<DSPFrameOutput> reference(long_tone.size() / hop_cfg.hop_size + 1);
+    PT_DSP* hop_dsp = pt_dsp_create(hop_cfg);
+    assert(hop_dsp);
+    const int reference_count = pt_dsp_push(hop_dsp, long_tone.data(), static_cast<int>(long_tone.size()),
+                                            reference.data(), static_cast<int>(reference.size()));
+    assert(reference_count == static_cast<int>(long_tone.size()) / hop_cfg.hop_size);
+    pt_dsp_destroy(hop_dsp);
+    for (int i = 0; i < reference_count; ++i) {
+        assert(std::abs(reference[i].timestamp_ms - i * 1000.0 * hop_cfg.hop_size / hop_cfg.sample_rate_hz) < 1e-9);
+    }
+    assert(std::abs(reference[reference_count - 1].freq_hz - 261.63) < 3.5);
+
+    for (int burst : {1, 96, 192, 250, 4800}) {
+        PT_DSP* burst_dsp = pt_dsp_create(hop_cfg);
+        assert(burst_dsp);
+        std::vector<DSPFrameOutput> frames(reference.size());
+        int total = 0;
+        for (size_t pos = 0; pos < long_tone.size(); pos += burst) {
+            const int count = static_cast<int>(std::min<size_t>(burst, long_tone.size() - pos));
+            DSPFrameOutput scratch[32];
+            const int produced = pt_dsp_push(burst_dsp, long_tone.data() + pos, count, scratch, 32);
+            assert(produced <= 32);
+            for (int i = 0; i < produced; ++i) {
+                frames[total++] = scratch[i];
+            }
+        }
+        assert(total == reference_count);
+        for (int i = 0; i < total; ++i) {
+            assert(frames[i].timestamp_ms == reference[i].timestamp_ms);
+            assert(frames[i].nearest_midi == reference[i].nearest_midi);
+            assert(std::abs(frames[i].confidence - reference[i].confidence) < 1e-9);
+        }
+        pt_dsp_destroy(burst_dsp);
+    }
+
+    // The decimation front-end follows the full-rate pitch once its window is
+    // filled, and its filter state carries across calls of any size.
+    for (int rate : {44100, 48000, 96000}) {
+        DSPConfig full_cfg = hop_cfg;
+        full_cfg.sample_rate_hz = rate;
+        DSPConfig decimated_cfg = full_cfg;
+        decimated_cfg.decimation = PT_DSP_DECIMATION_AUTO;
+        auto tone = make_sine(rate, rate / 2, 196.0, 0.5);
+        for (int i = 0; i < static_cast<int>(tone.size()); ++i) {
+            tone[i] += static_cast<float>(0.2 * std::sin(4.0 * M_PI * 196.0 * i / rate));
+        }
+        const int count = static_cast<int>(tone.size()) / hop_cfg.hop_size;
+        std::vector<DSPFrameOutput> full_frames(count);
+        std::vector<DSPFrameOutput> decimated_frames(count);
+        PT_DSP* full_dsp = pt_dsp_create(full_cfg);
+        PT_DSP* decimated_dsp = pt_dsp_create(decimated_cfg);
+        assert(full_dsp && decimated_dsp);
+        [[maybe_unused]] const int full_count =
+            pt_dsp_push(full_dsp, tone.data(), static_cast<int>(tone.size()), full_frames.data(), count);
+        [[maybe_unused]] const int decimated_count =
+            pt_dsp_push(decimated_dsp, tone.data(), static_cast<int>(tone.size()), decimated_frames.data(), count);
+        assert(full_count == count && decimated_count == count);
+        pt_dsp_destroy(full_dsp);
+        pt_dsp_destroy(decimated_dsp);
+        for (int i = 0; i < count; ++i) {
+            assert(std::isfinite(decimated_frames[i].freq_hz));
+            assert(std::abs(1200.0 * std::log2(decimated_frames[i].freq_hz / full_frames[i].freq_hz)) < 1.0);
+            assert(std::abs(decimated_frames[i].confidence - full_frames[i].confidence) < 0.02);
+        }
+
+        PT_DSP* burst_dsp = pt_dsp_create(decimated_cfg);
+        assert(burst_dsp);
+        int total = 0;
+        for (size_t pos = 0; pos < tone.size(); pos += 97) {
+            const int n = static_cast<int>(std::min<size_t>(97, tone.size() - pos));
+            DSPFrameOutput frame{};
+            if (pt_dsp_push(burst_dsp, tone.data() + pos, n, &frame, 1) == 1) {
+                assert(frame.freq_hz == decimated_frames[total].freq_hz);
+                assert(frame.confidence == decimated_frames[total].confidence);
+                ++total;
+            }
+        }
+        assert(total == count);
+        pt_dsp_destroy(burst_dsp);
+    }
+
+    // Batched processing matches independent calls per stream, across more
+    // than one group of eight, mixed configurations, silence and empty blocks.
+    constexpr int kStreams = 11;
+    std::vector<DSPConfig> stream_cfgs(kStreams, hop_cfg);
+    stream_cfgs[3].sample_rate_hz = 44100;
+    stream_cfgs[5].precision = PT_DSP_PRECISION_FLOAT;
+    stream_cfgs[6].diff_engine = PT_DSP_DIFF_FFT;
+    for (int s = 8; s < kStreams; ++s) {
+        stream_cfgs[s].hop_size = 128;
+    }
+    std::vector<PT_DSP*> batched(kStreams);
+    std::vector<PT_DSP*> independent(kStreams);
+    std::vector<std::vector<float>> signals(kStreams);
+    for (int s = 0; s < kStreams; ++s) {
+        batched[s] = pt_dsp_create(stream_cfgs[s]);
+        independent[s] = pt_dsp_create(stream_cfgs[s]);
+        assert(batched[s] && independent[s]);
+        signals[s] = make_sine(stream_cfgs[s].sample_rate_hz, 24000, 110.0 * (1.0 + 0.37 * s), 0.5);
+        if (s == 7) {
+            std::fill(signals[s].begin() + 9000, signals[s].begin() + 15000, 0.0f);
+        }
+    }
+    std::vector<DSPFrameOutput> latest(kStreams);
+    for (int block = 0; block < 24000 / 480; ++block) {
+        std::vector<const float*> blocks(kStreams);
+        std::vector<int> sizes(kStreams, 480);
+        for (int s = 0; s < kStreams; ++s) {
+            blocks[s] = signals[s].data() + block * 480;
+        }
+        sizes[9] = block % 3 == 0 ? 0 : 480;
+        std::vector<DSPFrameOutput> batch_out(kStreams);
+        [[maybe_unused]] const int produced =
+            pt_dsp_process_batch(batched.data(), blocks.data(), sizes.data(), kStreams, batch_out.data());
+        int expected_produced = 0;
+        for (int s = 0; s < kStreams; ++s) {
+            DSPFrameOutput frames[4];
+            const int ran = pt_dsp_push(independent[s], blocks[s], sizes[s], frames, 4);
+            assert(ran <= 4);
+            expected_produced += ran;
+            if (ran > 0) {
+                latest[s] = frames[ran - 1];
+            }
+            const DSPFrameOutput& expected = latest[s];
+            [[maybe_unused]] const DSPFrameOutput& got = batch_out[s];
+            if (sizes[s] == 0) {
+                assert(!std::isfinite(got.freq_hz) && got.confidence == 0.0);
+                continue;
+            }
+            assert(std::isfinite(expected.freq_hz) == std::isfinite(got.freq_hz));
+            assert(got.timestamp_ms == expected.timestamp_ms);
+            if (std::isfinite(expected.freq_hz)) {
+                assert(std::abs(1200.0 * std::log2(got.freq_hz / expected.freq_hz)) < 1e-6);
+            }
+            assert(std::abs(got.confidence - expected.confidence) < 1e-9);
+        }
+        assert(produced == expected_produced);
+    }
+    for (int s = 0; s < kStreams; ++s) {
+        pt_dsp_destroy(batched[s]);
+        pt_dsp_destroy(independent[s]);
+    }
+
+    // Chunked offline analysis stitches back into the sequential track: same
+    // frame count and timestamps, and tracking state carried across chunk
+    // boundaries, including over note changes and silent gaps.
+    std::vector<float> phrase(hop_cfg.sample_rate_hz * 8);
+    const double notes_hz[] = {110.0, 220.0, 196.0, 440.0, 329.63, 98.0};
+    double phase = 0.0;
+    for (size_t i = 0; i < phrase.size(); ++i) {
+        const double t = static_cast<double>(i) / hop_cfg.sample_rate_hz;
+        const double hz = notes_hz[static_cast<int>(t / 1.3) % 6] * (1.0 + 0.006 * std::sin(2.0 * M_PI * 5.5 * t));
+        phase += 2.0 * M_PI * hz / hop_cfg.sample_rate_hz;
+        const bool gap = std::fmod(t, 1.3) > 1.1;
+        phrase[i] = gap ? 0.0f : static_cast<float>(0.5 * std::sin(phase) + 0.25 * std::sin(2.0 * phase));
+    }
+    const int phrase_frames = static_cast<int>(phrase.size()) / hop_cfg.hop_size;
+    std::vector<DSPFrameOutput> sequential(phrase_frames);
+    for (DSPDecimation decimation : {PT_DSP_DECIMATION_OFF, PT_DSP_DECIMATION_AUTO}) {
+        DSPConfig offline_cfg = hop_cfg;
+        offline_cfg.decimation = decimation;
+        PT_DSP* sequential_dsp = pt_dsp_create(offline_cfg);
+        assert(sequential_dsp);
+        [[maybe_unused]] const int sequential_count = pt_dsp_push(sequential_dsp, phrase.data(),
+                                                                  static_cast<int>(phrase.size()),
+                                                                  sequential.data(), phrase_frames);
+        assert(sequential_count == phrase_frames);
+        pt_dsp_destroy(sequential_dsp);
+        for (int chunk : {0, 37, 200}) {
+            std::vector<DSPFrameOutput> stitched(phrase_frames);
+            [[maybe_unused]] const int64_t stitched_count = pt_dsp_analyze_offline(
+                offline_cfg, phrase.data(), static_cast<int64_t>(phrase.size()), 3, chunk, stitched.data(),
+                phrase_frames);
+            assert(stitched_count == phrase_frames);
+            for (int i = 0; i < phrase_frames; ++i) {
+                const DSPFrameOutput& expected = sequential[i];
+                [[maybe_unused]] const DSPFrameOutput& got = stitched[i];
+                assert(got.timestamp_ms == expected.timestamp_ms);
+                assert(std::isfinite(got.freq_hz) == std::isfinite(expected.freq_hz));
+                if (std::isfinite(expected.freq_hz)) {
+                    assert(std::abs(1200.0 * std::log2(got.freq_hz / expected.freq_hz)) < 1e-6);
+                }
+                assert(std::abs(got.confidence - expected.confidence) < 1e-9);
+                assert(got.vibrato_detected == expected.vibrato_detected);
+            }
+        }
+    }
+    std::vector<DSPFrameOutput> capped(10);
+    [[maybe_unused]] int64_t capped_count =
+        pt_dsp_analyze_offline(hop_cfg, phrase.data(), static_cast<int64_t>(phrase.size()), 2, 4, capped.data(), 10);
+    assert(capped_count == 10 && capped[9].timestamp_ms == sequential[9].timestamp_ms);
+    capped_count = pt_dsp_analyze_offline(hop_cfg, nullptr, 0, 2, 0, capped.data(), 10);
+    assert(capped_count == -1);
+
+    // Every push is timed; snapshots taken with reset from another thread
+    // partition the calls without losing or double-counting any.
+    assert(pt_dsp_timing_bucket_lower_ns(0) == 0 && pt_dsp_timing_bucket_lower_ns(1) == 160);
+    assert(pt_dsp_timing_bucket_lower_ns(4) == 256 && pt_dsp_timing_bucket_lower_ns(8) == 512);
+    PT_DSP* timed_dsp = pt_dsp_create(hop_cfg);
+    assert(timed_dsp);
+    DSPTimingStats stats{};
+    [[maybe_unused]] const bool null_dsp = pt_dsp_query_timing(nullptr, &stats, false);
+    [[maybe_unused]] const bool null_out = pt_dsp_query_timing(timed_dsp, nullptr, false);
+    assert(!null_dsp && !null_out);
+    [[maybe_unused]] bool queried = pt_dsp_query_timing(timed_dsp, &stats, false);
+    assert(queried && stats.calls == 0);
+    assert(pt_dsp_timing_percentile_ns(&stats, 0.99) == 0);
+    constexpr int kTimedCalls = 4000;
+    uint64_t seen_calls = 0;
+    uint64_t seen_histogram = 0;
+    std::thread reader([&]() {
+        for (int i = 0; i < 200; ++i) {
+            DSPTimingStats snapshot{};
+            pt_dsp_query_timing(timed_dsp, &snapshot, true);
+            seen_calls += snapshot.calls;
+            for (uint64_t count : snapshot.histogram) {
+                seen_histogram += count;
+            }
+            std::this_thread::yield();
+        }
+    });
+    for (int i = 0; i < kTimedCalls; ++i) {
+        pt_dsp_process(timed_dsp, phrase.data() + (i * 64) % (phrase.size() - 64), 64);
+    }
+    reader.join();
+    queried = pt_dsp_query_timing(timed_dsp, &stats, true);
+    assert(queried);
+    seen_calls += stats.calls;
+    for (uint64_t count : stats.histogram) {
+        seen_histogram += count;
+    }
+    assert(seen_calls == kTimedCalls && seen_histogram == kTimedCalls);
+    queried = pt_dsp_query_timing(timed_dsp, &stats, false);
+    assert(queried && stats.calls == 0 && stats.max_ns == 0);
+
+    for (int i = 0; i < 400; ++i) {
+        pt_dsp_process(timed_dsp, phrase.data() + i * 64, 64);
+    }
+    queried = pt_dsp_query_timing(timed_dsp, &stats, false);
+    assert(queried);
+    assert(stats.calls == 400 && stats.max_ns > 0 && stats.total_ns >= stats.max_ns);
+    [[maybe_unused]] const uint64_t p50 = pt_dsp_timing_percentile_ns(&stats, 0.5);
+    [[maybe_unused]] const uint64_t p99 = pt_dsp_timing_percentile_ns(&stats, 0.99);
+    assert(p50 > 0 && p50 <= p99 && p99 <= stats.max_ns);
+    pt_dsp_destroy(timed_dsp);
+
+    // Instances built in caller memory match pt_dsp_create's frame for frame,
+    // pack back to back in one arena and can be rebuilt in memory a previous
+    // instance left dirty.
+    std::vector<DSPConfig> arena_cfgs(5, hop_cfg);
+    arena_cfgs[1].precision = PT_DSP_PRECISION_FLOAT;
+    arena_cfgs[1].diff_engine = PT_DSP_DIFF_FFT;
+    arena_cfgs[2].lag_search = PT_DSP_LAG_SEARCH_TRACKED;
+    arena_cfgs[3].decimation = PT_DSP_DECIMATION_AUTO;
+    arena_cfgs[4].sample_rate_hz = 44100;
+    arena_cfgs[4].lag_search = PT_DSP_LAG_SEARCH_COARSE_TO_FINE;
+    std::vector<size_t> offsets;
+    size_t arena_size = 0;
+    for (const DSPConfig& c : arena_cfgs) {
+        const size_t need = pt_dsp_required_size(c);
+        assert(need > 0 && need % PT_DSP_INSTANCE_ALIGNMENT == 0);
+        offsets.push_back(arena_size);
+        arena_size += need;
+    }
+    std::vector<unsigned char> storage(arena_size + PT_DSP_INSTANCE_ALIGNMENT, 0xa5);
+    unsigned char* arena = storage.data() + (PT_DSP_INSTANCE_ALIGNMENT -
+                                             reinterpret_cast<uintptr_t>(storage.data()) % PT_DSP_INSTANCE_ALIGNMENT) %
+                                                PT_DSP_INSTANCE_ALIGNMENT;
+    const size_t first_size = pt_dsp_required_size(arena_cfgs[0]);
+    [[maybe_unused]] const PT_DSP* no_memory = pt_dsp_init_in_place(arena_cfgs[0], nullptr, first_size);
+    [[maybe_unused]] const PT_DSP* misaligned = pt_dsp_init_in_place(arena_cfgs[0], arena + 8, first_size);
+    [[maybe_unused]] const PT_DSP* too_small = pt_dsp_init_in_place(arena_cfgs[0], arena, first_size - 1);
+    assert(no_memory == nullptr && misaligned == nullptr && too_small == nullptr);
+    assert(arena[0] == 0xa5);
+    [[maybe_unused]] auto same_frame = [](const DSPFrameOutput& a, const DSPFrameOutput& b) {
+        return a.timestamp_ms == b.timestamp_ms && a.nearest_midi == b.nearest_midi &&
+               (a.freq_hz == b.freq_hz || (std::isnan(a.freq_hz) && std::isnan(b.freq_hz))) &&
+               a.confidence == b.confidence && a.vibrato_detected == b.vibrato_detected;
+    };
+    for (int round = 0; round < 2; ++round) {
+        std::vector<PT_DSP*> placed;
+        std::vector<PT_DSP*> heap;
+        for (size_t c = 0; c < arena_cfgs.size(); ++c) {
+            placed.push_back(pt_dsp_init_in_place(arena_cfgs[c], arena + offsets[c], arena_size - offsets[c]));
+            heap.push_back(pt_dsp_create(arena_cfgs[c]));
+            assert(placed[c] && heap[c] && static_cast<void*>(placed[c]) == arena + offsets[c]);
+        }
+        for (size_t i = 0; i + 512 <= phrase.size() / 4; i += 512) {
+            for (size_t c = 0; c < arena_cfgs.size(); ++c) {
+                DSPFrameOutput placed_frames[4];
+                DSPFrameOutput heap_frames[4];
+                const int placed_count = pt_dsp_push(placed[c], phrase.data() + i, 512, placed_frames, 4);
+                [[maybe_unused]] const int heap_count = pt_dsp_push(heap[c], phrase.data() + i, 512, heap_frames, 4);
+                assert(placed_count == heap_count && placed_count == 2);
+                for (int f = 0; f < placed_count; ++f) {
+                    assert(same_frame(placed_frames[f], heap_frames[f]));
+                }
+            }
+        }
+        for (size_t c = 0; c < arena_cfgs.size(); ++c) {
+            pt_dsp_destroy(placed[c]);
+            pt_dsp_destroy(heap[c]);
+        }
+    }
+
+    // Compact instances keep a fraction of the memory and, interleaved on one
+    // thread's shared scratch, find what standard instances find, to within
+    // the rounding the sliding update adds. Their FFT configs run the direct
+    // engine. A thread that reserved nothing gets its scratch on first use.
+    std::vector<PT_DSP*> standard_dsps;
+    std::vector<PT_DSP*> compact_dsps;
+    for (const DSPConfig& c : arena_cfgs) {
+        DSPConfig compact_cfg = c;
+        compact_cfg.footprint = PT_DSP_FOOTPRINT_COMPACT;
+        assert(pt_dsp_required_size(compact_cfg) * 6 < pt_dsp_required_size(c));
+        DSPConfig direct_cfg = c;
+        direct_cfg.diff_engine = PT_DSP_DIFF_DIRECT;
+        standard_dsps.push_back(pt_dsp_create(direct_cfg));
+        compact_dsps.push_back(pt_dsp_create(compact_cfg));
+        assert(standard_dsps.back() && compact_dsps.back());
+    }
+    // In single precision, rounding can move a weak dip by hundredths of a cent.
+    [[maybe_unused]] auto close_frame = [&](const DSPFrameOutput& a, const DSPFrameOutput& b, const DSPConfig& c) {
+        if (std::isfinite(a.freq_hz) != std::isfinite(b.freq_hz) || a.timestamp_ms != b.timestamp_ms) {
+            return false;
+        }
+        const double scale = c.precision == PT_DSP_PRECISION_FLOAT ? 1e5 : 1.0;
+        return !std::isfinite(a.freq_hz) || (std::abs(1200.0 * std::log2(a.freq_hz / b.freq_hz)) < 1e-6 * scale &&
+                                             std::abs(a.confidence - b.confidence) < 1e-9 * scale);
+    };
+    for (size_t i = 0; i + 512 <= phrase.size() / 2; i += 512) {
+        for (size_t c = 0; c < arena_cfgs.size(); ++c) {
+            DSPFrameOutput standard_frames[4];
+            DSPFrameOutput compact_frames[4];
+            [[maybe_unused]] const int standard_count = pt_dsp_push(standard_dsps[c], phrase.data() + i,
+                                                                    512, standard_frames, 4);
+            [[maybe_unused]] const int compact_count = pt_dsp_push(compact_dsps[c], phrase.data() + i,
+                                                                   512, compact_frames, 4);
+            assert(standard_count == 2 && compact_count == 2);
+            for (int f = 0; f < 2; ++f) {
+                assert(close_frame(standard_frames[f], compact_frames[f], arena_cfgs[c]));
+            }
+        }
+    }
+    std::thread other_thread([&]() {
+        const size_t start = phrase.size() / 2;
+        [[maybe_unused]] const DSPFrameOutput standard_out =
+            pt_dsp_process(standard_dsps[0], phrase.data() + start, 4096);
+        [[maybe_unused]] const DSPFrameOutput compact_out =
+            pt_dsp_process(compact_dsps[0], phrase.data() + start, 4096);
+        assert(std::isfinite(compact_out.freq_hz) && close_frame(standard_out, compact_out, arena_cfgs[0]));
+        DSPConfig tracked_cfg = arena_cfgs[2];
+        [[maybe_unused]] const bool standard_reserved = pt_dsp_reserve_thread_scratch(tracked_cfg);
+        tracked_cfg.footprint = PT_DSP_FOOTPRINT_COMPACT;
+        [[maybe_unused]] const bool compact_reserved = pt_dsp_reserve_thread_scratch(tracked_cfg);
+        assert(standard_reserved && compact_reserved);
+    });
+    other_thread.join();
+    for (size_t c = 0; c < arena_cfgs.size(); ++c) {
+        pt_dsp_destroy(standard_dsps[c]);
+        pt_dsp_destroy(compact_dsps[c]);
+    }
+    pt_dsp_destroy(nullptr);
     return 0;
 }
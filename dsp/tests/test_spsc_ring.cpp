@@ -0,0 +1,146 @@
+#include "pt_dsp/spsc_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace {
+using namespace std::chrono_literals;
+
+struct Item {
+    uint64_t seq;
+    double payload;
+};
+
+// The index lines and the slots never share a cache line.
+static_assert(sizeof(pt_dsp::SpscRing<Item, 16>) >= 3 * pt_dsp::kCacheLineSize + 16 * sizeof(Item),
+              "producer and consumer indices are padded apart");
+}  // namespace
+
+int main() {
+    // Fills to exactly Capacity, rejects the overflow, and keeps FIFO order
+    // across many wraps of the free-running indices with odd batch sizes.
+    {
+        pt_dsp::SpscRing<Item, 8> ring;
+        assert(ring.capacity() == 8 && ring.size() == 0);
+        Item out[8];
+        [[maybe_unused]] size_t n = ring.pop(out, 8);
+        [[maybe_unused]] bool ok = ring.pop(&out[0]);
+        assert(n == 0 && !ok);
+        for (uint64_t i = 0; i < 8; ++i) {
+            ok = ring.push(Item{i, 0.5 * i});
+            assert(ok);
+        }
+        ok = ring.push(Item{8, 0.0});
+        assert(!ok && ring.size() == 8);
+        n = ring.pop(out, 3);
+        assert(n == 3 && out[0].seq == 0 && out[2].seq == 2 && out[2].payload == 1.0);
+        Item batch[5] = {{8, 0}, {9, 0}, {10, 0}, {11, 0}, {12, 0}};
+        n = ring.push(batch, 5);
+        assert(n == 3);
+        n = ring.pop(out, 8);
+        assert(n == 8);
+        for (uint64_t i = 0; i < 8; ++i) {
+            assert(out[i].seq == i + 3);
+        }
+
+        uint64_t next_in = 11;
+        [[maybe_unused]] uint64_t next_out = 11;
+        for (int round = 0; round < 10000; ++round) {
+            Item in[7];
+            const size_t want = static_cast<size_t>(round % 7) + 1;
+            for (size_t i = 0; i < want; ++i) {
+                in[i] = Item{next_in + i, 0.0};
+            }
+            next_in += ring.push(in, want);
+            const size_t got = ring.pop(out, static_cast<size_t>(round % 5) + 1);
+            for (size_t i = 0; i < got; ++i) {
+                assert(out[i].seq == next_out++);
+            }
+        }
+        while (const size_t got = ring.pop(out, 8)) {
+            for (size_t i = 0; i < got; ++i) {
+                assert(out[i].seq == next_out++);
+            }
+        }
+        assert(next_out == next_in);
+    }
+
+    // wait() returns at once when items are queued, after the timeout when
+    // none arrive, and early when woken.
+    {
+        pt_dsp::SpscRing<Item, 16> ring;
+        [[maybe_unused]] bool ready = ring.wait(0ns);
+        assert(!ready);
+        [[maybe_unused]] const auto start = std::chrono::steady_clock::now();
+        ready = ring.wait(20ms);
+        assert(!ready);
+        assert(std::chrono::steady_clock::now() - start >= 15ms);
+        ring.push(Item{1, 0.0});
+        ready = ring.wait(10s);
+        assert(ready);
+        Item out;
+        [[maybe_unused]] const bool popped = ring.pop(&out);
+        assert(popped && out.seq == 1);
+
+        // A wake that lands before the consumer waits is not lost.
+        ring.wake_consumer();
+        [[maybe_unused]] const auto woken_start = std::chrono::steady_clock::now();
+        ready = ring.wait(10s);
+        assert(!ready);
+        assert(std::chrono::steady_clock::now() - woken_start < 5s);
+
+        std::atomic<bool> stop{false};
+        std::thread consumer([&]() {
+            while (!stop.load(std::memory_order_acquire)) {
+                ring.wait(10s);
+            }
+        });
+        std::this_thread::sleep_for(5ms);
+        [[maybe_unused]] const auto stop_start = std::chrono::steady_clock::now();
+        stop.store(true, std::memory_order_release);
+        ring.wake_consumer();
+        consumer.join();
+        assert(std::chrono::steady_clock::now() - stop_start < 5s);
+    }
+
+    // One producer and one blocking consumer move a long sequence through a
+    // small ring without losing, duplicating or reordering items.
+    {
+        constexpr uint64_t kItems = 2000000;
+        pt_dsp::SpscRing<Item, 64> ring;
+        std::thread producer([&]() {
+            uint64_t next = 0;
+            Item batch[13];
+            while (next < kItems) {
+                const size_t want = static_cast<size_t>(std::min<uint64_t>(1 + next % 13, kItems - next));
+                for (size_t i = 0; i < want; ++i) {
+                    batch[i] = Item{next + i, static_cast<double>(next + i)};
+                }
+                const size_t pushed = ring.push(batch, want);
+                next += pushed;
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        uint64_t expected = 0;
+        Item out[32];
+        while (expected < kItems) {
+            if (!ring.wait(1s)) {
+                continue;
+            }
+            const size_t got = ring.pop(out, 32);
+            for (size_t i = 0; i < got; ++i) {
+                assert(out[i].seq == expected && out[i].payload == static_cast<double>(expected));
+                ++expected;
+            }
+        }
+        producer.join();
+        assert(ring.size() == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Exercises the streaming API from C, linked only against the shared
+// library, as an FFI binding would use it.
+#include "pt_dsp/stream_api.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_RATE 48000
+#define HOP 256
+#define NUM_SAMPLES (3 * SAMPLE_RATE)
+#define NUM_FRAMES (NUM_SAMPLES / HOP)
+#define BURST 192
+
+static DSPConfig stream_config(void) {
+    DSPConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.a4_hz = 440.0;
+    cfg.sample_rate_hz = SAMPLE_RATE;
+    cfg.frame_size = 1024;
+    cfg.hop_size = HOP;
+    return cfg;
+}
+
+static int same_frame(const DSPFrameOutput* a, const DSPFrameOutput* b) {
+    return memcmp(&a->timestamp_ms, &b->timestamp_ms, sizeof(double)) == 0 &&
+           memcmp(&a->freq_hz, &b->freq_hz, sizeof(double)) == 0 &&
+           memcmp(&a->cents_error, &b->cents_error, sizeof(double)) == 0 && a->nearest_midi == b->nearest_midi &&
+           memcmp(&a->confidence, &b->confidence, sizeof(double)) == 0;
+}
+
+static float samples[NUM_SAMPLES];
+static DSPFrameOutput expected[NUM_FRAMES];
+
+struct Reader {
+    PT_DSP_STREAM* stream;
+    int done;  // set by the writer when every frame is published
+    int frames_read;
+    int mismatches;
+};
+
+// Polls the ring by hand the way a binding would: records are read in place,
+// validated against frames_begun, and compared with the reference.
+static void* read_ring(void* arg) {
+    struct Reader* reader = (struct Reader*)arg;
+    const PTDSPFrameRing* ring = pt_dsp_stream_ring(reader->stream);
+    const unsigned char* base = (const unsigned char*)ring + PT_DSP_STREAM_RING_HEADER_BYTES;
+    uint64_t cursor = 0;
+    while (cursor < NUM_FRAMES) {
+        const uint64_t written = pt_dsp_stream_frames_written(reader->stream);
+        for (; cursor < written; ++cursor) {
+            DSPFrameOutput frame;
+            memcpy(&frame, base + (cursor & (ring->capacity - 1)) * ring->frame_stride, sizeof(frame));
+            const uint64_t begun = pt_dsp_stream_frames_begun(reader->stream);
+            assert(begun <= ring->capacity || cursor >= begun - ring->capacity);  // ring sized to never lap
+            (void)begun;
+            if (!same_frame(&frame, &expected[cursor])) {
+                ++reader->mismatches;
+            }
+            ++reader->frames_read;
+        }
+        if (__atomic_load_n(&reader->done, __ATOMIC_ACQUIRE) && cursor >= NUM_FRAMES) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    for (int i = 0; i < NUM_SAMPLES; ++i) {
+        const double t = (double)i / SAMPLE_RATE;
+        samples[i] = (float)(0.5 * sin(2.0 * M_PI * 196.0 * pow(2.0, t / 3.0) * t));
+    }
+
+    // Reference: one push, read back in full through pt_dsp_stream_read.
+    PT_DSP_STREAM* reference = pt_dsp_stream_open(stream_config(), NUM_FRAMES);
+    assert(reference != NULL);
+    assert(pt_dsp_stream_ring(reference)->capacity >= NUM_FRAMES);
+    assert(pt_dsp_stream_ring(reference)->frame_stride == sizeof(DSPFrameOutput));
+    const int pushed = pt_dsp_stream_push(reference, samples, NUM_SAMPLES);
+    assert(pushed == NUM_FRAMES);
+    (void)pushed;
+    uint64_t cursor = 0;
+    uint64_t dropped = 1;
+    int read = pt_dsp_stream_read(reference, &cursor, expected, NUM_FRAMES, &dropped);
+    assert(read == NUM_FRAMES && cursor == NUM_FRAMES && dropped == 0);
+    read = pt_dsp_stream_read(reference, &cursor, expected, NUM_FRAMES, &dropped);
+    assert(read == 0);
+    (void)read;
+    for (int i = 1; i < NUM_FRAMES; ++i) {
+        assert(expected[i].timestamp_ms > expected[i - 1].timestamp_ms);
+    }
+    pt_dsp_stream_close(reference);
+
+    // A concurrent reader sees every frame of a burst-by-burst writer.
+    {
+        PT_DSP_STREAM* stream = pt_dsp_stream_open(stream_config(), NUM_FRAMES);
+        assert(stream != NULL);
+        struct Reader reader = {stream, 0, 0, 0};
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, read_ring, &reader) != 0) {
+            abort();
+        }
+        int published = 0;
+        for (int pos = 0; pos < NUM_SAMPLES; pos += BURST) {
+            const int n = NUM_SAMPLES - pos < BURST ? NUM_SAMPLES - pos : BURST;
+            published += pt_dsp_stream_push(stream, samples + pos, n);
+        }
+        __atomic_store_n(&reader.done, 1, __ATOMIC_RELEASE);
+        pthread_join(thread, NULL);
+        assert(published == NUM_FRAMES && reader.frames_read == NUM_FRAMES && reader.mismatches == 0);
+        pt_dsp_stream_close(stream);
+    }
+
+    // A small ring overwrites what a slow reader has not reached; the reader
+    // skips to the oldest intact frame and is told how many it lost.
+    {
+        PT_DSP_STREAM* stream = pt_dsp_stream_open(stream_config(), 100);
+        assert(stream != NULL && pt_dsp_stream_ring(stream)->capacity == 128);
+        DSPFrameOutput out[64];
+        cursor = 0;
+        int n = pt_dsp_stream_push(stream, samples, 40 * HOP);
+        assert(n == 40);
+        n = pt_dsp_stream_read(stream, &cursor, out, 16, &dropped);
+        assert(n == 16 && dropped == 0 && cursor == 16);
+        assert(same_frame(&out[15], &expected[15]));
+        n = pt_dsp_stream_push(stream, samples + 40 * HOP, 160 * HOP);
+        assert(n == 160);
+        n = pt_dsp_stream_read(stream, &cursor, out, 64, &dropped);
+        assert(n == 64);
+        assert(dropped == 200 - 128 - 16 && cursor == 200 - 128 + 64);
+        assert(same_frame(&out[0], &expected[200 - 128]));
+        n = pt_dsp_stream_read(stream, &cursor, out, 0, &dropped);
+        assert(n == 0 && dropped == 0);
+        n = pt_dsp_stream_read(NULL, &cursor, out, 1, NULL);
+        assert(n == -1);
+        n = pt_dsp_stream_push(stream, NULL, 10);
+        assert(n == -1);
+        (void)n;
+        pt_dsp_stream_close(stream);
+    }
+
+    // Zero frame and hop sizes take pt_dsp_create's defaults (1024 / 1024),
+    // and the stream chunks its input by the hop the instance runs with.
+    {
+        DSPConfig cfg = stream_config();
+        cfg.frame_size = 0;
+        cfg.hop_size = 0;
+        PT_DSP_STREAM* stream = pt_dsp_stream_open(cfg, 256);
+        assert(stream != NULL);
+        const int published = pt_dsp_stream_push(stream, samples, NUM_SAMPLES);
+        assert(published == NUM_SAMPLES / 1024);
+        assert(pt_dsp_stream_frames_written(stream) == (uint64_t)published);
+        (void)published;
+        pt_dsp_stream_close(stream);
+    }
+    pt_dsp_stream_close(NULL);
+    return 0;
+}
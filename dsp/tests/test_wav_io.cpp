@@ -0,0 +1,228 @@
+#include "pt_dsp/wav_io.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+using pt_dsp::WavEncoding;
+
+constexpr WavEncoding kEncodings[] = {WavEncoding::kPcm16, WavEncoding::kPcm24, WavEncoding::kPcm32,
+                                      WavEncoding::kFloat32};
+
+std::string temp_path(const char* name) {
+    const char* dir = std::getenv("TMPDIR");
+    return std::string(dir != nullptr ? dir : "/tmp") + "/pt_dsp_" + name + "_" + std::to_string(getpid()) + ".wav";
+}
+
+// Interleaved test signal: a different tone per channel, peaks past full
+// scale, and NaNs for the PCM encodings to flush to zero.
+std::vector<float> signal(size_t frames, int channels, bool with_nan) {
+    std::vector<float> out(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            out[i * channels + ch] = static_cast<float>(1.2 * std::sin(0.013 * (ch + 1) * static_cast<double>(i)));
+        }
+    }
+    if (with_nan) {
+        out[5] = NAN;
+    }
+    return out;
+}
+
+// What a sample reads back as: the writer's documented rounding, then the
+// reader's scaling.
+float round_trip(float s, WavEncoding encoding) {
+    if (encoding == WavEncoding::kFloat32) {
+        return s;
+    }
+    s = std::isnan(s) ? 0.0f : std::fmin(std::fmax(s, -1.0f), 1.0f);
+    switch (encoding) {
+        case WavEncoding::kPcm16:
+            return static_cast<float>(std::lrint(s * 32767.0f)) / 32768.0f;
+        case WavEncoding::kPcm24:
+            return static_cast<float>(std::lrint(static_cast<double>(s) * 8388607.0)) / 8388608.0f;
+        default:
+            return static_cast<float>(std::lrint(static_cast<double>(s) * 2147483647.0) / 2147483648.0);
+    }
+}
+
+std::vector<float> expected_mono(const std::vector<float>& interleaved, int channels, WavEncoding encoding) {
+    std::vector<float> out(interleaved.size() / channels);
+    for (size_t i = 0; i < out.size(); ++i) {
+        float sum = 0.0f;
+        for (int ch = 0; ch < channels; ++ch) {
+            sum += round_trip(interleaved[i * channels + ch], encoding);
+        }
+        out[i] = channels == 1 ? sum : sum * (1.0f / static_cast<float>(channels));
+    }
+    return out;
+}
+
+[[maybe_unused]] long file_size(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    assert(f != nullptr);
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    std::fclose(f);
+    return size;
+}
+
+void write_bytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    assert(f != nullptr);
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+}
+
+// Every encoding and channel count survives the writer and reads back the
+// same through the mapping and the stream, vector paths and tails alike.
+void test_round_trips() {
+    const std::string path = temp_path("round_trip");
+    const size_t frames = 70001;
+    for (WavEncoding encoding : kEncodings) {
+        for (int channels = 1; channels <= 3; ++channels) {
+            const auto samples = signal(frames, channels, encoding != WavEncoding::kFloat32);
+            pt_dsp::WavWriter writer;
+            [[maybe_unused]] const bool opened = writer.open(path, 44100, channels, encoding);
+            assert(opened);
+            // Uneven writes; most of the files outgrow the writer's buffer.
+            [[maybe_unused]] const bool wrote_head = writer.write(samples.data(), 3);
+            [[maybe_unused]] const bool wrote_rest = writer.write(samples.data() + 3 * channels, frames - 3);
+            assert(wrote_head && wrote_rest);
+            assert(writer.frames_written() == static_cast<int64_t>(frames));
+            [[maybe_unused]] const bool closed = writer.close();
+            assert(closed);
+            [[maybe_unused]] const long data =
+                static_cast<long>(frames) * channels * pt_dsp::wav_bytes_per_sample(encoding);
+            assert(file_size(path) == 44 + data + (data & 1));
+
+            const auto expected = expected_mono(samples, channels, encoding);
+            pt_dsp::MappedWav mapped;
+            [[maybe_unused]] const bool mapped_open = mapped.open(path);
+            assert(mapped_open);
+            assert(mapped.sample_rate() == 44100 && mapped.channels() == channels);
+            assert(mapped.encoding() == encoding && mapped.frames() == static_cast<int64_t>(frames));
+            std::vector<float> out(frames + 8, -9.0f);
+            [[maybe_unused]] const int read = mapped.read_mono(0, static_cast<int>(out.size()), out.data());
+            assert(read == static_cast<int>(frames));
+            for (size_t i = 0; i < frames; ++i) {
+                assert(out[i] == expected[i]);
+            }
+            assert(out[frames] == -9.0f);
+            [[maybe_unused]] const int read_mid = mapped.read_mono(997, 3, out.data());
+            assert(read_mid == 3 && out[2] == expected[999]);
+            assert((mapped.float_data() != nullptr) == (encoding == WavEncoding::kFloat32 && channels == 1));
+
+            // A buffer smaller than a read forces several refills.
+            pt_dsp::WavStreamReader stream;
+            [[maybe_unused]] const bool stream_open = stream.open(path, 100);
+            assert(stream_open);
+            std::vector<float> streamed(frames);
+            for (size_t pos = 0; pos < frames;) {
+                const int n = stream.read_mono(77, streamed.data() + pos);
+                if (n <= 0) {
+                    std::abort();
+                }
+                pos += static_cast<size_t>(n);
+            }
+            [[maybe_unused]] const int read_past_end = stream.read_mono(77, streamed.data());
+            assert(read_past_end == 0);
+            for (size_t i = 0; i < frames; ++i) {
+                assert(streamed[i] == expected[i]);
+            }
+            [[maybe_unused]] const bool sought = stream.seek(500);
+            assert(sought && stream.position() == 500);
+            [[maybe_unused]] const int read_one = stream.read_mono(1, out.data());
+            assert(read_one == 1 && out[0] == expected[500]);
+            [[maybe_unused]] const bool sought_past_end = stream.seek(static_cast<int64_t>(frames) + 1);
+            assert(!sought_past_end);
+        }
+    }
+    unlink(path.c_str());
+}
+
+// Files from other writers: WAVE_FORMAT_EXTENSIBLE, chunks before the data,
+// and a data size left unset by a recorder that never finished.
+void test_foreign_layouts() {
+    const std::string path = temp_path("foreign");
+    std::vector<uint8_t> bytes = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E'};
+    const auto u16 = [&bytes](uint16_t v) {
+        bytes.push_back(static_cast<uint8_t>(v));
+        bytes.push_back(static_cast<uint8_t>(v >> 8));
+    };
+    const auto u32 = [&](uint32_t v) {
+        u16(static_cast<uint16_t>(v));
+        u16(static_cast<uint16_t>(v >> 16));
+    };
+    bytes.insert(bytes.end(), {'L', 'I', 'S', 'T'});
+    u32(3);
+    bytes.insert(bytes.end(), {'a', 'b', 'c', 0});  // odd size, padded
+    bytes.insert(bytes.end(), {'f', 'm', 't', ' '});
+    u32(40);
+    u16(0xFFFE);
+    u16(2);
+    u32(48000);
+    u32(48000 * 4);
+    u16(4);
+    u16(16);
+    u16(22);
+    u16(16);
+    u32(3);  // channel mask
+    u16(1);  // subformat: PCM
+    bytes.insert(bytes.end(), 14, 0);
+    bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+    u32(0xFFFFFFFF);
+    for (int i = 0; i < 10; ++i) {
+        u16(static_cast<uint16_t>(i * 1000));
+        u16(static_cast<uint16_t>(-i * 500));
+    }
+    bytes.push_back(0x7F);  // a partial trailing frame is ignored
+    write_bytes(path, bytes);
+
+    pt_dsp::MappedWav mapped;
+    [[maybe_unused]] bool mapped_open = mapped.open(path);
+    assert(mapped_open);
+    assert(mapped.encoding() == WavEncoding::kPcm16 && mapped.channels() == 2 && mapped.frames() == 10);
+    pt_dsp::WavStreamReader stream;
+    [[maybe_unused]] bool stream_open = stream.open(path);
+    assert(stream_open && stream.frames() == 10);
+    float a[10];
+    float b[10];
+    [[maybe_unused]] const int read_mapped = mapped.read_mono(0, 10, a);
+    [[maybe_unused]] const int read_streamed = stream.read_mono(10, b);
+    assert(read_mapped == 10 && read_streamed == 10);
+    for (int i = 0; i < 10; ++i) {
+        [[maybe_unused]] const float expected = (i * 1000 / 32768.0f + -i * 500 / 32768.0f) * 0.5f;
+        assert(a[i] == expected && b[i] == expected);
+    }
+
+    bytes.assign(64, 'x');
+    write_bytes(path, bytes);
+    mapped_open = mapped.open(path);
+    assert(!mapped_open && mapped.error() == "not a RIFF/WAVE file");
+    stream_open = stream.open(path);
+    assert(!stream_open && stream.error() == "not a RIFF/WAVE file");
+    unlink(path.c_str());
+    mapped_open = mapped.open(path);
+    stream_open = stream.open(path);
+    assert(!mapped_open && !stream_open);
+
+    pt_dsp::WavWriter writer;
+    [[maybe_unused]] const bool opened = writer.open(path, 0, 1, WavEncoding::kPcm16);
+    [[maybe_unused]] const bool closed = writer.close();
+    assert(!opened && !closed);
+}
+}  // namespace
+
+int main() {
+    test_round_trips();
+    test_foreign_layouts();
+    return 0;
+}
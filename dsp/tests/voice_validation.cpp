@@ -19,6 +19,10 @@ struct ScenarioResult {
   double meanAbsCents = 0;
   double voicedConfidence = 0;
   double unvoicedConfidence = 0;
+  // Single-precision path compared frame by frame against the double path.
+  double f32MeanDeltaCents = 0;
+  double f32MaxDeltaCents = 0;
+  int f32VoicingMismatches = 0;
   bool pass = false;
 };
 
@@ -51,11 +55,13 @@ std::vector<float> makeVoiceLikeSignal(double hz, double seconds, double noiseAm
   std::vector<float> delay(8000, 0.0f);
   int delayIdx = 0;
 
+  // Phase integrates the instantaneous frequency so vibrato stays within 1.5% of hz.
+  double phase = 0.0;
   for (int i = 0; i < total; ++i) {
     const double t = static_cast<double>(i) / kSampleRate;
     const double vib = vibrato ? std::sin(2.0 * kPi * 5.5 * t) * 0.015 : 0.0;
     const double f = hz * (1.0 + vib);
-    const double phase = 2.0 * kPi * f * t;
+    phase += 2.0 * kPi * f / kSampleRate;
     double sample = 0.7 * std::sin(phase) + 0.2 * std::sin(2.0 * phase) + 0.1 * std::sin(3.0 * phase);
     sample += 0.08 * std::sin(2.0 * kPi * 3.0 * t); // vowel/formant-ish envelope
     sample += noise(rng);
@@ -81,6 +87,8 @@ ScenarioResult runScenario(const std::string& name, double hz, bool vibrato, boo
   cfg.frame_size = 1024;
   cfg.hop_size = kHop;
   PT_DSP* dsp = pt_dsp_create(cfg);
+  cfg.precision = PT_DSP_PRECISION_FLOAT;
+  PT_DSP* dspF32 = pt_dsp_create(cfg);
 
   auto voiced = makeVoiceLikeSignal(hz, 8.0, noiseAmp, vibrato, reverb);
   std::vector<float> silence(voiced.size(), 0.0f);
@@ -89,9 +97,22 @@ ScenarioResult runScenario(const std::string& name, double hz, bool vibrato, boo
   int centsCount = 0;
   double voicedConfSum = 0.0;
   int voicedConfCount = 0;
+  double f32DeltaSum = 0.0;
+  int f32DeltaCount = 0;
+  double f32DeltaMax = 0.0;
+  int f32Mismatches = 0;
 
   for (size_t i = 0; i + kHop <= voiced.size(); i += kHop) {
     auto frame = pt_dsp_process(dsp, voiced.data() + i, kHop);
+    const auto frameF32 = pt_dsp_process(dspF32, voiced.data() + i, kHop);
+    if (std::isfinite(frame.freq_hz) != std::isfinite(frameF32.freq_hz)) {
+      ++f32Mismatches;
+    } else if (std::isfinite(frame.freq_hz)) {
+      const double delta = std::abs(1200.0 * std::log2(frameF32.freq_hz / frame.freq_hz));
+      f32DeltaSum += delta;
+      f32DeltaMax = std::max(f32DeltaMax, delta);
+      ++f32DeltaCount;
+    }
     if (std::isfinite(frame.freq_hz) && frame.freq_hz > 0.0) {
       const double cents = 1200.0 * std::log2(frame.freq_hz / hz);
       centsSum += std::abs(cents);
@@ -114,11 +135,15 @@ ScenarioResult runScenario(const std::string& name, double hz, bool vibrato, boo
   }
 
   pt_dsp_destroy(dsp);
+  pt_dsp_destroy(dspF32);
   ScenarioResult result{
       name,
       centsCount == 0 ? 0.0 : centsSum / centsCount,
       voicedConfCount == 0 ? 0.0 : voicedConfSum / voicedConfCount,
       unvoicedConfCount == 0 ? 0.0 : unvoicedConfSum / unvoicedConfCount,
+      f32DeltaCount == 0 ? 0.0 : f32DeltaSum / f32DeltaCount,
+      f32DeltaMax,
+      f32Mismatches,
   };
   const auto gate = gateForScenario(name);
   result.pass = result.meanAbsCents <= gate.maxMeanAbsCents &&
@@ -145,6 +170,9 @@ int main() {
               << " mean_abs_cents=" << r.meanAbsCents
               << " voiced_conf=" << r.voicedConfidence
               << " unvoiced_conf=" << r.unvoicedConfidence
+              << " f32_mean_delta_cents=" << r.f32MeanDeltaCents
+              << " f32_max_delta_cents=" << r.f32MaxDeltaCents
+              << " f32_voicing_mismatches=" << r.f32VoicingMismatches
               << " gate(max_cents=" << gate.maxMeanAbsCents
               << ", min_voiced_conf=" << gate.minVoicedConfidence
               << ", max_unvoiced_conf=" << gate.maxUnvoicedConfidence << ")"
@@ -0,0 +1,436 @@
+// Offline pitch analysis of WAV files.
+//
+//   pt_dsp_analyze [options] <file.wav | directory>...
+//
+//   --out DIR            output directory (default: current directory)
+//   --format csv|bin     per-file track format (default: csv)
+//   --jobs N             worker threads (default: hardware concurrency)
+//   --frame N            DSPConfig::frame_size (default: 1024)
+//   --hop N              DSPConfig::hop_size (default: 256)
+//   --engine direct|fft  DSPConfig::diff_engine (default: direct)
+//   --precision double|float
+//   --a4 HZ              reference pitch (default: 440)
+//   --split              analyse files one at a time, each split across the
+//                        jobs with pt_dsp_analyze_offline (for long recordings)
+//
+// Directories are searched recursively for *.wav. Each input is memory-mapped
+// and streamed through pt_dsp_push a block of hops at a time, so memory use
+// does not grow with file length; mono float32 files are fed straight from
+// the mapping. Files are spread over the worker pool and each gets its own
+// PT_DSP instance at the file's sample rate. With --split the whole file is
+// converted to float in memory and its frames are analysed in parallel chunks
+// instead, which produces the same track.
+//
+// Every input writes <out>/<stem>.csv or <out>/<stem>.ptt, one row or record
+// per analysis frame; inputs whose outputs would collide (the same file name
+// in two directories) are rejected before anything is analysed. The CSV columns are the DSPFrameOutput fields in
+// declaration order with NaN written as an empty field. The .ptt layout is a
+// 32-byte little-endian header
+//   char magic[4] = "PTTK"; uint32 version = 1; uint32 sample_rate_hz;
+//   uint32 frame_size; uint32 hop_size; uint32 reserved; uint64 frame_count
+// followed by frame_count 64-byte records
+//   double timestamp_ms, freq_hz, midi_float, cents_error, confidence,
+//          vibrato_rate_hz, vibrato_depth_cents;
+//   int32 nearest_midi; uint32 flags (bit 0: vibrato_detected)
+//
+// One summary line per input is printed to stdout in argument order. The exit
+// status is 1 if any input failed.
+
+#include "pt_dsp/dsp_api.h"
+#include "pt_dsp/wav_io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+// Hops analysed per pt_dsp_push call.
+constexpr int kHopsPerBlock = 64;
+constexpr size_t kOutputBuffer = 1 << 20;
+// Samples converted per read_mono call when a whole file is loaded.
+constexpr int kConvertBlock = 1 << 20;
+constexpr uint32_t kTrackVersion = 1;
+
+enum class Format {
+    kCsv,
+    kBinary,
+};
+
+struct Options {
+    fs::path out_dir = ".";
+    Format format = Format::kCsv;
+    int jobs = 0;
+    bool split = false;
+    DSPConfig cfg{};
+};
+
+struct FileResult {
+    bool ok = false;
+    std::string error;
+    fs::path output;
+    int64_t frames = 0;
+    int64_t voiced = 0;
+    double audio_s = 0.0;
+    double wall_s = 0.0;
+};
+
+struct TrackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sample_rate_hz;
+    uint32_t frame_size;
+    uint32_t hop_size;
+    uint32_t reserved;
+    uint64_t frame_count;
+};
+static_assert(sizeof(TrackHeader) == 32, "track header layout");
+
+struct TrackRecord {
+    double timestamp_ms;
+    double freq_hz;
+    double midi_float;
+    double cents_error;
+    double confidence;
+    double vibrato_rate_hz;
+    double vibrato_depth_cents;
+    int32_t nearest_midi;
+    uint32_t flags;
+};
+static_assert(sizeof(TrackRecord) == 64, "track record layout");
+
+struct FileCloser {
+    void operator()(std::FILE* f) const { std::fclose(f); }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+struct DspDestroyer {
+    void operator()(PT_DSP* dsp) const { pt_dsp_destroy(dsp); }
+};
+using DspPtr = std::unique_ptr<PT_DSP, DspDestroyer>;
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: pt_dsp_analyze [--out DIR] [--format csv|bin] [--jobs N] [--frame N] [--hop N]\n"
+                 "                      [--engine direct|fft] [--precision double|float] [--a4 HZ] [--split]\n"
+                 "                      <file.wav | directory>...\n");
+}
+
+void write_number(std::FILE* f, double v) {
+    if (std::isfinite(v)) {
+        std::fprintf(f, "%.6f", v);
+    }
+}
+
+void write_csv_frame(std::FILE* f, const DSPFrameOutput& frame) {
+    write_number(f, frame.timestamp_ms);
+    std::fputc(',', f);
+    write_number(f, frame.freq_hz);
+    std::fputc(',', f);
+    write_number(f, frame.midi_float);
+    std::fprintf(f, ",%d,", frame.nearest_midi);
+    write_number(f, frame.cents_error);
+    std::fputc(',', f);
+    write_number(f, frame.confidence);
+    std::fprintf(f, ",%d,", frame.vibrato_detected ? 1 : 0);
+    write_number(f, frame.vibrato_rate_hz);
+    std::fputc(',', f);
+    write_number(f, frame.vibrato_depth_cents);
+    std::fputc('\n', f);
+}
+
+void write_binary_frame(std::FILE* f, const DSPFrameOutput& frame) {
+    TrackRecord rec{};
+    rec.timestamp_ms = frame.timestamp_ms;
+    rec.freq_hz = frame.freq_hz;
+    rec.midi_float = frame.midi_float;
+    rec.cents_error = frame.cents_error;
+    rec.confidence = frame.confidence;
+    rec.vibrato_rate_hz = frame.vibrato_rate_hz;
+    rec.vibrato_depth_cents = frame.vibrato_depth_cents;
+    rec.nearest_midi = frame.nearest_midi;
+    rec.flags = frame.vibrato_detected ? 1u : 0u;
+    std::fwrite(&rec, sizeof(rec), 1, f);
+}
+
+TrackHeader make_header(const DSPConfig& cfg, uint64_t frame_count) {
+    TrackHeader header{};
+    std::memcpy(header.magic, "PTTK", 4);
+    header.version = kTrackVersion;
+    header.sample_rate_hz = static_cast<uint32_t>(cfg.sample_rate_hz);
+    header.frame_size = static_cast<uint32_t>(cfg.frame_size);
+    header.hop_size = static_cast<uint32_t>(cfg.hop_size);
+    header.frame_count = frame_count;
+    return header;
+}
+
+// split_jobs > 0 analyses the file with pt_dsp_analyze_offline on that many
+// threads; otherwise it is streamed through one instance.
+fs::path output_path(const fs::path& input, const Options& opts) {
+    fs::path output = opts.out_dir / input.stem();
+    output += opts.format == Format::kCsv ? ".csv" : ".ptt";
+    return output;
+}
+
+FileResult analyze_file(const fs::path& input, const Options& opts, int split_jobs) {
+    FileResult result;
+    const auto start = std::chrono::steady_clock::now();
+
+    pt_dsp::MappedWav wav;
+    if (!wav.open(input.string())) {
+        result.error = wav.error();
+        return result;
+    }
+    DSPConfig cfg = opts.cfg;
+    cfg.sample_rate_hz = wav.sample_rate();
+    DspPtr dsp(pt_dsp_create(cfg));
+    if (!dsp) {
+        result.error = "pt_dsp_create failed";
+        return result;
+    }
+
+    result.output = output_path(input, opts);
+    FilePtr out(std::fopen(result.output.string().c_str(), "wb"));
+    if (!out) {
+        result.error = "cannot create " + result.output.string();
+        return result;
+    }
+    std::setvbuf(out.get(), nullptr, _IOFBF, kOutputBuffer);
+    if (opts.format == Format::kCsv) {
+        std::fputs("timestamp_ms,freq_hz,midi_float,nearest_midi,cents_error,confidence,"
+                   "vibrato_detected,vibrato_rate_hz,vibrato_depth_cents\n",
+                   out.get());
+    } else {
+        // Rewritten with the final frame count once the file is done.
+        const TrackHeader header = make_header(cfg, 0);
+        std::fwrite(&header, sizeof(header), 1, out.get());
+    }
+
+    auto emit = [&](const DSPFrameOutput& frame) {
+        if (opts.format == Format::kCsv) {
+            write_csv_frame(out.get(), frame);
+        } else {
+            write_binary_frame(out.get(), frame);
+        }
+        if (std::isfinite(frame.freq_hz)) {
+            ++result.voiced;
+        }
+        ++result.frames;
+    };
+    const float* direct = wav.float_data();
+    if (split_jobs > 0) {
+        std::vector<float> samples;
+        if (!direct) {
+            samples.resize(static_cast<size_t>(wav.frames()));
+            for (int64_t pos = 0; pos < wav.frames(); pos += kConvertBlock) {
+                wav.read_mono(pos, kConvertBlock, samples.data() + pos);
+            }
+        }
+        std::vector<DSPFrameOutput> frames(static_cast<size_t>(wav.frames() / cfg.hop_size));
+        const int64_t produced =
+            pt_dsp_analyze_offline(cfg, direct ? direct : samples.data(), wav.frames(), split_jobs, 0, frames.data(),
+                                   static_cast<int64_t>(frames.size()));
+        if (produced < 0) {
+            result.error = "pt_dsp_analyze_offline failed";
+            return result;
+        }
+        for (int64_t i = 0; i < produced; ++i) {
+            emit(frames[i]);
+        }
+    } else {
+        const int block = kHopsPerBlock * cfg.hop_size;
+        std::vector<float> samples(direct ? 0 : block);
+        DSPFrameOutput frames[kHopsPerBlock + 1];
+        for (int64_t pos = 0; pos < wav.frames(); pos += block) {
+            const int count = static_cast<int>(std::min<int64_t>(block, wav.frames() - pos));
+            const float* src = direct ? direct + pos : samples.data();
+            if (!direct) {
+                wav.read_mono(pos, count, samples.data());
+            }
+            const int produced = pt_dsp_push(dsp.get(), src, count, frames, kHopsPerBlock + 1);
+            for (int i = 0; i < produced; ++i) {
+                emit(frames[i]);
+            }
+        }
+    }
+
+    if (opts.format == Format::kBinary) {
+        const TrackHeader header = make_header(cfg, static_cast<uint64_t>(result.frames));
+        std::fseek(out.get(), 0, SEEK_SET);
+        std::fwrite(&header, sizeof(header), 1, out.get());
+    }
+    if (std::ferror(out.get()) || std::fclose(out.release()) != 0) {
+        result.error = "write failed for " + result.output.string();
+        return result;
+    }
+    result.audio_s = static_cast<double>(wav.frames()) / wav.sample_rate();
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ok = true;
+    return result;
+}
+
+bool has_wav_extension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".wav";
+}
+
+bool collect_inputs(const char* arg, std::vector<fs::path>* inputs) {
+    std::error_code ec;
+    const fs::path path(arg);
+    if (!fs::is_directory(path, ec)) {
+        inputs->push_back(path);
+        return true;
+    }
+    std::vector<fs::path> found;
+    for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && has_wav_extension(it->path())) {
+            found.push_back(it->path());
+        }
+    }
+    if (ec) {
+        std::fprintf(stderr, "cannot list %s: %s\n", arg, ec.message().c_str());
+        return false;
+    }
+    // Directory order is unspecified; sort so runs are reproducible.
+    std::sort(found.begin(), found.end());
+    inputs->insert(inputs->end(), found.begin(), found.end());
+    return true;
+}
+
+bool parse_args(int argc, char* argv[], Options* opts, std::vector<fs::path>* inputs) {
+    opts->cfg.a4_hz = 440.0;
+    opts->cfg.frame_size = 1024;
+    opts->cfg.hop_size = 256;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            if (!collect_inputs(argv[i], inputs)) {
+                return false;
+            }
+            continue;
+        }
+        if (arg == "--split") {
+            opts->split = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--out") {
+            opts->out_dir = value;
+        } else if (arg == "--format" && (value == "csv" || value == "bin")) {
+            opts->format = value == "csv" ? Format::kCsv : Format::kBinary;
+        } else if (arg == "--jobs") {
+            opts->jobs = std::atoi(value.c_str());
+        } else if (arg == "--frame") {
+            opts->cfg.frame_size = std::atoi(value.c_str());
+        } else if (arg == "--hop") {
+            opts->cfg.hop_size = std::atoi(value.c_str());
+        } else if (arg == "--engine" && (value == "direct" || value == "fft")) {
+            opts->cfg.diff_engine = value == "direct" ? PT_DSP_DIFF_DIRECT : PT_DSP_DIFF_FFT;
+        } else if (arg == "--precision" && (value == "double" || value == "float")) {
+            opts->cfg.precision = value == "double" ? PT_DSP_PRECISION_DOUBLE : PT_DSP_PRECISION_FLOAT;
+        } else if (arg == "--a4") {
+            opts->cfg.a4_hz = std::atof(value.c_str());
+        } else {
+            return false;
+        }
+    }
+    // Mirror pt_dsp_create's clamping so .ptt headers record what actually ran.
+    if (opts->cfg.frame_size <= 0) {
+        opts->cfg.frame_size = 1024;
+    }
+    opts->cfg.frame_size = std::min(opts->cfg.frame_size, 4096);
+    if (opts->cfg.hop_size <= 0 || opts->cfg.hop_size > opts->cfg.frame_size) {
+        opts->cfg.hop_size = opts->cfg.frame_size;
+    }
+    return !inputs->empty();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    std::vector<fs::path> inputs;
+    if (!parse_args(argc, argv, &opts, &inputs)) {
+        usage();
+        return 2;
+    }
+    // Workers write their outputs concurrently, so no two may share one.
+    std::map<fs::path, size_t> outputs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const auto [it, inserted] = outputs.emplace(output_path(inputs[i], opts), i);
+        if (!inserted) {
+            std::fprintf(stderr, "%s and %s would both write %s\n", inputs[it->second].string().c_str(),
+                         inputs[i].string().c_str(), it->first.string().c_str());
+            return 2;
+        }
+    }
+    std::error_code ec;
+    fs::create_directories(opts.out_dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot create %s: %s\n", opts.out_dir.string().c_str(), ec.message().c_str());
+        return 2;
+    }
+
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    const int requested = opts.jobs > 0 ? opts.jobs : std::max(1, hw);
+    const int jobs = opts.split ? requested : std::min(requested, static_cast<int>(inputs.size()));
+    std::vector<FileResult> results(inputs.size());
+    const auto start = std::chrono::steady_clock::now();
+    if (opts.split) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            results[i] = analyze_file(inputs[i], opts, jobs);
+        }
+    } else {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < inputs.size(); i = next.fetch_add(1)) {
+                results[i] = analyze_file(inputs[i], opts, 0);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < jobs; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& t : pool) {
+            t.join();
+        }
+    }
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failed = 0;
+    double audio_s = 0.0;
+    int64_t frames = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const FileResult& r = results[i];
+        if (!r.ok) {
+            ++failed;
+            std::printf("file=%s status=error reason=\"%s\"\n", inputs[i].string().c_str(), r.error.c_str());
+            continue;
+        }
+        audio_s += r.audio_s;
+        frames += r.frames;
+        std::printf("file=%s status=ok output=%s frames=%lld voiced=%lld audio_s=%.2f wall_s=%.3f\n",
+                    inputs[i].string().c_str(), r.output.string().c_str(), static_cast<long long>(r.frames),
+                    static_cast<long long>(r.voiced), r.audio_s, r.wall_s);
+    }
+    std::printf("files=%zu failed=%d jobs=%d frames=%lld audio_s=%.2f wall_s=%.3f realtime_x=%.1f\n", inputs.size(),
+                failed, jobs, static_cast<long long>(frames), audio_s, wall_s, wall_s > 0.0 ? audio_s / wall_s : 0.0);
+    return failed > 0 ? 1 : 0;
+}
@@ -4,14 +4,25 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
+#include <memory>
 #include <thread>
 
+#include "pt_dsp/analysis_worker.h"
 #include "pt_dsp/dsp_api.h"
+#include "pt_dsp/frame_batch.h"
+#include "pt_dsp/spsc_ring.h"
 
 namespace {
-constexpr int kFrameQueueSize = 1024;
+constexpr size_t kFrameQueueSize = 1024;
 constexpr uint64_t kDropLogPeriod = 200;
+// Frames the emitter takes from the ring per pass, and so per JNI call. The
+// Kotlin side allocates the direct buffer for this many packed frames.
+constexpr size_t kEmitBatch = 32;
+// Bounds how long the emitter sleeps without frames, as a safety net; stop
+// wakes it directly.
+constexpr auto kEmitterIdleTimeout = std::chrono::milliseconds(100);
 constexpr const char* kLogTag = "PTAudioEngine";
 
 inline double sanitizeFinite(double value, double fallbackNan = NAN) {
@@ -41,58 +52,23 @@ inline DSPFrameOutput sanitizeFrameForBridge(const DSPFrameOutput& in) {
   return out;
 }
 
-struct QueuedFrame {
-  DSPFrameOutput frame{};
-  bool valid = false;
-};
-
-struct FrameRing {
-  QueuedFrame items[kFrameQueueSize]{};
-  std::atomic<uint32_t> write_index{0};
-  std::atomic<uint32_t> read_index{0};
-  std::atomic<uint64_t> dropped_frames{0};
-
-  bool push(const DSPFrameOutput& frame) {
-    const uint32_t write = write_index.load(std::memory_order_relaxed);
-    const uint32_t next = (write + 1u) % kFrameQueueSize;
-    if (next == read_index.load(std::memory_order_acquire)) {
-      const uint64_t dropped = dropped_frames.fetch_add(1, std::memory_order_relaxed) + 1;
-      if (dropped % kDropLogPeriod == 0) {
-        __android_log_print(ANDROID_LOG_WARN, kLogTag, "Dropped %llu frames due to ring-buffer overflow", static_cast<unsigned long long>(dropped));
-      }
-      return false;
-    }
-    items[write].frame = frame;
-    items[write].valid = true;
-    write_index.store(next, std::memory_order_release);
-    return true;
-  }
-
-  bool pop(DSPFrameOutput* out) {
-    const uint32_t read = read_index.load(std::memory_order_relaxed);
-    if (read == write_index.load(std::memory_order_acquire)) {
-      return false;
-    }
-    const QueuedFrame& slot = items[read];
-    if (!slot.valid) {
-      return false;
-    }
-    *out = slot.frame;
-    items[read].valid = false;
-    read_index.store((read + 1u) % kFrameQueueSize, std::memory_order_release);
-    return true;
-  }
-};
 }  // namespace
 
 struct Engine {
   AAudioStream* stream = nullptr;
   PT_DSP* dsp = nullptr;
+  // Runs dsp on its own thread; the audio callback only queues PCM for it.
+  std::unique_ptr<pt_dsp::AnalysisWorker> worker;
   JavaVM* vm = nullptr;
   jobject plugin_obj = nullptr;
-  jmethodID on_frame = nullptr;
+  jmethodID on_frames = nullptr;
+  // Direct ByteBuffer owned by the Kotlin engine, reused for every batch.
+  jobject batch_buffer = nullptr;
+  uint8_t* batch_bytes = nullptr;
+  size_t batch_capacity_bytes = 0;
 
-  FrameRing ring{};
+  pt_dsp::SpscRing<DSPFrameOutput, kFrameQueueSize> ring;
+  std::atomic<uint64_t> dropped_frames{0};
   std::atomic<bool> running{false};
   std::thread emitter_thread;
 };
@@ -122,52 +98,49 @@ struct JNIEnvGuard {
   }
 };
 
+// Packs the frames into the shared buffer and hands them over in one call.
+// Kotlin copies the bytes out before returning, so the buffer is free again.
+static void emitFrames(Engine* engine, JNIEnv* env, const DSPFrameOutput* frames, size_t count) {
+  uint8_t* out = engine->batch_bytes;
+  size_t packed = 0;
+  for (size_t i = 0; i < count && (packed + 1) * pt_dsp::kPackedFrameBytes <= engine->batch_capacity_bytes; ++i) {
+    pt_dsp::pack_frame(sanitizeFrameForBridge(frames[i]), out + packed * pt_dsp::kPackedFrameBytes);
+    ++packed;
+  }
+  if (packed > 0) {
+    env->CallVoidMethod(engine->plugin_obj, engine->on_frames, static_cast<jint>(packed));
+  }
+}
+
 static void emitFramesOnBackgroundThread(Engine* engine) {
   JNIEnvGuard guard(engine->vm);
   if (guard.env == nullptr) {
     return;
   }
 
+  DSPFrameOutput batch[kEmitBatch];
   while (engine->running.load(std::memory_order_acquire)) {
-    DSPFrameOutput frame{};
-    bool drained_any = false;
-    while (engine->ring.pop(&frame)) {
-      drained_any = true;
-      const DSPFrameOutput safe = sanitizeFrameForBridge(frame);
-      guard.env->CallVoidMethod(
-          engine->plugin_obj,
-          engine->on_frame,
-          safe.timestamp_ms,
-          safe.freq_hz,
-          safe.midi_float,
-          safe.nearest_midi,
-          safe.cents_error,
-          safe.confidence,
-          safe.vibrato_detected,
-          safe.vibrato_rate_hz,
-          safe.vibrato_depth_cents);
+    if (!engine->ring.wait(kEmitterIdleTimeout)) {
+      continue;
     }
+    emitFrames(engine, guard.env, batch, engine->ring.pop(batch, kEmitBatch));
+  }
 
-    if (!drained_any) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(2));
-    }
+  while (const size_t count = engine->ring.pop(batch, kEmitBatch)) {
+    emitFrames(engine, guard.env, batch, count);
   }
+}
 
-  DSPFrameOutput frame{};
-  while (engine->ring.pop(&frame)) {
-    const DSPFrameOutput safe = sanitizeFrameForBridge(frame);
-    guard.env->CallVoidMethod(
-        engine->plugin_obj,
-        engine->on_frame,
-        safe.timestamp_ms,
-        safe.freq_hz,
-        safe.midi_float,
-        safe.nearest_midi,
-        safe.cents_error,
-        safe.confidence,
-        safe.vibrato_detected,
-        safe.vibrato_rate_hz,
-        safe.vibrato_depth_cents);
+// Analysis worker sink: hands frames to the emitter thread.
+static void queueFrames(void* user, const DSPFrameOutput* frames, size_t count) {
+  auto* engine = static_cast<Engine*>(user);
+  const size_t queued = engine->ring.push(frames, count);
+  if (queued < count) {
+    const uint64_t before = engine->dropped_frames.fetch_add(count - queued, std::memory_order_relaxed);
+    const uint64_t dropped = before + (count - queued);
+    if (dropped / kDropLogPeriod != before / kDropLogPeriod) {
+      __android_log_print(ANDROID_LOG_WARN, kLogTag, "Dropped %llu frames due to ring-buffer overflow", static_cast<unsigned long long>(dropped));
+    }
   }
 }
 
@@ -178,24 +151,31 @@ static aaudio_data_callback_result_t dataCallback(
     int32_t numFrames) {
   (void)stream;
   auto* engine = static_cast<Engine*>(userData);
-  if (engine == nullptr || engine->dsp == nullptr) {
+  if (engine == nullptr || engine->worker == nullptr) {
     return AAUDIO_CALLBACK_RESULT_STOP;
   }
 
-  const float* pcm = static_cast<const float*>(audioData);
-  const DSPFrameOutput frame = pt_dsp_process(engine->dsp, pcm, numFrames);
-  engine->ring.push(frame);
-
+  // Samples that do not fit are counted as overruns by the worker.
+  engine->worker->push(static_cast<const float*>(audioData), static_cast<size_t>(std::max(numFrames, 0)));
   return AAUDIO_CALLBACK_RESULT_CONTINUE;
 }
 
 extern "C" JNIEXPORT jlong JNICALL
-Java_com_pitchtranslator_audio_NativeAaudioEngine_nativeStart(JNIEnv* env, jobject thiz) {
+Java_com_pitchtranslator_audio_NativeAaudioEngine_nativeStart(JNIEnv* env, jobject thiz, jobject batchBuffer) {
+  auto* bytes = static_cast<uint8_t*>(env->GetDirectBufferAddress(batchBuffer));
+  const jlong capacity = env->GetDirectBufferCapacity(batchBuffer);
+  if (bytes == nullptr || capacity < static_cast<jlong>(pt_dsp::kPackedFrameBytes)) {
+    return 0;
+  }
+
   auto* engine = new Engine();
   env->GetJavaVM(&engine->vm);
   engine->plugin_obj = env->NewGlobalRef(thiz);
+  engine->batch_buffer = env->NewGlobalRef(batchBuffer);
+  engine->batch_bytes = bytes;
+  engine->batch_capacity_bytes = static_cast<size_t>(capacity);
   jclass cls = env->GetObjectClass(thiz);
-  engine->on_frame = env->GetMethodID(cls, "onNativeFrame", "(DDDIDDZDD)V");
+  engine->on_frames = env->GetMethodID(cls, "onNativeFrames", "(I)V");
 
   AAudioStreamBuilder* builder = nullptr;
   AAudio_createStreamBuilder(&builder);
@@ -208,6 +188,7 @@ Java_com_pitchtranslator_audio_NativeAaudioEngine_nativeStart(JNIEnv* env, jobje
   if (AAudioStreamBuilder_openStream(builder, &engine->stream) != AAUDIO_OK) {
     AAudioStreamBuilder_delete(builder);
     env->DeleteGlobalRef(engine->plugin_obj);
+    env->DeleteGlobalRef(engine->batch_buffer);
     delete engine;
     return 0;
   }
@@ -219,10 +200,16 @@ Java_com_pitchtranslator_audio_NativeAaudioEngine_nativeStart(JNIEnv* env, jobje
   cfg.frame_size = 1024;
   cfg.hop_size = 256;
   engine->dsp = pt_dsp_create(cfg);
+  if (engine->dsp != nullptr) {
+    engine->worker = std::make_unique<pt_dsp::AnalysisWorker>(engine->dsp, cfg, queueFrames, engine);
+  }
 
   AAudioStreamBuilder_delete(builder);
   engine->running.store(true, std::memory_order_release);
   engine->emitter_thread = std::thread(emitFramesOnBackgroundThread, engine);
+  if (engine->worker != nullptr) {
+    engine->worker->start();
+  }
   AAudioStream_requestStart(engine->stream);
   return reinterpret_cast<jlong>(engine);
 }
@@ -238,18 +225,33 @@ Java_com_pitchtranslator_audio_NativeAaudioEngine_nativeStop(JNIEnv* env, jobjec
     aaudio_stream_state_t nextState = AAUDIO_STREAM_STATE_UNINITIALIZED;
     AAudioStream_waitForStateChange(engine->stream, ignored, &nextState, 2000000000LL);
   }
+  if (engine->worker != nullptr) {
+    // Analyses what the callback already queued before the emitter drains.
+    engine->worker->stop();
+    const pt_dsp::AnalysisWorkerStats stats = engine->worker->stats();
+    __android_log_print(ANDROID_LOG_INFO, kLogTag,
+                        "Analysis: %llu frames, max backlog %zu samples, %llu overruns (%llu samples dropped)",
+                        static_cast<unsigned long long>(stats.frames), stats.max_backlog_samples,
+                        static_cast<unsigned long long>(stats.overruns),
+                        static_cast<unsigned long long>(stats.samples_dropped));
+  }
   engine->running.store(false, std::memory_order_release);
+  engine->ring.wake_consumer();
   if (engine->emitter_thread.joinable()) {
     engine->emitter_thread.join();
   }
   if (engine->stream != nullptr) {
     AAudioStream_close(engine->stream);
   }
+  engine->worker.reset();
   if (engine->dsp != nullptr) {
     pt_dsp_destroy(engine->dsp);
   }
   if (engine->plugin_obj != nullptr) {
     env->DeleteGlobalRef(engine->plugin_obj);
   }
+  if (engine->batch_buffer != nullptr) {
+    env->DeleteGlobalRef(engine->batch_buffer);
+  }
   delete engine;
 }
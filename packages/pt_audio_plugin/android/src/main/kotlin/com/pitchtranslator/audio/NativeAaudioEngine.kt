@@ -1,6 +1,8 @@
 package com.pitchtranslator.audio
 
-class NativeAaudioEngine(private val onFrame: (Map<String, Any?>) -> Unit) {
+import java.nio.ByteBuffer
+
+class NativeAaudioEngine(private val onFrames: (NativeFrameBatch) -> Unit) {
   companion object {
     init {
       System.loadLibrary("pt_audio_engine")
@@ -9,10 +11,14 @@ class NativeAaudioEngine(private val onFrame: (Map<String, Any?>) -> Unit) {
 
   private var handle: Long = 0
 
+  // Native packs each batch of frames here before calling onNativeFrames.
+  private val batchBuffer: ByteBuffer =
+    ByteBuffer.allocateDirect(NativeFrameBatch.MAX_FRAMES * NativeFrameBatch.FRAME_BYTES)
+
   @Synchronized
   fun start() {
     if (handle != 0L) return
-    val started = nativeStart()
+    val started = nativeStart(batchBuffer)
     require(started != 0L) { "Failed to start native AAudio engine" }
     handle = started
   }
@@ -26,35 +32,12 @@ class NativeAaudioEngine(private val onFrame: (Map<String, Any?>) -> Unit) {
 
   fun isRunning(): Boolean = handle != 0L
 
+  // Called on the native emitter thread; the buffer is reused once this returns.
   @Suppress("unused")
-  private fun onNativeFrame(
-    timestampMs: Double,
-    freqHz: Double,
-    midiFloat: Double,
-    nearestMidi: Int,
-    centsError: Double,
-    confidence: Double,
-    vibratoDetected: Boolean,
-    vibratoRateHz: Double,
-    vibratoDepthCents: Double,
-  ) {
-    onFrame(
-      mapOf(
-        "timestamp_ms" to timestampMs.toLong(),
-        "freq_hz" to freqHz.takeIf { it.isFinite() },
-        "midi_float" to midiFloat.takeIf { it.isFinite() },
-        "nearest_midi" to nearestMidi.takeIf { it >= 0 },
-        "cents_error" to centsError.takeIf { it.isFinite() },
-        "confidence" to confidence.coerceIn(0.0, 1.0),
-        "vibrato" to mapOf(
-          "detected" to vibratoDetected,
-          "rate_hz" to vibratoRateHz.takeIf { it.isFinite() },
-          "depth_cents" to vibratoDepthCents.takeIf { it.isFinite() },
-        ),
-      )
-    )
+  private fun onNativeFrames(count: Int) {
+    onFrames(NativeFrameBatch.copyOf(batchBuffer, count))
   }
 
-  private external fun nativeStart(): Long
+  private external fun nativeStart(batchBuffer: ByteBuffer): Long
   private external fun nativeStop(handle: Long)
 }
@@ -0,0 +1,63 @@
+package com.pitchtranslator.audio
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * A batch of frames in the packed layout of `pt_dsp/frame_batch.h`
+ * (64 little-endian bytes per frame). Fields are decoded on access, so
+ * frames nobody listens to are never turned into objects.
+ */
+class NativeFrameBatch internal constructor(bytes: ByteArray, val size: Int) {
+  companion object {
+    const val FRAME_BYTES = 64
+    const val MAX_FRAMES = 32
+
+    private const val TIMESTAMP_MS = 0
+    private const val FREQ_HZ = 8
+    private const val MIDI_FLOAT = 16
+    private const val CENTS_ERROR = 24
+    private const val CONFIDENCE = 32
+    private const val VIBRATO_RATE_HZ = 40
+    private const val VIBRATO_DEPTH_CENTS = 48
+    private const val NEAREST_MIDI = 56
+    private const val FLAGS = 60
+    private const val FLAG_VIBRATO = 1
+
+    /** Copies the first [count] frames out of the engine's shared [buffer]. */
+    internal fun copyOf(buffer: ByteBuffer, count: Int): NativeFrameBatch {
+      val bytes = ByteArray(count * FRAME_BYTES)
+      buffer.duplicate().apply { position(0) }.get(bytes)
+      return NativeFrameBatch(bytes, count)
+    }
+  }
+
+  private val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+
+  private fun double(index: Int, field: Int): Double = buffer.getDouble(index * FRAME_BYTES + field)
+
+  fun timestampMs(index: Int): Double = double(index, TIMESTAMP_MS)
+  fun freqHz(index: Int): Double = double(index, FREQ_HZ)
+  fun midiFloat(index: Int): Double = double(index, MIDI_FLOAT)
+  fun centsError(index: Int): Double = double(index, CENTS_ERROR)
+  fun confidence(index: Int): Double = double(index, CONFIDENCE)
+  fun vibratoRateHz(index: Int): Double = double(index, VIBRATO_RATE_HZ)
+  fun vibratoDepthCents(index: Int): Double = double(index, VIBRATO_DEPTH_CENTS)
+  fun nearestMidi(index: Int): Int = buffer.getInt(index * FRAME_BYTES + NEAREST_MIDI)
+  fun vibratoDetected(index: Int): Boolean = buffer.getInt(index * FRAME_BYTES + FLAGS) and FLAG_VIBRATO != 0
+
+  /** The `pt/audio/frames` event payload for frame [index]. */
+  fun toEvent(index: Int): Map<String, Any?> = mapOf(
+    "timestamp_ms" to timestampMs(index).toLong(),
+    "freq_hz" to freqHz(index).takeIf { it.isFinite() },
+    "midi_float" to midiFloat(index).takeIf { it.isFinite() },
+    "nearest_midi" to nearestMidi(index).takeIf { it >= 0 },
+    "cents_error" to centsError(index).takeIf { it.isFinite() },
+    "confidence" to confidence(index).coerceIn(0.0, 1.0),
+    "vibrato" to mapOf(
+      "detected" to vibratoDetected(index),
+      "rate_hz" to vibratoRateHz(index).takeIf { it.isFinite() },
+      "depth_cents" to vibratoDepthCents(index).takeIf { it.isFinite() },
+    ),
+  )
+}
@@ -68,8 +68,13 @@ class PitchTranslatorAudioPlugin :
     }
   }
 
-  private val engine = NativeAaudioEngine { frame ->
-    deviceRestartHandler.post { sink?.success(frame) }
+  private val engine = NativeAaudioEngine { batch ->
+    deviceRestartHandler.post {
+      val events = sink ?: return@post
+      for (i in 0 until batch.size) {
+        events.success(batch.toEvent(i))
+      }
+    }
   }
 
   override fun onAttachedToEngine(binding: FlutterPlugin.FlutterPluginBinding) {